@@ -7,10 +7,736 @@ license: BSD 2-Clause
 
 //parameters in following generic functions:
 //itype - type of input elements
+//ctype - name of itype in function names (e.g. uint8 for uint8_t)
+//variant - name of kernel variant, TARGET - attribute for compiling it for some instruction set
+//kernel - kernel called by public function (usually a pointer from registry of kernels)
+
+/*generic kernels are written without branches which depend on data, so compiler can vectorize
+them for target processor. AVX2 kernels are written with intrinsics, so they are vectorized without
+optimization too. AVX2 variant is compiled only by GCC-compatible compilers for 64-bit x86 (its
+kernels write indices as 64-bit numbers) and chosen only if processor supports it.*/
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HD_HAVE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+//generic kernel for finding minimum and maximum in array------------------------------------------
+
+//conditional expressions are used instead of branches, so this loop can be vectorized
+#define GET_ARRAY_MINMAX_KERNEL(itype) \
+(const itype *array, const size_t size, itype *min, itype *max) \
+{ \
+	itype tmpmin, tmpmax;	/*variables for storing temporary minimum and maximum values*/ \
+	size_t i; \
+	\
+	/*initialize minimum and maximum values*/ \
+	tmpmin = array[0]; \
+	tmpmax = array[0]; \
+	/*let's try to find smaller minimum and bigger maximum*/ \
+	for (i = 1; i < size; i++) { \
+		tmpmin = (array[i] < tmpmin) ? array[i] : tmpmin; \
+		tmpmax = (array[i] > tmpmax) ? array[i] : tmpmax; \
+		/*we don't break the cycle if ((tmpmin == itype_MIN) && (tmpmax == itype_MAX)) because it \
+		can be used for timing attack*/ \
+		} \
+	\
+	/*finally copy results to output buffers*/ \
+	*min = tmpmin; \
+	*max = tmpmax; \
+}
+
+//generic kernel for checking a range of array elements--------------------------------------------
+
+//number of elements checked at once
+#define CHECK_BLOCK 256
+
+/*array is checked by blocks without branches and early exits inside a block, so compiler can
+vectorize this loop. wrong element is searched element by element only in the first wrong block.
+kernel returns index of the first wrong element or size if there are no such elements.*/
+#define CHECK_ARRAY_RANGE_KERNEL(itype) \
+(const itype *array, const size_t size, const itype min, const itype max) \
+{ \
+	/*first element and size of current block*/ \
+	size_t start, block; \
+	/*non-zero if there is a wrong element in current block*/ \
+	unsigned int wrong; \
+	size_t i; \
+	\
+	for (start = 0; start < size; start += block) { \
+		block = size - start; \
+		if (block > CHECK_BLOCK) \
+			block = CHECK_BLOCK; \
+		\
+		wrong = 0; \
+		for (i = start; i < start + block; i++) \
+			wrong |= (array[i] < min) | (array[i] > max); \
+		if (!wrong) \
+			continue; \
+		\
+		for (i = start; (array[i] >= min) && (array[i] <= max); i++) \
+			; \
+		return i; \
+		} \
+	\
+	return size; \
+}
+
+//generic kernel for aggregation of array elements-------------------------------------------------
+
+//like minmax kernel, but also computes sum of elements
+#define AGGREGATE_ARRAY_KERNEL(itype, stype, ctype) \
+(const itype *array, const size_t size, struct hd_##ctype##_aggregate *agg) \
+{ \
+	/*temporary aggregates; sum is accumulated as unsigned number, so overflow is well-defined*/ \
+	uint64_t sum = 0; \
+	itype tmpmin, tmpmax; \
+	size_t i; \
+	\
+	/*initialize aggregates by the first element if there weren't any elements before*/ \
+	if (agg->count == 0) { \
+		agg->sum = 0; \
+		agg->min = array[0]; \
+		agg->max = array[0]; \
+		} \
+	\
+	tmpmin = agg->min; \
+	tmpmax = agg->max; \
+	for (i = 0; i < size; i++) { \
+		sum += (stype)array[i]; \
+		tmpmin = (array[i] < tmpmin) ? array[i] : tmpmin; \
+		tmpmax = (array[i] > tmpmax) ? array[i] : tmpmax; \
+		} \
+	\
+	agg->sum = (uint64_t)agg->sum + sum; \
+	agg->min = tmpmin; \
+	agg->max = tmpmax; \
+	agg->count += size; \
+}
+
+//generic kernel for selection of array elements---------------------------------------------------
+
+/*index (and element) is written to the next position of output arrays for every element, but the
+position is advanced only if element is in [lo; hi], so there are no branches which depend on data.
+kernel returns number of selected elements.*/
+#define SELECT_RANGE_KERNEL(itype) \
+(const itype *array, const size_t size, const itype lo, const itype hi, size_t *selection, \
+itype *values) \
+{ \
+	/*number of selected elements*/ \
+	size_t n = 0; \
+	size_t i; \
+	\
+	if (values == NULL) \
+		for (i = 0; i < size; i++) { \
+			selection[n] = i; \
+			n += (array[i] >= lo) & (array[i] <= hi); \
+			} \
+	else \
+		for (i = 0; i < size; i++) { \
+			selection[n] = i; \
+			values[n] = array[i]; \
+			n += (array[i] >= lo) & (array[i] <= hi); \
+			} \
+	\
+	return n; \
+}
+
+//AVX2 kernel for selection of 8, 16 and 32-bit array elements----------------------------------
+
+/*compiler doesn't vectorize the generic kernel because of dependency on number of selected
+elements, so selection is vectorized explicitly: 8 elements are widened to 32 bits and compared
+with lo and hi at once, then selected ones are moved to the beginning of vector by permutation from
+COMPRESS_TABLE and written to output arrays together with the rest of vector, which is overwritten
+by the next elements or lies beyond the selected ones. 64-bit elements use the generic kernel.*/
+#ifdef HD_HAVE_AVX2
+
+//number of bits which are set in 8-bit mask m and in its bits lower than bit l
+#define POPCOUNT8(m) ( ((m) & 1) + ((m) >> 1 & 1) + ((m) >> 2 & 1) + ((m) >> 3 & 1) + \
+	((m) >> 4 & 1) + ((m) >> 5 & 1) + ((m) >> 6 & 1) + ((m) >> 7 & 1) )
+#define LANE_POSITION(m, l) (8*POPCOUNT8( (m) & ((1 << (l)) - 1) ))
+//byte k of entry m is index of the k-th lane which is set in mask m
+#define COMPRESS_LANE(m, l) ( ((m) >> (l) & 1) ? (uint64_t)(l) << LANE_POSITION(m, l) : 0 )
+#define COMPRESS_ENTRY(m) ( COMPRESS_LANE(m, 0) | COMPRESS_LANE(m, 1) | COMPRESS_LANE(m, 2) | \
+	COMPRESS_LANE(m, 3) | COMPRESS_LANE(m, 4) | COMPRESS_LANE(m, 5) | COMPRESS_LANE(m, 6) | \
+	COMPRESS_LANE(m, 7) )
+#define COMPRESS_ENTRIES4(m) COMPRESS_ENTRY(m), COMPRESS_ENTRY(m + 1), COMPRESS_ENTRY(m + 2), \
+	COMPRESS_ENTRY(m + 3)
+#define COMPRESS_ENTRIES16(m) COMPRESS_ENTRIES4(m), COMPRESS_ENTRIES4(m + 4), \
+	COMPRESS_ENTRIES4(m + 8), COMPRESS_ENTRIES4(m + 12)
+#define COMPRESS_ENTRIES64(m) COMPRESS_ENTRIES16(m), COMPRESS_ENTRIES16(m + 16), \
+	COMPRESS_ENTRIES16(m + 32), COMPRESS_ENTRIES16(m + 48)
+
+static const uint64_t COMPRESS_TABLE[256] = {
+	COMPRESS_ENTRIES64(0), COMPRESS_ENTRIES64(64), COMPRESS_ENTRIES64(128), COMPRESS_ENTRIES64(192)
+	};
+
+#undef COMPRESS_ENTRIES64
+#undef COMPRESS_ENTRIES16
+#undef COMPRESS_ENTRIES4
+#undef COMPRESS_ENTRY
+#undef COMPRESS_LANE
+#undef LANE_POSITION
+#undef POPCOUNT8
+
+//LOAD(p) - load 8 elements widened to signed 32-bit numbers, BIAS - number xored with them before
+//comparison, so unsigned 32-bit numbers are compared as signed ones, STORE(p, v) - narrow 8
+//elements of v back and store them
+#define SELECT_RANGE_AVX2_KERNEL(itype, LOAD, BIAS, STORE) \
+(const itype *array, const size_t size, const itype lo, const itype hi, size_t *selection, \
+itype *values) \
+{ \
+	/*number of selected elements*/ \
+	size_t n = 0; \
+	size_t i; \
+	/*current elements, elements before comparison and selected elements moved to the beginning*/ \
+	__m256i elts, cmp_elts, compressed; \
+	/*permutation for current mask*/ \
+	__m256i perm; \
+	/*mask of selected elements*/ \
+	unsigned int mask; \
+	const __m256i bias = _mm256_set1_epi32(BIAS); \
+	const __m256i vlo = _mm256_xor_si256(_mm256_set1_epi32(lo), bias); \
+	const __m256i vhi = _mm256_xor_si256(_mm256_set1_epi32(hi), bias); \
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); \
+	\
+	for (i = 0; i + 8 <= size; i += 8) { \
+		elts = LOAD(array + i); \
+		cmp_elts = _mm256_xor_si256(elts, bias); \
+		/*element is selected if it is neither less than lo nor bigger than hi*/ \
+		mask = ~_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_or_si256( \
+			_mm256_cmpgt_epi32(vlo, cmp_elts), _mm256_cmpgt_epi32(cmp_elts, vhi) ) ) ) & 0xFF; \
+		perm = _mm256_cvtepu8_epi32( _mm_cvtsi64_si128(COMPRESS_TABLE[mask]) ); \
+		\
+		/*indices of selected elements are widened to 64 bits*/ \
+		compressed = _mm256_permutevar8x32_epi32(lanes, perm); \
+		_mm256_storeu_si256( (__m256i *)(selection + n), _mm256_add_epi64( \
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(compressed)), \
+			_mm256_set1_epi64x(i) ) ); \
+		_mm256_storeu_si256( (__m256i *)(selection + n + 4), _mm256_add_epi64( \
+			_mm256_cvtepu32_epi64(_mm256_extracti128_si256(compressed, 1)), \
+			_mm256_set1_epi64x(i) ) ); \
+		if (values != NULL) \
+			STORE(values + n, _mm256_permutevar8x32_epi32(elts, perm)); \
+		n += __builtin_popcount(mask); \
+		} \
+	\
+	/*the rest of elements*/ \
+	for (; i < size; i++) { \
+		selection[n] = i; \
+		if (values != NULL) \
+			values[n] = array[i]; \
+		n += (array[i] >= lo) & (array[i] <= hi); \
+		} \
+	\
+	return n; \
+}
+
+#define LOAD_UINT8(p) _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)(p) ) )
+#define LOAD_INT8(p) _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)(p) ) )
+#define LOAD_UINT16(p) _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i *)(p) ) )
+#define LOAD_INT16(p) _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *)(p) ) )
+#define LOAD_32(p) _mm256_loadu_si256( (const __m256i *)(p) )
+
+//the lowest byte of every 32-bit lane is moved to the beginning of its 128-bit half, then the
+//halves are joined
+#define STORE_8(p, v) _mm_storel_epi64( (__m128i *)(p), _mm256_castsi256_si128( \
+	_mm256_permutevar8x32_epi32( _mm256_shuffle_epi8( (v), _mm256_setr_epi8( \
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, \
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1) ), \
+	_mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0) ) ) )
+//the same for two lowest bytes
+#define STORE_16(p, v) _mm_storeu_si128( (__m128i *)(p), _mm256_castsi256_si128( \
+	_mm256_permute4x64_epi64( _mm256_shuffle_epi8( (v), _mm256_setr_epi8( \
+		0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, \
+		0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1) ), 0x08 ) ) )
+#define STORE_32(p, v) _mm256_storeu_si256( (__m256i *)(p), (v) )
+
+AVX2_TARGET static size_t select_uint8_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(uint8_t, LOAD_UINT8, 0, STORE_8)
+AVX2_TARGET static size_t select_int8_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(int8_t, LOAD_INT8, 0, STORE_8)
+AVX2_TARGET static size_t select_uint16_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(uint16_t, LOAD_UINT16, 0, STORE_16)
+AVX2_TARGET static size_t select_int16_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(int16_t, LOAD_INT16, 0, STORE_16)
+AVX2_TARGET static size_t select_uint32_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(uint32_t, LOAD_32, INT32_MIN, STORE_32)
+AVX2_TARGET static size_t select_int32_range_avx2
+	SELECT_RANGE_AVX2_KERNEL(int32_t, LOAD_32, 0, STORE_32)
+
+#undef STORE_32
+#undef STORE_16
+#undef STORE_8
+#undef LOAD_32
+#undef LOAD_INT16
+#undef LOAD_UINT16
+#undef LOAD_INT8
+#undef LOAD_UINT8
+#undef SELECT_RANGE_AVX2_KERNEL
+
+#endif
+
+//generic kernel for ranking of values among a few keys--------------------------------------------
+
+//every value is compared with all keys without branches, so inner loop is vectorized
+#define RANK_SMALL_KERNEL \
+(const uint32_t *keys, const uint32_t *values, const size_t size, size_t *ranks) \
+{ \
+	uint32_t rank; \
+	size_t i, j; \
+	\
+	for (i = 0; i < size; i++) { \
+		rank = 0; \
+		for (j = 0; j < HD_RANK_KEYS; j++) \
+			rank += (keys[j] <= values[i]); \
+		ranks[i] = rank; \
+		} \
+}
+
+//AVX2 kernels for finding minimum and maximum, checking range and aggregation---------------------
+
+/*elements are processed by vectors of 32 bytes, and the rest of array element by element.
+parameters: LANES - number of elements in vector, SET1(x) - vector of LANES copies of x,
+MIN(a, b) and MAX(a, b) - minimums and maximums of lanes of two vectors, SUM(v) - sums of elements
+of vector in four 64-bit lanes. results are the same as ones of generic kernels.*/
+#ifdef HD_HAVE_AVX2
+
+#define GET_ARRAY_MINMAX_AVX2_KERNEL(itype, LANES, SET1, MIN, MAX) \
+(const itype *array, const size_t size, itype *min, itype *max) \
+{ \
+	/*current elements, minimums and maximums of lanes*/ \
+	__m256i elts, vmin, vmax; \
+	itype lanes_min[LANES], lanes_max[LANES]; \
+	itype tmpmin, tmpmax; \
+	size_t i, j; \
+	\
+	vmin = SET1(array[0]); \
+	vmax = vmin; \
+	for (i = 0; i + LANES <= size; i += LANES) { \
+		elts = _mm256_loadu_si256( (const __m256i *)(array + i) ); \
+		vmin = MIN(elts, vmin); \
+		vmax = MAX(elts, vmax); \
+		} \
+	_mm256_storeu_si256( (__m256i *)lanes_min, vmin ); \
+	_mm256_storeu_si256( (__m256i *)lanes_max, vmax ); \
+	\
+	/*join lanes and the rest of elements*/ \
+	tmpmin = lanes_min[0]; \
+	tmpmax = lanes_max[0]; \
+	for (j = 1; j < LANES; j++) { \
+		tmpmin = (lanes_min[j] < tmpmin) ? lanes_min[j] : tmpmin; \
+		tmpmax = (lanes_max[j] > tmpmax) ? lanes_max[j] : tmpmax; \
+		} \
+	for (; i < size; i++) { \
+		tmpmin = (array[i] < tmpmin) ? array[i] : tmpmin; \
+		tmpmax = (array[i] > tmpmax) ? array[i] : tmpmax; \
+		} \
+	\
+	*min = tmpmin; \
+	*max = tmpmax; \
+}
+
+//element is wrong if clamping it to [min; max] changes it
+#define CHECK_ARRAY_RANGE_AVX2_KERNEL(itype, LANES, SET1, MIN, MAX) \
+(const itype *array, const size_t size, const itype min, const itype max) \
+{ \
+	const __m256i vmin = SET1(min), vmax = SET1(max); \
+	/*current elements, the same clamped to [min; max] and differences of them in all block*/ \
+	__m256i elts, clamped, diff; \
+	/*first element and size of current block*/ \
+	size_t start, block; \
+	/*non-zero if there is a wrong element in current block*/ \
+	unsigned int wrong; \
+	size_t i; \
+	\
+	for (start = 0; start < size; start += block) { \
+		block = size - start; \
+		if (block > CHECK_BLOCK) \
+			block = CHECK_BLOCK; \
+		\
+		diff = _mm256_setzero_si256(); \
+		for (i = start; i + LANES <= start + block; i += LANES) { \
+			elts = _mm256_loadu_si256( (const __m256i *)(array + i) ); \
+			clamped = MIN(elts, vmax); \
+			clamped = MAX(clamped, vmin); \
+			diff = _mm256_or_si256( diff, _mm256_xor_si256(elts, clamped) ); \
+			} \
+		wrong = !_mm256_testz_si256(diff, diff); \
+		for (; i < start + block; i++) \
+			wrong |= (array[i] < min) | (array[i] > max); \
+		if (!wrong) \
+			continue; \
+		\
+		for (i = start; (array[i] >= min) && (array[i] <= max); i++) \
+			; \
+		return i; \
+		} \
+	\
+	return size; \
+}
+
+#define AGGREGATE_ARRAY_AVX2_KERNEL(itype, ctype, LANES, SET1, MIN, MAX, SUM) \
+(const itype *array, const size_t size, struct hd_##ctype##_aggregate *agg) \
+{ \
+	/*current elements, sums, minimums and maximums of lanes*/ \
+	__m256i elts, vsum, vmin, vmax; \
+	uint64_t lanes_sum[4]; \
+	itype lanes_min[LANES], lanes_max[LANES]; \
+	/*temporary aggregates; sum is accumulated as unsigned number, so overflow is well-defined*/ \
+	uint64_t sum = 0; \
+	itype tmpmin, tmpmax; \
+	size_t i, j; \
+	\
+	/*initialize aggregates by the first element if there weren't any elements before*/ \
+	if (agg->count == 0) { \
+		agg->sum = 0; \
+		agg->min = array[0]; \
+		agg->max = array[0]; \
+		} \
+	\
+	vsum = _mm256_setzero_si256(); \
+	vmin = SET1(agg->min); \
+	vmax = SET1(agg->max); \
+	for (i = 0; i + LANES <= size; i += LANES) { \
+		elts = _mm256_loadu_si256( (const __m256i *)(array + i) ); \
+		vsum = _mm256_add_epi64( vsum, SUM(elts) ); \
+		vmin = MIN(elts, vmin); \
+		vmax = MAX(elts, vmax); \
+		} \
+	_mm256_storeu_si256( (__m256i *)lanes_sum, vsum ); \
+	_mm256_storeu_si256( (__m256i *)lanes_min, vmin ); \
+	_mm256_storeu_si256( (__m256i *)lanes_max, vmax ); \
+	\
+	/*join lanes and the rest of elements*/ \
+	for (j = 0; j < 4; j++) \
+		sum += lanes_sum[j]; \
+	tmpmin = lanes_min[0]; \
+	tmpmax = lanes_max[0]; \
+	for (j = 1; j < LANES; j++) { \
+		tmpmin = (lanes_min[j] < tmpmin) ? lanes_min[j] : tmpmin; \
+		tmpmax = (lanes_max[j] > tmpmax) ? lanes_max[j] : tmpmax; \
+		} \
+	for (; i < size; i++) { \
+		sum += (uint64_t)array[i]; \
+		tmpmin = (array[i] < tmpmin) ? array[i] : tmpmin; \
+		tmpmax = (array[i] > tmpmax) ? array[i] : tmpmax; \
+		} \
+	\
+	agg->sum = (uint64_t)agg->sum + sum; \
+	agg->min = tmpmin; \
+	agg->max = tmpmax; \
+	agg->count += size; \
+}
+
+#define SET1_8(x) _mm256_set1_epi8(x)
+#define SET1_16(x) _mm256_set1_epi16(x)
+#define SET1_32(x) _mm256_set1_epi32(x)
+#define SET1_64(x) _mm256_set1_epi64x(x)
+
+//AVX2 has no minimum and maximum of 64-bit lanes, so they are selected by comparison; unsigned
+//lanes are compared after flipping their sign bits
+#define CMPGT_EPU64(a, b) _mm256_cmpgt_epi64( \
+	_mm256_xor_si256( (a), _mm256_set1_epi64x(INT64_MIN) ), \
+	_mm256_xor_si256( (b), _mm256_set1_epi64x(INT64_MIN) ) )
+#define MIN_EPI64(a, b) _mm256_blendv_epi8( (a), (b), _mm256_cmpgt_epi64((a), (b)) )
+#define MAX_EPI64(a, b) _mm256_blendv_epi8( (b), (a), _mm256_cmpgt_epi64((a), (b)) )
+#define MIN_EPU64(a, b) _mm256_blendv_epi8( (a), (b), CMPGT_EPU64((a), (b)) )
+#define MAX_EPU64(a, b) _mm256_blendv_epi8( (b), (a), CMPGT_EPU64((a), (b)) )
+
+//sums of 8 bytes of every 64-bit lane; signed bytes are made unsigned by adding 128, which is
+//subtracted back from these sums
+#define SUM_UINT8(v) _mm256_sad_epu8( (v), _mm256_setzero_si256() )
+#define SUM_INT8(v) _mm256_sub_epi64( SUM_UINT8( _mm256_xor_si256((v), _mm256_set1_epi8(-128)) ), \
+	_mm256_set1_epi64x(8*128) )
+//sums of 32-bit lanes i and i+4 as 64-bit lane i
+#define SUM_HALVES_INT32(v) _mm256_add_epi64( _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)), \
+	_mm256_cvtepi32_epi64( _mm256_extracti128_si256((v), 1) ) )
+#define SUM_HALVES_UINT32(v) _mm256_add_epi64( _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)), \
+	_mm256_cvtepu32_epi64( _mm256_extracti128_si256((v), 1) ) )
+//pairs of 16-bit elements are added to 32-bit sums; unsigned elements are made signed by
+//subtracting 32768, which is added back to sums of 4 elements
+#define SUM_INT16(v) SUM_HALVES_INT32( _mm256_madd_epi16( (v), _mm256_set1_epi16(1) ) )
+#define SUM_UINT16(v) _mm256_add_epi64( \
+	SUM_INT16( _mm256_xor_si256((v), _mm256_set1_epi16(INT16_MIN)) ), _mm256_set1_epi64x(4*32768) )
+#define SUM_64(v) (v)
+
+#define AVX2_KERNELS(itype, ctype, LANES, SET1, MIN, MAX, SUM) \
+AVX2_TARGET static void get_##ctype##_minmax_avx2 \
+	GET_ARRAY_MINMAX_AVX2_KERNEL(itype, LANES, SET1, MIN, MAX) \
+AVX2_TARGET static size_t check_##ctype##_range_avx2 \
+	CHECK_ARRAY_RANGE_AVX2_KERNEL(itype, LANES, SET1, MIN, MAX) \
+AVX2_TARGET static void aggregate_##ctype##_array_avx2 \
+	AGGREGATE_ARRAY_AVX2_KERNEL(itype, ctype, LANES, SET1, MIN, MAX, SUM)
+
+AVX2_KERNELS(uint8_t, uint8, 32, SET1_8, _mm256_min_epu8, _mm256_max_epu8, SUM_UINT8)
+AVX2_KERNELS(int8_t, int8, 32, SET1_8, _mm256_min_epi8, _mm256_max_epi8, SUM_INT8)
+AVX2_KERNELS(uint16_t, uint16, 16, SET1_16, _mm256_min_epu16, _mm256_max_epu16, SUM_UINT16)
+AVX2_KERNELS(int16_t, int16, 16, SET1_16, _mm256_min_epi16, _mm256_max_epi16, SUM_INT16)
+AVX2_KERNELS(uint32_t, uint32, 8, SET1_32, _mm256_min_epu32, _mm256_max_epu32, SUM_HALVES_UINT32)
+AVX2_KERNELS(int32_t, int32, 8, SET1_32, _mm256_min_epi32, _mm256_max_epi32, SUM_HALVES_INT32)
+AVX2_KERNELS(uint64_t, uint64, 4, SET1_64, MIN_EPU64, MAX_EPU64, SUM_64)
+AVX2_KERNELS(int64_t, int64, 4, SET1_64, MIN_EPI64, MAX_EPI64, SUM_64)
+
+#undef AVX2_KERNELS
+#undef SUM_64
+#undef SUM_UINT16
+#undef SUM_INT16
+#undef SUM_HALVES_UINT32
+#undef SUM_HALVES_INT32
+#undef SUM_INT8
+#undef SUM_UINT8
+#undef MAX_EPU64
+#undef MIN_EPU64
+#undef MAX_EPI64
+#undef MIN_EPI64
+#undef CMPGT_EPU64
+#undef SET1_64
+#undef SET1_32
+#undef SET1_16
+#undef SET1_8
+#undef AGGREGATE_ARRAY_AVX2_KERNEL
+#undef CHECK_ARRAY_RANGE_AVX2_KERNEL
+#undef GET_ARRAY_MINMAX_AVX2_KERNEL
+
+/*8 values are compared with every key at once: unsigned numbers are compared as signed ones after
+flipping their sign bits, and comparison gives -1 for every key which is bigger than value*/
+AVX2_TARGET static void rank_uint32_small_avx2(const uint32_t *keys, const uint32_t *values,
+	const size_t size, size_t *ranks)
+{
+	const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+	//keys with flipped sign bits
+	__m256i vkeys[HD_RANK_KEYS];
+	//current values and ranks of them
+	__m256i vvalues, vranks;
+	uint32_t rank;
+	size_t i, j;
+
+	for (j = 0; j < HD_RANK_KEYS; j++)
+		vkeys[j] = _mm256_xor_si256(_mm256_set1_epi32(keys[j]), bias);
+
+	for (i = 0; i + 8 <= size; i += 8) {
+		vvalues = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i *)(values + i) ), bias );
+		vranks = _mm256_set1_epi32(HD_RANK_KEYS);
+		for (j = 0; j < HD_RANK_KEYS; j++)
+			vranks = _mm256_add_epi32( vranks, _mm256_cmpgt_epi32(vkeys[j], vvalues) );
+		_mm256_storeu_si256( (__m256i *)(ranks + i),
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(vranks)) );
+		_mm256_storeu_si256( (__m256i *)(ranks + i + 4),
+			_mm256_cvtepu32_epi64( _mm256_extracti128_si256(vranks, 1) ) );
+		}
+
+	//the rest of values
+	for (; i < size; i++) {
+		rank = 0;
+		for (j = 0; j < HD_RANK_KEYS; j++)
+			rank += (keys[j] <= values[i]);
+		ranks[i] = rank;
+		}
+}
+
+#endif
+
+//kernels of all variants--------------------------------------------------------------------------
+
+#define GENERIC_KERNELS(itype, stype, ctype) \
+static void get_##ctype##_minmax_generic GET_ARRAY_MINMAX_KERNEL(itype) \
+static size_t check_##ctype##_range_generic CHECK_ARRAY_RANGE_KERNEL(itype) \
+static void aggregate_##ctype##_array_generic AGGREGATE_ARRAY_KERNEL(itype, stype, ctype) \
+static size_t select_##ctype##_range_generic SELECT_RANGE_KERNEL(itype)
+
+GENERIC_KERNELS(uint8_t, uint64_t, uint8)
+GENERIC_KERNELS(int8_t, int64_t, int8)
+GENERIC_KERNELS(uint16_t, uint64_t, uint16)
+GENERIC_KERNELS(int16_t, int64_t, int16)
+GENERIC_KERNELS(uint32_t, uint64_t, uint32)
+GENERIC_KERNELS(int32_t, int64_t, int32)
+GENERIC_KERNELS(uint64_t, uint64_t, uint64)
+GENERIC_KERNELS(int64_t, int64_t, int64)
+
+#undef GENERIC_KERNELS
+
+static void rank_uint32_small_generic RANK_SMALL_KERNEL
+
+/*floating point minimum and maximum and selection of 64-bit elements have generic kernels only:
+vector minimum and maximum don't keep the order of elements which are equal as numbers (e.g. -0
+and 0), and AVX2 can't compress vectors of 64-bit elements*/
+static void get_float_minmax_generic GET_ARRAY_MINMAX_KERNEL(float)
+static void get_double_minmax_generic GET_ARRAY_MINMAX_KERNEL(double)
+static void get_longd_minmax_generic GET_ARRAY_MINMAX_KERNEL(long double)
+
+//128-bit kernels aren't vectorized by any instruction set, so they have generic variant only
+#ifdef HD_HAVE_INT128
+static void get_uint128_minmax_generic GET_ARRAY_MINMAX_KERNEL(hd_uint128_t)
+static void get_int128_minmax_generic GET_ARRAY_MINMAX_KERNEL(hd_int128_t)
+static size_t check_uint128_range_generic CHECK_ARRAY_RANGE_KERNEL(hd_uint128_t)
+static size_t check_int128_range_generic CHECK_ARRAY_RANGE_KERNEL(hd_int128_t)
+#endif
+
+#undef RANK_SMALL_KERNEL
+#undef SELECT_RANGE_KERNEL
+#undef AGGREGATE_ARRAY_KERNEL
+#undef CHECK_ARRAY_RANGE_KERNEL
+#undef CHECK_BLOCK
+#undef GET_ARRAY_MINMAX_KERNEL
+
+//registry of kernels------------------------------------------------------------------------------
+
+#define MINMAX_POINTER(itype, ctype) \
+	void (*get_##ctype##_minmax)(const itype *, const size_t, itype *, itype *);
+#define RANGE_POINTER(itype, ctype) \
+	size_t (*check_##ctype##_range)(const itype *, const size_t, const itype, const itype);
+#define SELECT_POINTER(itype, ctype) \
+	size_t (*select_##ctype##_range)(const itype *, const size_t, const itype, const itype, \
+		size_t *, itype *);
+#define AGGREGATE_POINTER(itype, ctype) \
+	void (*aggregate_##ctype##_array)(const itype *, const size_t, struct hd_##ctype##_aggregate *);
+
+//pointers to kernels of chosen variant
+struct hd_kernels {
+	enum hd_variant variant;
+	const char *name;
+	MINMAX_POINTER(uint8_t, uint8)
+	MINMAX_POINTER(int8_t, int8)
+	MINMAX_POINTER(uint16_t, uint16)
+	MINMAX_POINTER(int16_t, int16)
+	MINMAX_POINTER(uint32_t, uint32)
+	MINMAX_POINTER(int32_t, int32)
+	MINMAX_POINTER(uint64_t, uint64)
+	MINMAX_POINTER(int64_t, int64)
+	MINMAX_POINTER(float, float)
+	MINMAX_POINTER(double, double)
+	MINMAX_POINTER(long double, longd)
+	RANGE_POINTER(uint8_t, uint8)
+	RANGE_POINTER(int8_t, int8)
+	RANGE_POINTER(uint16_t, uint16)
+	RANGE_POINTER(int16_t, int16)
+	RANGE_POINTER(uint32_t, uint32)
+	RANGE_POINTER(int32_t, int32)
+	RANGE_POINTER(uint64_t, uint64)
+	RANGE_POINTER(int64_t, int64)
+	AGGREGATE_POINTER(uint8_t, uint8)
+	AGGREGATE_POINTER(int8_t, int8)
+	AGGREGATE_POINTER(uint16_t, uint16)
+	AGGREGATE_POINTER(int16_t, int16)
+	AGGREGATE_POINTER(uint32_t, uint32)
+	AGGREGATE_POINTER(int32_t, int32)
+	AGGREGATE_POINTER(uint64_t, uint64)
+	AGGREGATE_POINTER(int64_t, int64)
+	SELECT_POINTER(uint8_t, uint8)
+	SELECT_POINTER(int8_t, int8)
+	SELECT_POINTER(uint16_t, uint16)
+	SELECT_POINTER(int16_t, int16)
+	SELECT_POINTER(uint32_t, uint32)
+	SELECT_POINTER(int32_t, int32)
+	SELECT_POINTER(uint64_t, uint64)
+	SELECT_POINTER(int64_t, int64)
+	void (*rank_uint32_small)(const uint32_t *, const uint32_t *, const size_t, size_t *);
+	};
+
+#undef SELECT_POINTER
+#undef AGGREGATE_POINTER
+#undef RANGE_POINTER
+#undef MINMAX_POINTER
+
+#define KERNELS(VARIANT, variant) \
+	{ VARIANT, #variant, \
+	get_uint8_minmax_##variant, get_int8_minmax_##variant, \
+	get_uint16_minmax_##variant, get_int16_minmax_##variant, \
+	get_uint32_minmax_##variant, get_int32_minmax_##variant, \
+	get_uint64_minmax_##variant, get_int64_minmax_##variant, \
+	get_float_minmax_generic, get_double_minmax_generic, get_longd_minmax_generic, \
+	check_uint8_range_##variant, check_int8_range_##variant, \
+	check_uint16_range_##variant, check_int16_range_##variant, \
+	check_uint32_range_##variant, check_int32_range_##variant, \
+	check_uint64_range_##variant, check_int64_range_##variant, \
+	aggregate_uint8_array_##variant, aggregate_int8_array_##variant, \
+	aggregate_uint16_array_##variant, aggregate_int16_array_##variant, \
+	aggregate_uint32_array_##variant, aggregate_int32_array_##variant, \
+	aggregate_uint64_array_##variant, aggregate_int64_array_##variant, \
+	select_uint8_range_##variant, select_int8_range_##variant, \
+	select_uint16_range_##variant, select_int16_range_##variant, \
+	select_uint32_range_##variant, select_int32_range_##variant, \
+	select_uint64_range_generic, select_int64_range_generic, \
+	rank_uint32_small_##variant }
+
+//all variants in order of enum hd_variant
+static const struct hd_kernels all_kernels[] = {
+	KERNELS(HD_GENERIC, generic),
+#ifdef HD_HAVE_AVX2
+	KERNELS(HD_AVX2, avx2),
+#endif
+	};
+
+#undef KERNELS
+
+//generic variant is used until kernels are chosen, e.g. if constructors aren't supported
+static const struct hd_kernels *kernels = &all_kernels[HD_GENERIC];
+
+//check if variant is compiled in and supported by processor
+static bool is_variant_supported(const enum hd_variant variant)
+{
+	switch (variant) {
+		case HD_GENERIC:
+			return true;
+#ifdef HD_HAVE_AVX2
+		case HD_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+		}
+}
+
+extern int set_kernel_variant(const enum hd_variant variant)
+{
+	if (!is_variant_supported(variant)) {
+		error("kernel variant isn't supported");
+		return -1;
+		}
+	kernels = &all_kernels[variant];
+	return 0;
+}
+
+extern enum hd_variant get_kernel_variant(void)
+{
+	return kernels->variant;
+}
+
+extern const char *get_kernel_variant_name(void)
+{
+	return kernels->name;
+}
+
+//choose kernels once at program start: the best supported variant or one from HD_VARIANT
+#ifdef __GNUC__
+__attribute__((constructor))
+#endif
+static void choose_kernels(void)
+{
+	//value of HD_VARIANT environment variable
+	const char *name = getenv("HD_VARIANT");
+	size_t i;
+
+	if (name != NULL)
+		for (i = 0; i < sizeof(all_kernels)/sizeof(all_kernels[0]); i++)
+			if (!strcmp(name, all_kernels[i].name)) {
+				set_kernel_variant(all_kernels[i].variant);
+				return;
+				}
+
+	//else the last supported variant is the best one
+	for (i = sizeof(all_kernels)/sizeof(all_kernels[0]); i > 0; i--)
+		if (is_variant_supported(all_kernels[i-1].variant)) {
+			kernels = &all_kernels[i-1];
+			return;
+			}
+}
 
 //generic function for finding minimum and maximum in array----------------------------------------
 
-#define GET_ARRAY_MINMAX(itype) \
+#define GET_ARRAY_MINMAX(itype, kernel) \
 (const itype *array, const size_t size, itype *min, itype *max) \
 { \
 	\
@@ -32,65 +758,218 @@ license: BSD 2-Clause
 		return 4; \
 		} \
 	\
-	itype tmpmin, tmpmax;	/*variables for storing temporary minimum and maximum values*/ \
-	size_t i; \
-	\
-	/*initialize minimum and maximum values*/ \
-	tmpmin = array[0]; \
-	tmpmax = array[0]; \
-	/*let's try to find smaller minimum and bigger maximum*/ \
-	for (i = 1; i < size; i++) { \
-		if (array[i] < tmpmin)		/*then it's the new minimum*/ \
-			tmpmin = array[i]; \
-		if (array[i] > tmpmax)		/*then it's the new maximum*/ \
-			tmpmax = array[i]; \
-		/*we don't break the cycle if ((tmpmin == itype_MIN) && (tmpmax == itype_MAX)) because it \
-		can be used for timing attack; same with not proceeding to next iteration if we found a \
-		new minimum (same element can't be both minimum and maximum if it is not the first)*/ \
-		} \
-	\
-	/*finally copy results to output buffers*/ \
-	*min = tmpmin; \
-	*max = tmpmax; \
-	\
+	kernel(array, size, min, max); \
 	return 0; \
 }
 
 extern int get_uint8_minmax
-	GET_ARRAY_MINMAX(uint8_t)
+	GET_ARRAY_MINMAX(uint8_t, kernels->get_uint8_minmax)
 
 extern int get_int8_minmax
-	GET_ARRAY_MINMAX(int8_t)
+	GET_ARRAY_MINMAX(int8_t, kernels->get_int8_minmax)
 
 extern int get_uint16_minmax
-	GET_ARRAY_MINMAX(uint16_t)
+	GET_ARRAY_MINMAX(uint16_t, kernels->get_uint16_minmax)
 
 extern int get_int16_minmax
-	GET_ARRAY_MINMAX(int16_t)
+	GET_ARRAY_MINMAX(int16_t, kernels->get_int16_minmax)
 
 extern int get_uint32_minmax
-	GET_ARRAY_MINMAX(uint32_t)
+	GET_ARRAY_MINMAX(uint32_t, kernels->get_uint32_minmax)
 
 extern int get_int32_minmax
-	GET_ARRAY_MINMAX(int32_t)
+	GET_ARRAY_MINMAX(int32_t, kernels->get_int32_minmax)
 
 extern int get_uint64_minmax
-	GET_ARRAY_MINMAX(uint64_t)
+	GET_ARRAY_MINMAX(uint64_t, kernels->get_uint64_minmax)
 
 extern int get_int64_minmax
-	GET_ARRAY_MINMAX(int64_t)
+	GET_ARRAY_MINMAX(int64_t, kernels->get_int64_minmax)
+
+#ifdef HD_HAVE_INT128
+extern int get_uint128_minmax
+	GET_ARRAY_MINMAX(hd_uint128_t, get_uint128_minmax_generic)
+
+extern int get_int128_minmax
+	GET_ARRAY_MINMAX(hd_int128_t, get_int128_minmax_generic)
+#endif
 
 extern int get_float_minmax
-	GET_ARRAY_MINMAX(float)
+	GET_ARRAY_MINMAX(float, kernels->get_float_minmax)
 
 extern int get_double_minmax
-	GET_ARRAY_MINMAX(double)
+	GET_ARRAY_MINMAX(double, kernels->get_double_minmax)
 
 extern int get_longd_minmax
-	GET_ARRAY_MINMAX(long double)
+	GET_ARRAY_MINMAX(long double, kernels->get_longd_minmax)
 
 #undef GET_ARRAY_MINMAX
 
+//generic function for checking a range of array elements------------------------------------------
+
+#define CHECK_ARRAY_RANGE(itype, kernel) \
+(const itype *array, const size_t size, const itype min, const itype max, struct hd_error *err) \
+{ \
+	/*check the arguments*/ \
+	if ( (array == NULL) || (size == 0) || (min > max) ) { \
+		error("wrong arguments"); \
+		if (err != NULL) { \
+			err->code = HD_WRONG_ARGS; \
+			err->index = 0; \
+			} \
+		return -1; \
+		} \
+	\
+	/*index of the first wrong element*/ \
+	const size_t i = kernel(array, size, min, max); \
+	\
+	if (i < size) { \
+		if (err != NULL) { \
+			err->code = (array[i] < min) ? HD_WRONG_MIN : HD_WRONG_MAX; \
+			err->index = i; \
+			} \
+		return -1; \
+		} \
+	\
+	if (err != NULL) { \
+		err->code = HD_OK; \
+		err->index = 0; \
+		} \
+	return 0; \
+}
+
+extern int check_uint8_range
+	CHECK_ARRAY_RANGE(uint8_t, kernels->check_uint8_range)
+
+extern int check_int8_range
+	CHECK_ARRAY_RANGE(int8_t, kernels->check_int8_range)
+
+extern int check_uint16_range
+	CHECK_ARRAY_RANGE(uint16_t, kernels->check_uint16_range)
+
+extern int check_int16_range
+	CHECK_ARRAY_RANGE(int16_t, kernels->check_int16_range)
+
+extern int check_uint32_range
+	CHECK_ARRAY_RANGE(uint32_t, kernels->check_uint32_range)
+
+extern int check_int32_range
+	CHECK_ARRAY_RANGE(int32_t, kernels->check_int32_range)
+
+extern int check_uint64_range
+	CHECK_ARRAY_RANGE(uint64_t, kernels->check_uint64_range)
+
+extern int check_int64_range
+	CHECK_ARRAY_RANGE(int64_t, kernels->check_int64_range)
+
+#ifdef HD_HAVE_INT128
+extern int check_uint128_range
+	CHECK_ARRAY_RANGE(hd_uint128_t, check_uint128_range_generic)
+
+extern int check_int128_range
+	CHECK_ARRAY_RANGE(hd_int128_t, check_int128_range_generic)
+#endif
+
+#undef CHECK_ARRAY_RANGE
+
+//generic function for aggregation of array elements-----------------------------------------------
+
+#define AGGREGATE_ARRAY(itype, ctype) \
+(const itype *array, const size_t size, struct hd_##ctype##_aggregate *agg) \
+{ \
+	/*check the arguments*/ \
+	if ( (array == NULL) || (size == 0) || (agg == NULL) ) { \
+		error("wrong arguments"); \
+		return -1; \
+		} \
+	\
+	kernels->aggregate_##ctype##_array(array, size, agg); \
+	return 0; \
+}
+
+extern int aggregate_uint8_array
+	AGGREGATE_ARRAY(uint8_t, uint8)
+
+extern int aggregate_int8_array
+	AGGREGATE_ARRAY(int8_t, int8)
+
+extern int aggregate_uint16_array
+	AGGREGATE_ARRAY(uint16_t, uint16)
+
+extern int aggregate_int16_array
+	AGGREGATE_ARRAY(int16_t, int16)
+
+extern int aggregate_uint32_array
+	AGGREGATE_ARRAY(uint32_t, uint32)
+
+extern int aggregate_int32_array
+	AGGREGATE_ARRAY(int32_t, int32)
+
+extern int aggregate_uint64_array
+	AGGREGATE_ARRAY(uint64_t, uint64)
+
+extern int aggregate_int64_array
+	AGGREGATE_ARRAY(int64_t, int64)
+
+#undef AGGREGATE_ARRAY
+
+//generic function for selection of array elements-------------------------------------------------
+
+#define SELECT_RANGE(itype, ctype) \
+(const itype *array, const size_t size, const itype lo, const itype hi, size_t *selection, \
+itype *values, size_t *count) \
+{ \
+	/*check the arguments*/ \
+	if ( (array == NULL) || (size == 0) || (selection == NULL) || (count == NULL) ) { \
+		error("wrong arguments"); \
+		return -1; \
+		} \
+	\
+	*count = kernels->select_##ctype##_range(array, size, lo, hi, selection, values); \
+	return 0; \
+}
+
+extern int select_uint8_range
+	SELECT_RANGE(uint8_t, uint8)
+
+extern int select_int8_range
+	SELECT_RANGE(int8_t, int8)
+
+extern int select_uint16_range
+	SELECT_RANGE(uint16_t, uint16)
+
+extern int select_int16_range
+	SELECT_RANGE(int16_t, int16)
+
+extern int select_uint32_range
+	SELECT_RANGE(uint32_t, uint32)
+
+extern int select_int32_range
+	SELECT_RANGE(int32_t, int32)
+
+extern int select_uint64_range
+	SELECT_RANGE(uint64_t, uint64)
+
+extern int select_int64_range
+	SELECT_RANGE(int64_t, int64)
+
+#undef SELECT_RANGE
+
+//generic function for ranking of values among a few keys------------------------------------------
+
+extern int rank_uint32_small(const uint32_t *keys, const uint32_t *values, const size_t size,
+	size_t *ranks)
+{
+	//check the arguments
+	if ( (keys == NULL) || (values == NULL) || (size == 0) || (ranks == NULL) ) {
+		error("wrong arguments");
+		return -1;
+		}
+
+	kernels->rank_uint32_small(keys, values, size, ranks);
+	return 0;
+}
+
 //random data generation---------------------------------------------------------------------------
 
 //Windows-only
@@ -21,8 +21,55 @@ license: BSD 2-Clause
 
 #include "poison.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //macro for printing error messages easily
+/*define HD_QUIET to compile error messages out, e.g. when wrong input is expected under heavy load;
+then use check_itype_range() to get a place of an error*/
+#ifdef HD_QUIET
+#define error(...) ((void)0)
+#else
 #define error(...) fprintf(stderr, "error: %s: %i: %s\n", __func__, __LINE__, __VA_ARGS__)
+#endif
+
+//128-bit integers are supported only by compilers which have __int128 type (e.g. GCC and Clang
+//on 64-bit platforms)
+#ifdef __SIZEOF_INT128__
+#define HD_HAVE_INT128
+typedef unsigned __int128 hd_uint128_t;
+typedef __int128 hd_int128_t;
+#define HD_UINT128_MAX (~(hd_uint128_t)0)
+#define HD_INT128_MAX ( (hd_int128_t)(HD_UINT128_MAX >> 1) )
+#define HD_INT128_MIN (-HD_INT128_MAX - 1)
+#endif
+
+//supported types of input elements, used where type is known only at runtime
+enum hd_type {
+	HD_UINT8,
+	HD_INT8,
+	HD_UINT16,
+	HD_INT16,
+	HD_UINT32,
+	HD_INT32,
+	HD_UINT64,
+	HD_INT64
+	};
+
+//codes of errors in struct hd_error
+enum hd_error_code {
+	HD_OK,				//no error
+	HD_WRONG_ARGS,		//wrong arguments of function
+	HD_WRONG_MIN,		//element of array is less than minimum
+	HD_WRONG_MAX		//element of array is greater than maximum
+	};
+
+//description of an error in array
+struct hd_error {
+	enum hd_error_code code;
+	size_t index;		//index of the first wrong element
+	};
 
 //get minimum and maximum array values
 //functions for unsigned and signed 8, 16, 32, 64 bit integer arrays
@@ -46,6 +93,13 @@ extern int get_uint64_minmax(const uint64_t *array, const size_t size,
 extern int get_int64_minmax(const int64_t *array, const size_t size,
 	int64_t *min, int64_t *max);
 
+#ifdef HD_HAVE_INT128
+extern int get_uint128_minmax(const hd_uint128_t *array, const size_t size,
+	hd_uint128_t *min, hd_uint128_t *max);
+extern int get_int128_minmax(const hd_int128_t *array, const size_t size,
+	hd_int128_t *min, hd_int128_t *max);
+#endif
+
 //for float, double and long double floating-point number arrays
 extern int get_float_minmax(const float *array, const size_t size,
 	float *min, float *max);
@@ -54,7 +108,121 @@ extern int get_double_minmax(const double *array, const size_t size,
 extern int get_longd_minmax(const long double *array, const size_t size,
 	long double *min, long double *max);
 
+//check that all elements of array are in [min; max]; on failure return -1 and write index of the
+//first wrong element to err (if it's not NULL)
+extern int check_uint8_range(const uint8_t *array, const size_t size,
+	const uint8_t min, const uint8_t max, struct hd_error *err);
+extern int check_int8_range(const int8_t *array, const size_t size,
+	const int8_t min, const int8_t max, struct hd_error *err);
+
+extern int check_uint16_range(const uint16_t *array, const size_t size,
+	const uint16_t min, const uint16_t max, struct hd_error *err);
+extern int check_int16_range(const int16_t *array, const size_t size,
+	const int16_t min, const int16_t max, struct hd_error *err);
+
+extern int check_uint32_range(const uint32_t *array, const size_t size,
+	const uint32_t min, const uint32_t max, struct hd_error *err);
+extern int check_int32_range(const int32_t *array, const size_t size,
+	const int32_t min, const int32_t max, struct hd_error *err);
+
+extern int check_uint64_range(const uint64_t *array, const size_t size,
+	const uint64_t min, const uint64_t max, struct hd_error *err);
+extern int check_int64_range(const int64_t *array, const size_t size,
+	const int64_t min, const int64_t max, struct hd_error *err);
+
+#ifdef HD_HAVE_INT128
+extern int check_uint128_range(const hd_uint128_t *array, const size_t size,
+	const hd_uint128_t min, const hd_uint128_t max, struct hd_error *err);
+extern int check_int128_range(const hd_int128_t *array, const size_t size,
+	const hd_int128_t min, const hd_int128_t max, struct hd_error *err);
+#endif
+
+//aggregates of array elements: sum, minimum, maximum and number of elements. sum is computed in
+//64-bit integers, so it's taken modulo 2^64 on overflow (e.g. for big 64-bit integers)
+#define HD_AGGREGATE(itype, stype, ctype) \
+struct hd_##ctype##_aggregate { \
+	stype sum; \
+	itype min; \
+	itype max; \
+	size_t count; \
+	};
+
+HD_AGGREGATE(uint8_t, uint64_t, uint8)
+HD_AGGREGATE(int8_t, int64_t, int8)
+HD_AGGREGATE(uint16_t, uint64_t, uint16)
+HD_AGGREGATE(int16_t, int64_t, int16)
+HD_AGGREGATE(uint32_t, uint64_t, uint32)
+HD_AGGREGATE(int32_t, int64_t, int32)
+HD_AGGREGATE(uint64_t, uint64_t, uint64)
+HD_AGGREGATE(int64_t, int64_t, int64)
+
+#undef HD_AGGREGATE
+
+//add elements of array to aggregates, so array can be processed by parts; set agg->count to 0
+//before the first call
+extern int aggregate_uint8_array(const uint8_t *array, const size_t size,
+	struct hd_uint8_aggregate *agg);
+extern int aggregate_int8_array(const int8_t *array, const size_t size,
+	struct hd_int8_aggregate *agg);
+extern int aggregate_uint16_array(const uint16_t *array, const size_t size,
+	struct hd_uint16_aggregate *agg);
+extern int aggregate_int16_array(const int16_t *array, const size_t size,
+	struct hd_int16_aggregate *agg);
+extern int aggregate_uint32_array(const uint32_t *array, const size_t size,
+	struct hd_uint32_aggregate *agg);
+extern int aggregate_int32_array(const int32_t *array, const size_t size,
+	struct hd_int32_aggregate *agg);
+extern int aggregate_uint64_array(const uint64_t *array, const size_t size,
+	struct hd_uint64_aggregate *agg);
+extern int aggregate_int64_array(const int64_t *array, const size_t size,
+	struct hd_int64_aggregate *agg);
+
+//select elements of array which are in [lo; hi]: write their indices to selection and elements
+//themselves to values (if it's not NULL), write their number to count. selection and values must
+//have space for size elements.
+extern int select_uint8_range(const uint8_t *array, const size_t size, const uint8_t lo,
+	const uint8_t hi, size_t *selection, uint8_t *values, size_t *count);
+extern int select_int8_range(const int8_t *array, const size_t size, const int8_t lo,
+	const int8_t hi, size_t *selection, int8_t *values, size_t *count);
+extern int select_uint16_range(const uint16_t *array, const size_t size, const uint16_t lo,
+	const uint16_t hi, size_t *selection, uint16_t *values, size_t *count);
+extern int select_int16_range(const int16_t *array, const size_t size, const int16_t lo,
+	const int16_t hi, size_t *selection, int16_t *values, size_t *count);
+extern int select_uint32_range(const uint32_t *array, const size_t size, const uint32_t lo,
+	const uint32_t hi, size_t *selection, uint32_t *values, size_t *count);
+extern int select_int32_range(const int32_t *array, const size_t size, const int32_t lo,
+	const int32_t hi, size_t *selection, int32_t *values, size_t *count);
+extern int select_uint64_range(const uint64_t *array, const size_t size, const uint64_t lo,
+	const uint64_t hi, size_t *selection, uint64_t *values, size_t *count);
+extern int select_int64_range(const int64_t *array, const size_t size, const int64_t lo,
+	const int64_t hi, size_t *selection, int64_t *values, size_t *count);
+
+//write to ranks the number of keys which are not bigger than value for every element of values.
+//keys must be sorted and contain HD_RANK_KEYS elements (pad them with UINT32_MAX if needed).
+#define HD_RANK_KEYS 32
+extern int rank_uint32_small(const uint32_t *keys, const uint32_t *values, const size_t size,
+	size_t *ranks);
+
+//variants of kernels (minmax, range checking, aggregation, selection and ranking loops): generic C
+//code and AVX2 intrinsics for integer elements up to 64 bits (64-bit x86 only; floating point
+//minmax and selection of 64-bit elements use generic code in all variants). results of all
+//variants are the same. the best variant supported by processor is chosen at program start; set
+//HD_VARIANT environment variable to "generic" or "avx2" to override this choice, e.g. for
+//benchmarking. set_kernel_variant() changes it at runtime, but it isn't thread-safe.
+enum hd_variant {
+	HD_GENERIC,
+	HD_AVX2
+	};
+
+extern int set_kernel_variant(const enum hd_variant variant);
+extern enum hd_variant get_kernel_variant(void);
+extern const char *get_kernel_variant_name(void);
+
 //random data generation
 extern void randombytes(unsigned char *x, unsigned long long xlen);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,1747 @@
+/*
+distribution objects for arbitrary distributed integers
+license: BSD 2-Clause
+*/
+
+#include "hd_dist.h"
+
+//parameters in following generic functions:
+//itype - type of input elements
+//ctype - name of itype in function names (e.g. uint8 for uint8_t)
+//ctype_t - type of intermediate elements
+//otype - type of container elements
+//TYPE - value of enum hd_type for itype
+
+//number of elements decoded at once: their intermediate values and indices are kept on stack
+#define DIST_BLOCK 1024
+
+/*distributions with less intermediate values (i.e. with 8- or 16-bit ones) use inverse table of
+at most 256 KB*/
+#define TABLE_MAX 65536
+
+/*number of elements in a block of compressed cumulative weights: sum of weights of a block often
+fits in 16 bits, and search in a block reads a few cache lines*/
+#define CUMULS_BLOCK 256
+
+//methods of search of decoded elements by intermediate values
+enum dist_search {
+	SEARCH_GUIDE,		//guide table
+	SEARCH_BLOCKS,		//blocks of compressed cumulative weights in Eytzinger layout
+	SEARCH_TABLE,		//inverse table
+	SEARCH_COMPARE,		//comparison with all cumulative weights
+	SEARCH_PIECES		//inverse interpolation of piecewise linear cumulative weights
+	};
+
+struct hd_dist {
+	enum hd_type type;		//type of elements
+	uint64_t min, max;		//minimum and maximum values (signed ones are sign-extended)
+	/*sorted values of sparse distribution (sign-extended too): index of element in cumuls is the
+	index of its value here. it's NULL for distribution of all values in [min; max].*/
+	uint64_t *values;
+	uint64_t *cumuls;		//cumulative weights or NULL if they are compressed
+	size_t wsize;			//size of cumuls array
+	uint64_t total;			//maximum cumulative weight
+	int osize;				//size of container element in bytes
+	size_t csize;			//size of intermediate element in bytes
+	/*true if every intermediate value is possible, then container consists of copy of
+	intermediate array followed by random numbers*/
+	bool full;
+	/*guide table: intermediate values are split into gsize buckets of equal size, guide[j] is the
+	index of element of the first value of j-th bucket, guide[gsize] is the last index*/
+	size_t *guide;
+	size_t gsize;
+	/*compressed cumulative weights of big distributions: elements are split into nblocks blocks of
+	CUMULS_BLOCK elements, blocks[b] is cumulative weight of the last element of b-th block, and
+	offsets (16-bit ones if sums of weights of all blocks fit in them) are cumulative weights from
+	the start of block*/
+	uint64_t *blocks;
+	size_t nblocks;
+	uint16_t *offsets16;
+	uint32_t *offsets32;
+	/*piecewise linear cumulative weights of parametric distribution: k-th piece consists of
+	elements [knots[k]; knots[k+1]-1] (knots[npieces] is wsize), and cumulative weight of elements
+	before element t of piece is knot_cumuls[k] + (t - knots[k])*(its weight)/(its size) rounded
+	down*/
+	uint64_t *knots;
+	uint64_t *knot_cumuls;
+	size_t npieces;
+	/*cumulative weights of blocks in Eytzinger layout (BFS order of binary search tree of esize
+	elements, eytz[1] is the root and eytz[2k], eytz[2k+1] are children of eytz[k]) and their
+	indices*/
+	uint32_t *eytz;
+	uint32_t *eytz_index;
+	size_t esize;
+	/*inverse table: index of element for every intermediate value, it's used if there are less
+	than TABLE_MAX intermediate values*/
+	uint32_t *table;
+	//cumulative weights of small distribution padded with UINT32_MAX, see rank_uint32_small()
+	uint32_t keys[HD_RANK_KEYS];
+	enum dist_search search;
+};
+
+//create and free a distribution-------------------------------------------------------------------
+
+/*build guide table with one bucket per element (but not more buckets than intermediate values):
+then every bucket contains about one element, and search in it takes constant expected time*/
+static int init_guide(struct hd_dist *dist)
+{
+	//first intermediate value of current bucket and index of its element
+	uint64_t first;
+	size_t index, j;
+
+	dist->gsize = (dist->wsize < dist->total) ? dist->wsize : dist->total;
+	if ( (dist->guide = malloc((dist->gsize+1)*sizeof(size_t))) == NULL ) {
+		error("couldn't allocate memory for guide table");
+		return -1;
+		}
+
+	//value v is in bucket v*gsize/total, so the first value of j-th bucket is ceil(j*total/gsize)
+	index = 0;
+	for (j = 0; j < dist->gsize; j++) {
+		first = ( (uint64_t)j*dist->total + dist->gsize - 1 ) / dist->gsize;
+		while (dist->cumuls[index] <= first)
+			index++;
+		dist->guide[j] = index;
+		}
+	dist->guide[dist->gsize] = dist->wsize - 1;
+
+	return 0;
+}
+
+/*fill Eytzinger layout by in-order traversal of implicit tree, return index of the next element of
+keys*/
+static size_t fill_eytz(struct hd_dist *dist, const uint64_t *keys, size_t index, const size_t k)
+{
+	if (k <= dist->esize) {
+		index = fill_eytz(dist, keys, index, 2*k);
+		dist->eytz[k] = keys[index];
+		dist->eytz_index[k] = index++;
+		index = fill_eytz(dist, keys, index, 2*k + 1);
+		}
+
+	return index;
+}
+
+/*build Eytzinger layout of esize keys: first levels of tree are packed in a few cache lines, and
+search can prefetch descendants of current node before comparison with it*/
+static int init_eytz(struct hd_dist *dist, const uint64_t *keys)
+{
+	if ( (dist->eytz = malloc((dist->esize+1)*sizeof(uint32_t))) == NULL ) {
+		error("couldn't allocate memory for Eytzinger layout");
+		return -1;
+		}
+	if ( (dist->eytz_index = malloc((dist->esize+1)*sizeof(uint32_t))) == NULL ) {
+		error("couldn't allocate memory for Eytzinger layout");
+		return -1;
+		}
+
+	//cumulative weights are less than 2^32, so they are saved in 32 bits
+	fill_eytz(dist, keys, 0, 1);
+	return 0;
+}
+
+/*compress cumulative weights of weights: keep 64-bit ones for blocks only and 16- or 32-bit ones
+for elements, so distribution takes 2-4 bytes per element instead of 8*/
+static int init_blocks(struct hd_dist *dist, const uint32_t *weights)
+{
+	//cumulative weights of current element and of the end of previous block
+	uint64_t cumul, prev;
+	//true if sum of weights of a block doesn't fit in 16 bits
+	bool wide;
+	size_t b, index;
+
+	dist->nblocks = (dist->wsize + CUMULS_BLOCK - 1) / CUMULS_BLOCK;
+	if ( (dist->blocks = malloc(dist->nblocks*sizeof(uint64_t))) == NULL ) {
+		error("couldn't allocate memory for blocks of cumuls");
+		return -1;
+		}
+
+	cumul = 0;
+	wide = false;
+	index = 0;
+	for (b = 0; b < dist->nblocks; b++) {
+		prev = cumul;
+		for (; (index < dist->wsize) && (index < (b+1)*CUMULS_BLOCK); index++)
+			cumul += weights[index];
+		//sum of weights of a block is less than 2^40, so it doesn't overflow before this check
+		if (cumul >= 4294967296) {
+			error("too many values for any supported output type");
+			return -1;
+			}
+		if (cumul - prev > UINT16_MAX)
+			wide = true;
+		dist->blocks[b] = cumul;
+		}
+
+	if (wide)
+		dist->offsets32 = malloc(dist->wsize*sizeof(uint32_t));
+	else
+		dist->offsets16 = malloc(dist->wsize*sizeof(uint16_t));
+	if ( (dist->offsets32 == NULL) && (dist->offsets16 == NULL) ) {
+		error("couldn't allocate memory for offsets of cumuls");
+		return -1;
+		}
+
+	cumul = 0;
+	for (index = 0; index < dist->wsize; index++) {
+		if (index % CUMULS_BLOCK == 0)
+			cumul = 0;
+		cumul += weights[index];
+		if (wide)
+			dist->offsets32[index] = cumul;
+		else
+			dist->offsets16[index] = cumul;
+		}
+
+	return 0;
+}
+
+/*build inverse table: values [cumuls[index-1]; cumuls[index]-1] correspond to index, so search is
+replaced with one load from a table which fits in L2 cache*/
+static int init_table(struct hd_dist *dist)
+{
+	size_t index;
+	uint64_t value;
+
+	if ( (dist->table = malloc(dist->total*sizeof(uint32_t))) == NULL ) {
+		error("couldn't allocate memory for inverse table");
+		return -1;
+		}
+
+	value = 0;
+	for (index = 0; index < dist->wsize; index++)
+		for (; value < dist->cumuls[index]; value++)
+			dist->table[value] = index;
+
+	return 0;
+}
+
+//choose intermediate and container types by maximum cumulative weight
+static int init_dist(struct hd_dist *dist)
+{
+	size_t i;
+
+	if (dist->cumuls != NULL)
+		dist->total = dist->cumuls[dist->wsize-1];
+	else if (dist->knots != NULL)
+		dist->total = dist->knot_cumuls[dist->npieces];
+	else
+		dist->total = dist->blocks[dist->nblocks-1];
+	if (dist->total == 0) {
+		error("all weights are 0");
+		return -1;
+		}
+	else if (dist->total < 256)				//2^8
+		dist->csize = 1;
+	else if (dist->total < 65536)			//2^16
+		dist->csize = 2;
+	else if (dist->total < 4294967296)		//2^32
+		dist->csize = 4;
+	else {
+		error("too many values for any supported output type");
+		return -1;
+		}
+	dist->osize = 2*dist->csize;
+	/*intermediate values are in [0; total], so every value is possible if total is the maximum
+	value of intermediate type*/
+	dist->full = ( dist->total == (UINT64_MAX >> (64 - 8*dist->csize)) );
+
+	/*parametric distributions have no cumulative weights of elements, compressed cumulative
+	weights are searched by blocks, inverse table is small if there are few
+	intermediate values, few elements are compared with intermediate values at once. indices of
+	inverse table must fit in 32 bits.*/
+	if (dist->knots != NULL) {
+		dist->search = SEARCH_PIECES;
+		return 0;
+		}
+	if (dist->cumuls == NULL) {
+		dist->search = SEARCH_BLOCKS;
+		dist->esize = dist->nblocks;
+		return init_eytz(dist, dist->blocks);
+		}
+	if ( (dist->total < TABLE_MAX) && (dist->wsize < UINT32_MAX) ) {
+		dist->search = SEARCH_TABLE;
+		return init_table(dist);
+		}
+	if (dist->wsize <= HD_RANK_KEYS) {
+		dist->search = SEARCH_COMPARE;
+		for (i = 0; i < HD_RANK_KEYS; i++)
+			dist->keys[i] = (i < dist->wsize) ? dist->cumuls[i] : UINT32_MAX;
+		return 0;
+		}
+	dist->search = SEARCH_GUIDE;
+	return init_guide(dist);
+}
+
+/*get cumulative weights of elements, compressed ones for big distributions, and choose method of
+search*/
+static int init_cumuls(struct hd_dist *dist, const uint32_t *weights)
+{
+	if (dist->wsize > HD_DIST_GUIDE_MAX) {
+		if (init_blocks(dist, weights))
+			return -1;
+		}
+	else {
+		if ( (dist->cumuls = malloc(dist->wsize*sizeof(uint64_t))) == NULL ) {
+			error("couldn't allocate memory for cumuls");
+			return -1;
+			}
+		if (get_cumuls(weights, dist->cumuls, dist->wsize))
+			return -1;
+		}
+
+	return init_dist(dist);
+}
+
+extern void free_dist(struct hd_dist *dist)
+{
+	if (dist == NULL)
+		return;
+	free(dist->values);
+	free(dist->cumuls);
+	free(dist->blocks);
+	free(dist->offsets16);
+	free(dist->offsets32);
+	free(dist->knots);
+	free(dist->knot_cumuls);
+	free(dist->guide);
+	free(dist->eytz);
+	free(dist->eytz_index);
+	free(dist->table);
+	free(dist);
+}
+
+#define CREATE_DIST(itype, TYPE) \
+(const itype min, const itype max, const uint32_t *weights) \
+{ \
+	/*check the arguments*/ \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	if (weights == NULL) { \
+		error("weights = NULL"); \
+		return NULL; \
+		} \
+	\
+	struct hd_dist *dist; \
+	uint64_t wsize_check; \
+	\
+	if ( (dist = calloc(1, sizeof(struct hd_dist))) == NULL ) { \
+		error("couldn't allocate memory for distribution"); \
+		return NULL; \
+		} \
+	dist->type = TYPE; \
+	dist->min = min; \
+	dist->max = max; \
+	\
+	/*get size of weights and cumuls arrays. it is 0 after an overflow if every value of 64-bit \
+	type is possible, and it can be too big for size_t type.*/ \
+	wsize_check = (uint64_t)max - (uint64_t)min + 1; \
+	dist->wsize = wsize_check; \
+	if ( (wsize_check == 0) || (dist->wsize != wsize_check) ) { \
+		error("can't handle such big supplementary arrays"); \
+		free(dist); \
+		return NULL; \
+		} \
+	\
+	if (init_cumuls(dist, weights)) { \
+		free_dist(dist); \
+		return NULL; \
+		} \
+	\
+	return dist; \
+}
+
+extern struct hd_dist *create_uint8_dist
+	CREATE_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_dist
+	CREATE_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_dist
+	CREATE_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_dist
+	CREATE_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_dist
+	CREATE_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_dist
+	CREATE_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_dist
+	CREATE_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_dist
+	CREATE_DIST(int64_t, HD_INT64)
+
+#undef CREATE_DIST
+
+#define CREATE_SPARSE_DIST(itype, TYPE) \
+(const itype *values, const uint32_t *weights, const size_t count) \
+{ \
+	/*check the arguments*/ \
+	if (values == NULL) { \
+		error("values = NULL"); \
+		return NULL; \
+		} \
+	if (weights == NULL) { \
+		error("weights = NULL"); \
+		return NULL; \
+		} \
+	if (count == 0) { \
+		error("count = 0"); \
+		return NULL; \
+		} \
+	/*indices of elements are encoded as 32-bit integers*/ \
+	if (count > UINT32_MAX) { \
+		error("too many values"); \
+		return NULL; \
+		} \
+	\
+	struct hd_dist *dist; \
+	size_t i; \
+	\
+	for (i = 1; i < count; i++) \
+		if (values[i] <= values[i-1]) { \
+			error("values aren't sorted in ascending order or repeat"); \
+			return NULL; \
+			} \
+	\
+	if ( (dist = calloc(1, sizeof(struct hd_dist))) == NULL ) { \
+		error("couldn't allocate memory for distribution"); \
+		return NULL; \
+		} \
+	dist->type = TYPE; \
+	dist->min = values[0]; \
+	dist->max = values[count-1]; \
+	dist->wsize = count; \
+	\
+	if ( (dist->values = malloc(count*sizeof(uint64_t))) == NULL ) { \
+		error("couldn't allocate memory for values"); \
+		free_dist(dist); \
+		return NULL; \
+		} \
+	for (i = 0; i < count; i++) \
+		dist->values[i] = values[i]; \
+	if (init_cumuls(dist, weights)) { \
+		free_dist(dist); \
+		return NULL; \
+		} \
+	\
+	return dist; \
+}
+
+extern struct hd_dist *create_uint8_sparse_dist
+	CREATE_SPARSE_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_sparse_dist
+	CREATE_SPARSE_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_sparse_dist
+	CREATE_SPARSE_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_sparse_dist
+	CREATE_SPARSE_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_sparse_dist
+	CREATE_SPARSE_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_sparse_dist
+	CREATE_SPARSE_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_sparse_dist
+	CREATE_SPARSE_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_sparse_dist
+	CREATE_SPARSE_DIST(int64_t, HD_INT64)
+
+#undef CREATE_SPARSE_DIST
+
+extern int dist_container_size(const struct hd_dist *dist)
+{
+	if (dist == NULL) {
+		error("dist = NULL");
+		return -1;
+		}
+
+	return dist->osize;
+}
+
+//parametric distributions-------------------------------------------------------------------------
+
+/*cumulative weights of parametric distributions are piecewise linear: they need 128-bit
+multiplication for wide pieces, so these distributions are supported only with 128-bit integers*/
+#ifdef HD_HAVE_INT128
+
+//get a*b/c rounded down, where b and the result are less than 2^32
+static uint64_t mul_div(const uint64_t a, const uint64_t b, const uint64_t c)
+{
+	if (a <= UINT32_MAX)
+		return a*b / c;
+	else
+		return (hd_uint128_t)a*b / c;
+}
+
+//get a*b/c rounded up, where a is not bigger than 2^32
+static uint64_t mul_div_up(const uint64_t a, const uint64_t b, const uint64_t c)
+{
+	if (b <= UINT32_MAX)
+		return (a*b + c - 1) / c;
+	else
+		return ( (hd_uint128_t)a*b + c - 1 ) / c;
+}
+
+/*get cumulative weight of elements [0; t-1] of parametric distribution: find the last piece which
+starts not after t and interpolate cumulative weights of its bounds*/
+static uint64_t get_piece_cumul(const struct hd_dist *dist, const uint64_t t)
+{
+	//bounds of search
+	size_t low, middle, high;
+
+	low = 0;
+	high = dist->npieces;
+	while (high - low > 1) {
+		middle = low + (high - low)/2;
+		if (dist->knots[middle] <= t)
+			low = middle;
+		else
+			high = middle;
+		}
+
+	return dist->knot_cumuls[low] + mul_div(t - dist->knots[low],
+		dist->knot_cumuls[low+1] - dist->knot_cumuls[low], dist->knots[low+1] - dist->knots[low]);
+}
+
+/*number of knots of parametric distribution from its anchor to one end of range: pieces of 1
+element are followed by ones which are 1/16 longer than their distance from anchor, so 2^64
+elements are covered by less than 800 pieces*/
+#define SIDE_KNOTS 800
+
+/*shape of parametric distribution: cdf() gets probability (maybe not normalized) of elements
+[0; t-1], and pieces get longer with distance from anchor element, where probability is the
+biggest*/
+struct shape {
+	double (*cdf)(const struct shape *shape, const double t);
+	double a, b;
+	uint64_t anchor;
+};
+
+/*discretized normal distribution with mean a and standard deviation b (mean is an offset from
+minimum of range)*/
+static double normal_cdf(const struct shape *shape, const double t)
+{
+	return 0.5 * erfc( -(t - 0.5 - shape->a) / (shape->b * M_SQRT2) );
+}
+
+//geometric distribution: probability of element t is proportional to (1 - a)^t
+static double geometric_cdf(const struct shape *shape, const double t)
+{
+	return -expm1( t * log1p(-shape->a) );
+}
+
+/*Zipf distribution: probability of element t is proportional to 1/(t + 1)^a. sum of these
+probabilities is computed for the first 16 elements and approximated by integral for other ones.*/
+static double zipf_cdf(const struct shape *shape, const double t)
+{
+	double sum = 0;
+	int j;
+
+	for (j = 1; (j <= 16) && (j <= t); j++)
+		sum += pow(j, -shape->a);
+	if (t <= 16)
+		return sum;
+
+	if (shape->a == 1)
+		return sum + log(t + 0.5) - log(16.5);
+	else
+		return sum + ( pow(t + 0.5, 1 - shape->a) - pow(16.5, 1 - shape->a) ) / (1 - shape->a);
+}
+
+//get offset of the next knot from anchor or 0 if it's not less than limit
+static uint64_t next_knot_offset(const uint64_t offset, const uint64_t limit)
+{
+	const uint64_t step = 1 + offset/16;
+
+	return (limit - offset > step) ? offset + step : 0;
+}
+
+/*get cumulative weights of pieces from probabilities of shape: every element of range gets weight
+1, if it's possible, and the rest of maximum total weight is split by probabilities*/
+static int init_shape(struct hd_dist *dist, const struct shape *shape)
+{
+	//offsets of knots before anchor from it
+	uint64_t left[SIDE_KNOTS];
+	//maximum total weight and its part which is split by probabilities
+	const uint64_t budget = UINT32_MAX;
+	const uint64_t split = (dist->wsize < budget) ? budget - dist->wsize : budget;
+	//number of elements after anchor
+	const uint64_t right = dist->wsize - shape->anchor - 1;
+	//probabilities of elements before knots and of all range
+	double prev, current, range;
+	//sum of parts of split, which are given to pieces by probabilities
+	uint64_t sum;
+	uint64_t offset;
+	//number of knots before anchor, maximum and current number of knots
+	size_t nleft, size, k;
+
+	//knots are 0, anchor - offset for offsets in reverse order, anchor + 1 + offset and wsize
+	nleft = 0;
+	offset = 0;
+	if (shape->anchor > 0)
+		do
+			left[nleft++] = offset;
+		while ( ( (offset = next_knot_offset(offset, shape->anchor)) != 0 ) &&
+			(nleft < SIDE_KNOTS) );
+
+	size = nleft + SIDE_KNOTS + 2;
+	if ( ( (dist->knots = malloc(size*sizeof(uint64_t))) == NULL ) ||
+		( (dist->knot_cumuls = malloc(size*sizeof(uint64_t))) == NULL ) ) {
+		error("couldn't allocate memory for pieces");
+		return -1;
+		}
+
+	k = 0;
+	dist->knots[k++] = 0;
+	while (nleft > 0)
+		dist->knots[k++] = shape->anchor - left[--nleft];
+	offset = 0;
+	if (right > 0)
+		do
+			dist->knots[k++] = shape->anchor + 1 + offset;
+		while ( ( (offset = next_knot_offset(offset, right)) != 0 ) && (k < size - 1) );
+	dist->knots[k] = dist->wsize;
+	dist->npieces = k;
+
+	range = shape->cdf(shape, dist->wsize) - shape->cdf(shape, 0);
+	if ( !(range > 0) || !isfinite(range) )
+		range = INFINITY;
+	//knot_cumuls[k+1] is the part of split for piece k at first
+	prev = shape->cdf(shape, 0);
+	sum = 0;
+	for (k = 0; k < dist->npieces; k++) {
+		current = shape->cdf(shape, dist->knots[k+1]);
+		dist->knot_cumuls[k+1] = (current > prev) ? (current - prev) / range * split : 0;
+		sum += dist->knot_cumuls[k+1];
+		prev = current;
+		}
+
+	/*rounding errors mustn't make total weight bigger than maximum, so parts are scaled down
+	proportionally then, and weights of elements are added after it, so none of them becomes 0*/
+	dist->knot_cumuls[0] = 0;
+	for (k = 0; k < dist->npieces; k++) {
+		if (sum > split)
+			dist->knot_cumuls[k+1] = mul_div(dist->knot_cumuls[k+1], split, sum);
+		if (dist->wsize < budget)
+			dist->knot_cumuls[k+1] += dist->knots[k+1] - dist->knots[k];
+		dist->knot_cumuls[k+1] += dist->knot_cumuls[k];
+		}
+
+	return init_dist(dist);
+}
+
+#undef SIDE_KNOTS
+
+/*write to indices the index of the first element whose cumulative weight is bigger than
+intermediate value: find the first piece which ends with such cumulative weight, then invert
+interpolation on it*/
+static void find_indices_pieces(const struct hd_dist *dist, const uint32_t *temp_array,
+	size_t *indices, const size_t n)
+{
+	const uint64_t *knots = dist->knots, *cumuls = dist->knot_cumuls;
+	//bounds of search
+	size_t low, middle, high;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		low = 0;
+		high = dist->npieces - 1;
+		while (low < high) {
+			middle = low + (high - low)/2;
+			if (temp_array[i] < cumuls[middle+1])
+				high = middle;
+			else
+				low = middle + 1;
+			}
+
+		indices[i] = knots[low] - 1 + mul_div_up(temp_array[i] - cumuls[low] + 1,
+			knots[low+1] - knots[low], cumuls[low+1] - cumuls[low]);
+		}
+}
+
+//allocate parametric distribution of elements in [min; max]
+static struct hd_dist *new_parametric_dist(const enum hd_type type, const uint64_t min,
+	const uint64_t max)
+{
+	struct hd_dist *dist;
+
+	if (max - min + 1 == 0) {
+		error("can't handle all values of 64-bit integers");
+		return NULL;
+		}
+	if ( (dist = calloc(1, sizeof(struct hd_dist))) == NULL ) {
+		error("couldn't allocate memory for distribution");
+		return NULL;
+		}
+	dist->type = type;
+	dist->min = min;
+	dist->max = max;
+	dist->wsize = max - min + 1;
+
+	return dist;
+}
+
+#define CREATE_PIECEWISE_DIST(itype, TYPE) \
+(const itype *starts, const uint32_t *weights, const size_t count, const itype max) \
+{ \
+	/*check the arguments*/ \
+	if (starts == NULL) { \
+		error("starts = NULL"); \
+		return NULL; \
+		} \
+	if (weights == NULL) { \
+		error("weights = NULL"); \
+		return NULL; \
+		} \
+	if (count == 0) { \
+		error("count = 0"); \
+		return NULL; \
+		} \
+	\
+	struct hd_dist *dist; \
+	size_t k; \
+	\
+	for (k = 1; k < count; k++) \
+		if (starts[k] <= starts[k-1]) { \
+			error("starts aren't sorted in ascending order or repeat"); \
+			return NULL; \
+			} \
+	if (starts[count-1] > max) { \
+		error("the last piece starts after max"); \
+		return NULL; \
+		} \
+	\
+	if ( (dist = new_parametric_dist(TYPE, starts[0], max)) == NULL ) \
+		return NULL; \
+	if ( ( (dist->knots = malloc((count+1)*sizeof(uint64_t))) == NULL ) || \
+		( (dist->knot_cumuls = malloc((count+1)*sizeof(uint64_t))) == NULL ) ) { \
+		error("couldn't allocate memory for pieces"); \
+		free_dist(dist); \
+		return NULL; \
+		} \
+	\
+	/*pieces are kept by offsets of their starts from minimum*/ \
+	for (k = 0; k < count; k++) \
+		dist->knots[k] = (uint64_t)starts[k] - dist->min; \
+	dist->knots[count] = dist->wsize; \
+	dist->knot_cumuls[0] = 0; \
+	dist->npieces = count; \
+	if (get_cumuls(weights, dist->knot_cumuls + 1, count) || init_dist(dist)) { \
+		free_dist(dist); \
+		return NULL; \
+		} \
+	\
+	return dist; \
+}
+
+extern struct hd_dist *create_uint8_piecewise_dist
+	CREATE_PIECEWISE_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_piecewise_dist
+	CREATE_PIECEWISE_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_piecewise_dist
+	CREATE_PIECEWISE_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_piecewise_dist
+	CREATE_PIECEWISE_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_piecewise_dist
+	CREATE_PIECEWISE_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_piecewise_dist
+	CREATE_PIECEWISE_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_piecewise_dist
+	CREATE_PIECEWISE_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_piecewise_dist
+	CREATE_PIECEWISE_DIST(int64_t, HD_INT64)
+
+#undef CREATE_PIECEWISE_DIST
+
+/*create distribution of elements in [min; max] with shape, whose most probable element is mode (an
+offset from minimum, it's clamped to the range)*/
+static struct hd_dist *create_shape_dist(const enum hd_type type, const uint64_t min,
+	const uint64_t max, struct shape *shape, const double mode)
+{
+	struct hd_dist *dist;
+
+	if ( (dist = new_parametric_dist(type, min, max)) == NULL )
+		return NULL;
+
+	if (mode <= 0)
+		shape->anchor = 0;
+	else if (mode >= dist->wsize - 1)
+		shape->anchor = dist->wsize - 1;
+	else
+		shape->anchor = mode + 0.5;
+
+	if (init_shape(dist, shape)) {
+		free_dist(dist);
+		return NULL;
+		}
+
+	return dist;
+}
+
+#define CREATE_NORMAL_DIST(itype, TYPE) \
+(const itype min, const itype max, const double mean, const double sd) \
+{ \
+	struct shape shape = {normal_cdf, mean - (double)min, sd, 0}; \
+	\
+	/*check the arguments*/ \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	if ( !isfinite(mean) || !isfinite(sd) || (sd <= 0) ) { \
+		error("wrong parameters of distribution"); \
+		return NULL; \
+		} \
+	\
+	return create_shape_dist(TYPE, min, max, &shape, shape.a); \
+}
+
+extern struct hd_dist *create_uint8_normal_dist
+	CREATE_NORMAL_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_normal_dist
+	CREATE_NORMAL_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_normal_dist
+	CREATE_NORMAL_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_normal_dist
+	CREATE_NORMAL_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_normal_dist
+	CREATE_NORMAL_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_normal_dist
+	CREATE_NORMAL_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_normal_dist
+	CREATE_NORMAL_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_normal_dist
+	CREATE_NORMAL_DIST(int64_t, HD_INT64)
+
+#undef CREATE_NORMAL_DIST
+
+#define CREATE_GEOMETRIC_DIST(itype, TYPE) \
+(const itype min, const itype max, const double p) \
+{ \
+	struct shape shape = {geometric_cdf, p, 0, 0}; \
+	\
+	/*check the arguments*/ \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	if ( !(p > 0) || !(p < 1) ) { \
+		error("wrong parameters of distribution"); \
+		return NULL; \
+		} \
+	\
+	return create_shape_dist(TYPE, min, max, &shape, 0); \
+}
+
+extern struct hd_dist *create_uint8_geometric_dist
+	CREATE_GEOMETRIC_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_geometric_dist
+	CREATE_GEOMETRIC_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_geometric_dist
+	CREATE_GEOMETRIC_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_geometric_dist
+	CREATE_GEOMETRIC_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_geometric_dist
+	CREATE_GEOMETRIC_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_geometric_dist
+	CREATE_GEOMETRIC_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_geometric_dist
+	CREATE_GEOMETRIC_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_geometric_dist
+	CREATE_GEOMETRIC_DIST(int64_t, HD_INT64)
+
+#undef CREATE_GEOMETRIC_DIST
+
+#define CREATE_ZIPF_DIST(itype, TYPE) \
+(const itype min, const itype max, const double s) \
+{ \
+	struct shape shape = {zipf_cdf, s, 0, 0}; \
+	\
+	/*check the arguments*/ \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	if ( !isfinite(s) || (s <= 0) ) { \
+		error("wrong parameters of distribution"); \
+		return NULL; \
+		} \
+	\
+	return create_shape_dist(TYPE, min, max, &shape, 0); \
+}
+
+extern struct hd_dist *create_uint8_zipf_dist
+	CREATE_ZIPF_DIST(uint8_t, HD_UINT8)
+
+extern struct hd_dist *create_int8_zipf_dist
+	CREATE_ZIPF_DIST(int8_t, HD_INT8)
+
+extern struct hd_dist *create_uint16_zipf_dist
+	CREATE_ZIPF_DIST(uint16_t, HD_UINT16)
+
+extern struct hd_dist *create_int16_zipf_dist
+	CREATE_ZIPF_DIST(int16_t, HD_INT16)
+
+extern struct hd_dist *create_uint32_zipf_dist
+	CREATE_ZIPF_DIST(uint32_t, HD_UINT32)
+
+extern struct hd_dist *create_int32_zipf_dist
+	CREATE_ZIPF_DIST(int32_t, HD_INT32)
+
+extern struct hd_dist *create_uint64_zipf_dist
+	CREATE_ZIPF_DIST(uint64_t, HD_UINT64)
+
+extern struct hd_dist *create_int64_zipf_dist
+	CREATE_ZIPF_DIST(int64_t, HD_INT64)
+
+#undef CREATE_ZIPF_DIST
+
+#endif
+
+//learning of distributions from samples-----------------------------------------------------------
+
+#define COUNT_VALUES(itype, ctype) \
+(const itype *array, const size_t size, const itype min, const itype max, uint64_t *counts) \
+{ \
+	/*check the arguments*/ \
+	if (counts == NULL) { \
+		error("counts = NULL"); \
+		return -1; \
+		} \
+	\
+	/*description of wrong element of array*/ \
+	struct hd_error err; \
+	size_t i; \
+	\
+	if (check_##ctype##_range(array, size, min, max, &err)) { \
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" ); \
+		return -1; \
+		} \
+	\
+	for (i = 0; i < size; i++) \
+		counts[(uint64_t)array[i] - (uint64_t)min]++; \
+	\
+	return 0; \
+}
+
+extern int count_uint8_values
+	COUNT_VALUES(uint8_t, uint8)
+
+extern int count_int8_values
+	COUNT_VALUES(int8_t, int8)
+
+extern int count_uint16_values
+	COUNT_VALUES(uint16_t, uint16)
+
+extern int count_int16_values
+	COUNT_VALUES(int16_t, int16)
+
+extern int count_uint32_values
+	COUNT_VALUES(uint32_t, uint32)
+
+extern int count_int32_values
+	COUNT_VALUES(int32_t, int32)
+
+extern int count_uint64_values
+	COUNT_VALUES(uint64_t, uint64)
+
+extern int count_int64_values
+	COUNT_VALUES(int64_t, int64)
+
+#undef COUNT_VALUES
+
+extern int merge_counts(uint64_t *counts, const uint64_t *other_counts, const size_t wsize)
+{
+	/*check the arguments*/
+	if ( (counts == NULL) || (other_counts == NULL) || (wsize == 0) ) {
+		error("wrong arguments");
+		return -1;
+		}
+
+	//nonzero if some sum overflows
+	uint64_t overflow = 0;
+	size_t i;
+
+	//counts are checked before adding, so they aren't changed on error
+	for (i = 0; i < wsize; i++)
+		overflow |= (counts[i] + other_counts[i] < counts[i]);
+	if (overflow) {
+		error("counts are too big");
+		return -1;
+		}
+
+	for (i = 0; i < wsize; i++)
+		counts[i] += other_counts[i];
+
+	return 0;
+}
+
+extern int quantize_counts(const uint64_t *counts, const size_t wsize, const uint32_t smoothing,
+	uint32_t *weights)
+{
+	/*check the arguments*/
+	if ( (counts == NULL) || (weights == NULL) || (wsize == 0) ) {
+		error("wrong arguments");
+		return -1;
+		}
+
+	//sum of counts, number of counted values and weight which is split by counts
+	uint64_t sum, counted, split;
+	//counts and their sum are shifted right by this number of bits to fit in 32 bits
+	int shift;
+	size_t i;
+
+	sum = 0;
+	counted = 0;
+	for (i = 0; i < wsize; i++) {
+		sum += counts[i];
+		counted += (counts[i] > 0);
+		}
+	if ( (sum == 0) && (smoothing == 0) ) {
+		error("no values are counted");
+		return -1;
+		}
+
+	//every counted value gets weight 1 and smoothing, other values get smoothing only
+	if ( (wsize > UINT32_MAX) || ((uint64_t)smoothing*wsize + counted > UINT32_MAX) ) {
+		error("too many values for any supported output type");
+		return -1;
+		}
+	split = UINT32_MAX - (uint64_t)smoothing*wsize - counted;
+
+	//small counts are used as weights directly, big ones are scaled to the rest of total weight
+	if (sum <= split) {
+		for (i = 0; i < wsize; i++)
+			weights[i] = smoothing + counts[i];
+		return 0;
+		}
+
+	for (shift = 0; (sum >> shift) > UINT32_MAX; shift++)
+		;
+	for (i = 0; i < wsize; i++)
+		weights[i] = smoothing + (counts[i] > 0) + (counts[i] >> shift) * split / (sum >> shift);
+
+	return 0;
+}
+
+#define LEARN_DIST(itype, ctype) \
+(const itype *const *arrays, const size_t *sizes, const size_t count, const itype min, \
+	const itype max, const uint32_t smoothing) \
+{ \
+	/*check the arguments*/ \
+	if ( (arrays == NULL) || (sizes == NULL) || (count == 0) ) { \
+		error("wrong arguments"); \
+		return NULL; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	\
+	struct hd_dist *dist = NULL; \
+	/*counts of values of all arrays and their weights*/ \
+	uint64_t *counts; \
+	uint32_t *weights = NULL; \
+	size_t wsize, j; \
+	uint64_t wsize_check; \
+	\
+	wsize_check = (uint64_t)max - (uint64_t)min + 1; \
+	wsize = wsize_check; \
+	if ( (wsize_check == 0) || (wsize != wsize_check) ) { \
+		error("can't handle such big supplementary arrays"); \
+		return NULL; \
+		} \
+	if ( (counts = calloc(wsize, sizeof(uint64_t))) == NULL ) { \
+		error("couldn't allocate memory for counts"); \
+		return NULL; \
+		} \
+	\
+	/*arrays are counted one by one to the same counts*/ \
+	for (j = 0; j < count; j++) \
+		if ( (sizes[j] > 0) && \
+			count_##ctype##_values(arrays[j], sizes[j], min, max, counts) ) { \
+			free(counts); \
+			return NULL; \
+			} \
+	\
+	if ( (weights = malloc(wsize*sizeof(uint32_t))) == NULL ) \
+		error("couldn't allocate memory for weights"); \
+	else if (quantize_counts(counts, wsize, smoothing, weights) == 0) \
+		dist = create_##ctype##_dist(min, max, weights); \
+	\
+	free(counts); \
+	free(weights); \
+	return dist; \
+}
+
+extern struct hd_dist *learn_uint8_dist
+	LEARN_DIST(uint8_t, uint8)
+
+extern struct hd_dist *learn_int8_dist
+	LEARN_DIST(int8_t, int8)
+
+extern struct hd_dist *learn_uint16_dist
+	LEARN_DIST(uint16_t, uint16)
+
+extern struct hd_dist *learn_int16_dist
+	LEARN_DIST(int16_t, int16)
+
+extern struct hd_dist *learn_uint32_dist
+	LEARN_DIST(uint32_t, uint32)
+
+extern struct hd_dist *learn_int32_dist
+	LEARN_DIST(int32_t, int32)
+
+extern struct hd_dist *learn_uint64_dist
+	LEARN_DIST(uint64_t, uint64)
+
+extern struct hd_dist *learn_int64_dist
+	LEARN_DIST(int64_t, int64)
+
+#undef LEARN_DIST
+
+//comparison of elements for qsort()
+#define COMPARE_VALUES(itype) \
+(const void *a, const void *b) \
+{ \
+	const itype x = *(const itype *)a, y = *(const itype *)b; \
+	\
+	return (x > y) - (x < y); \
+}
+
+static int compare_uint8
+	COMPARE_VALUES(uint8_t)
+
+static int compare_int8
+	COMPARE_VALUES(int8_t)
+
+static int compare_uint16
+	COMPARE_VALUES(uint16_t)
+
+static int compare_int16
+	COMPARE_VALUES(int16_t)
+
+static int compare_uint32
+	COMPARE_VALUES(uint32_t)
+
+static int compare_int32
+	COMPARE_VALUES(int32_t)
+
+static int compare_uint64
+	COMPARE_VALUES(uint64_t)
+
+static int compare_int64
+	COMPARE_VALUES(int64_t)
+
+#undef COMPARE_VALUES
+
+/*elements of all arrays are sorted, so memory and time depend on the number of elements, not on
+their range*/
+#define LEARN_SPARSE_DIST(itype, ctype) \
+(const itype *const *arrays, const size_t *sizes, const size_t count) \
+{ \
+	/*check the arguments*/ \
+	if ( (arrays == NULL) || (sizes == NULL) || (count == 0) ) { \
+		error("wrong arguments"); \
+		return NULL; \
+		} \
+	\
+	struct hd_dist *dist = NULL; \
+	/*sorted elements of all arrays, their distinct values with counts and weights*/ \
+	itype *values; \
+	uint64_t *counts = NULL; \
+	uint32_t *weights = NULL; \
+	/*number of elements of all arrays and of distinct values*/ \
+	size_t size, nvalues; \
+	size_t i, j; \
+	\
+	size = 0; \
+	for (j = 0; j < count; j++) { \
+		if ( (arrays[j] == NULL) && (sizes[j] > 0) ) { \
+			error("array = NULL"); \
+			return NULL; \
+			} \
+		if (sizes[j] > SIZE_MAX - size) { \
+			error("can't handle such big supplementary arrays"); \
+			return NULL; \
+			} \
+		size += sizes[j]; \
+		} \
+	if (size == 0) { \
+		error("no values are counted"); \
+		return NULL; \
+		} \
+	/*counts are the biggest supplementary array*/ \
+	if (size > SIZE_MAX / sizeof(uint64_t)) { \
+		error("can't handle such big supplementary arrays"); \
+		return NULL; \
+		} \
+	if ( (values = malloc(size*sizeof(itype))) == NULL ) { \
+		error("couldn't allocate memory for values"); \
+		return NULL; \
+		} \
+	\
+	size = 0; \
+	for (j = 0; j < count; j++) { \
+		if (sizes[j] > 0) \
+			memcpy(values + size, arrays[j], sizes[j]*sizeof(itype)); \
+		size += sizes[j]; \
+		} \
+	qsort(values, size, sizeof(itype), compare_##ctype); \
+	\
+	if ( ( (counts = malloc(size*sizeof(uint64_t))) == NULL ) || \
+		( (weights = malloc(size*sizeof(uint32_t))) == NULL ) ) { \
+		error("couldn't allocate memory for counts and weights"); \
+		free(values); \
+		free(counts); \
+		return NULL; \
+		} \
+	\
+	/*distinct values are packed to the start of values*/ \
+	nvalues = 0; \
+	for (i = 0; i < size; i++) \
+		if ( (nvalues > 0) && (values[i] == values[nvalues-1]) ) \
+			counts[nvalues-1]++; \
+		else { \
+			values[nvalues] = values[i]; \
+			counts[nvalues++] = 1; \
+			} \
+	\
+	if (quantize_counts(counts, nvalues, 0, weights) == 0) \
+		dist = create_##ctype##_sparse_dist(values, weights, nvalues); \
+	\
+	free(values); \
+	free(counts); \
+	free(weights); \
+	return dist; \
+}
+
+extern struct hd_dist *learn_uint8_sparse_dist
+	LEARN_SPARSE_DIST(uint8_t, uint8)
+
+extern struct hd_dist *learn_int8_sparse_dist
+	LEARN_SPARSE_DIST(int8_t, int8)
+
+extern struct hd_dist *learn_uint16_sparse_dist
+	LEARN_SPARSE_DIST(uint16_t, uint16)
+
+extern struct hd_dist *learn_int16_sparse_dist
+	LEARN_SPARSE_DIST(int16_t, int16)
+
+extern struct hd_dist *learn_uint32_sparse_dist
+	LEARN_SPARSE_DIST(uint32_t, uint32)
+
+extern struct hd_dist *learn_int32_sparse_dist
+	LEARN_SPARSE_DIST(int32_t, int32)
+
+extern struct hd_dist *learn_uint64_sparse_dist
+	LEARN_SPARSE_DIST(uint64_t, uint64)
+
+extern struct hd_dist *learn_int64_sparse_dist
+	LEARN_SPARSE_DIST(int64_t, int64)
+
+#undef LEARN_SPARSE_DIST
+
+//search of decoded elements-----------------------------------------------------------------------
+
+/*buckets with more elements than this number are searched by binary search, other ones by linear
+search*/
+#define LINEAR_SEARCH_MAX 8
+
+/*write to indices the index of the first cumulative weight which is bigger than intermediate value
+for every element of temp_array. the bucket of value in guide table gives the range of indices, and
+the index is searched only in this range.*/
+static void find_indices_guide(const struct hd_dist *dist, const uint32_t *temp_array,
+	size_t *indices, const size_t n)
+{
+	//bounds of search
+	size_t low, middle, high;
+	//bucket of current value
+	size_t bucket;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		bucket = (uint64_t)temp_array[i] * dist->gsize / dist->total;
+		low = dist->guide[bucket];
+		high = dist->guide[bucket+1];
+		if (high - low > LINEAR_SEARCH_MAX)
+			while (low < high) {
+				middle = low + (high - low)/2;
+				if (temp_array[i] < dist->cumuls[middle])
+					high = middle;
+				else
+					low = middle + 1;
+				}
+		else
+			while (temp_array[i] >= dist->cumuls[low])
+				low++;
+
+		indices[i] = low;
+		}
+}
+
+/*number of searches in Eytzinger layout which go down the tree together: every step of a search
+depends on a load of the previous one, so independent searches are interleaved to keep many cache
+misses in flight at once*/
+#define EYTZ_BATCH 16
+
+/*the same with Eytzinger layout: search goes down the tree without branches, and k becomes the
+node of result followed by some 0 bits and one 1 bit. 16 elements fit in a cache line, so node 16k
+and its neighbours are the descendants of node k four levels below, and they are prefetched.*/
+static void find_indices_eytz(const struct hd_dist *dist, const uint32_t *temp_array,
+	size_t *indices, const size_t n)
+{
+	const uint32_t *eytz = dist->eytz;
+	const size_t esize = dist->esize;
+	//nodes of tree for searches of current batch
+	size_t k[EYTZ_BATCH];
+	//number of complete levels of tree: all nodes of them exist
+	size_t levels;
+	//first element and size of current batch
+	size_t start, m;
+	size_t i, level;
+
+	for (levels = 0; ((size_t)2 << levels) - 1 <= esize; levels++)
+		;
+
+	for (start = 0; start < n; start += m) {
+		m = n - start;
+		if (m > EYTZ_BATCH)
+			m = EYTZ_BATCH;
+
+		//go down complete levels in lockstep
+		for (i = 0; i < m; i++)
+			k[i] = 1;
+		for (level = 0; level < levels; level++)
+			for (i = 0; i < m; i++) {
+				__builtin_prefetch(eytz + 16*k[i]);
+				k[i] = 2*k[i] + (eytz[k[i]] <= temp_array[start+i]);
+				}
+
+		//the last level is incomplete
+		for (i = 0; i < m; i++) {
+			if (k[i] <= esize)
+				k[i] = 2*k[i] + (eytz[k[i]] <= temp_array[start+i]);
+			k[i] >>= __builtin_ffsll(~(long long)k[i]);
+			indices[start+i] = dist->eytz_index[k[i]];
+			}
+		}
+}
+
+#undef EYTZ_BATCH
+
+/*search with 16- or 32-bit offsets of compressed cumulative weights: every block is halved 8
+times, and elements of current block are searched in lockstep, so their cache misses overlap.
+elements after the end of the last block are never chosen.*/
+#define FIND_IN_BLOCKS(offsets) \
+do { \
+	for (half = CUMULS_BLOCK/2; half > 0; half /= 2) \
+		for (i = 0; i < n; i++) { \
+			middle = indices[i] + half - 1; \
+			if ( (middle < dist->wsize) && (offsets[middle] <= values[i]) ) \
+				indices[i] += half; \
+			} \
+} while (0)
+
+/*the same with compressed cumulative weights: find block of every value in Eytzinger layout of
+blocks, then search its element by offsets from the start of block*/
+static void find_indices_blocks(const struct hd_dist *dist, const uint32_t *temp_array,
+	size_t *indices, const size_t n)
+{
+	//values from the start of their blocks
+	uint32_t values[DIST_BLOCK];
+	//middle of search and half of its range
+	size_t middle, half;
+	size_t i;
+
+	find_indices_eytz(dist, temp_array, indices, n);
+	for (i = 0; i < n; i++) {
+		values[i] = temp_array[i];
+		if (indices[i] > 0)
+			values[i] -= dist->blocks[indices[i]-1];
+		indices[i] *= CUMULS_BLOCK;
+		}
+
+	if (dist->offsets16 != NULL)
+		FIND_IN_BLOCKS(dist->offsets16);
+	else
+		FIND_IN_BLOCKS(dist->offsets32);
+}
+
+#undef FIND_IN_BLOCKS
+
+//check intermediate values and search decoded elements by method of distribution
+static int find_indices(const struct hd_dist *dist, const uint32_t *temp_array, size_t *indices,
+	const size_t n)
+{
+	size_t i;
+
+	//values which are not less than total are never encoded
+	for (i = 0; i < n; i++)
+		if (temp_array[i] >= dist->total) {
+			error("can't find corresponding cumuls element");
+			return -1;
+			}
+
+	if (dist->search == SEARCH_COMPARE)
+		rank_uint32_small(dist->keys, temp_array, n, indices);
+	else if (dist->search == SEARCH_TABLE)
+		//this loop is a gather, which is vectorized by compiler where it's supported
+		for (i = 0; i < n; i++)
+			indices[i] = dist->table[temp_array[i]];
+	else if (dist->search == SEARCH_BLOCKS)
+		find_indices_blocks(dist, temp_array, indices, n);
+#ifdef HD_HAVE_INT128
+	else if (dist->search == SEARCH_PIECES)
+		find_indices_pieces(dist, temp_array, indices, n);
+#endif
+	else
+		find_indices_guide(dist, temp_array, indices, n);
+
+	return 0;
+}
+
+#undef LINEAR_SEARCH_MAX
+
+//generic DTE and DTD functions--------------------------------------------------------------------
+
+//check the arguments and type of distribution
+#define CHECK_DIST_ARGS(TYPE) \
+do { \
+	if (in_array == NULL) { \
+		error("in_array = NULL"); \
+		return -1; \
+		} \
+	if (out_array == NULL) { \
+		error("out_array = NULL"); \
+		return -1; \
+		} \
+	if (size == 0) { \
+		error("size = 0"); \
+		return -1; \
+		} \
+	if (dist == NULL) { \
+		error("dist = NULL"); \
+		return -1; \
+		} \
+	if (dist->type != TYPE) { \
+		error("type of distribution differs from type of array"); \
+		return -1; \
+		} \
+} while (0)
+
+//get cumulative weight of element with index, compressed or not
+static uint64_t get_cumul(const struct hd_dist *dist, const size_t index)
+{
+	//block of element and cumulative weight of its start
+	size_t b;
+	uint64_t start;
+
+	if (dist->cumuls != NULL)
+		return dist->cumuls[index];
+#ifdef HD_HAVE_INT128
+	if (dist->knots != NULL)
+		return get_piece_cumul(dist, index + 1);
+#endif
+
+	b = index / CUMULS_BLOCK;
+	start = (b == 0) ? 0 : dist->blocks[b-1];
+	if (dist->offsets16 != NULL)
+		return start + dist->offsets16[index];
+	else
+		return start + dist->offsets32[index];
+}
+
+//write intermediate values of elements [start; start+n-1] to encoded array
+#define PUT_INTERMEDIATE(ctype_t, ctype, otype) \
+do { \
+	ctype_t block_array[DIST_BLOCK]; \
+	\
+	for (i = 0; i < n; i++) \
+		block_array[i] = temp_array[i]; \
+	if (dist->full) \
+		memcpy( (ctype_t *)out_array + start, block_array, n*sizeof(ctype_t) ); \
+	else \
+		encode_##ctype##_uniform_unchecked(block_array, (otype *)out_array + start, n, 0, \
+			dist->total); \
+} while (0)
+
+//check that all elements with indices have nonzero weights
+static int check_indices(const struct hd_dist *dist, const size_t *indices, const size_t n)
+{
+	//cumulative weight of previous element
+	uint64_t cumul_prev;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		cumul_prev = (indices[i] == 0) ? 0 : get_cumul(dist, indices[i] - 1);
+		if (get_cumul(dist, indices[i]) == cumul_prev) {
+			error("value in array is impossible according to cumuls");
+			return -1;
+			}
+		}
+	return 0;
+}
+
+/*encode elements [start; start+n-1] by their indices: intermediate value of element is a random
+value in [cumuls[index-1]; cumuls[index]-1]. indices must be checked by check_indices().*/
+static void encode_indices(const struct hd_dist *dist, const size_t *indices, void *out_array,
+	const size_t start, const size_t n)
+{
+	//intermediate values and random numbers of current block
+	uint32_t temp_array[DIST_BLOCK];
+	uint64_t rand_array[DIST_BLOCK];
+	//cumulative weight of previous element and weight of current one
+	uint64_t cumul_prev, weight;
+	size_t i;
+
+	randombytes( (unsigned char *)rand_array, n*sizeof(uint64_t) );
+	for (i = 0; i < n; i++) {
+		cumul_prev = (indices[i] == 0) ? 0 : get_cumul(dist, indices[i] - 1);
+		weight = get_cumul(dist, indices[i]) - cumul_prev;
+		temp_array[i] = (rand_array[i] % weight) + cumul_prev;
+		}
+
+	if (dist->csize == 1)
+		PUT_INTERMEDIATE(uint8_t, uint8, uint16_t);
+	else if (dist->csize == 2)
+		PUT_INTERMEDIATE(uint16_t, uint16, uint32_t);
+	else {
+		if (dist->full)
+			memcpy( (uint32_t *)out_array + start, temp_array, n*sizeof(uint32_t) );
+		else
+			encode_uint32_uniform_unchecked(temp_array, (uint64_t *)out_array + start, n, 0,
+				dist->total);
+		}
+}
+
+#undef PUT_INTERMEDIATE
+
+#define ENCODE_DIST(itype, ctype, TYPE) \
+(const itype *in_array, void *out_array, const size_t size, const struct hd_dist *dist) \
+{ \
+	CHECK_DIST_ARGS(TYPE); \
+	\
+	if ( (dist->values == NULL) && (dist->cumuls != NULL) ) \
+		return encode_##ctype##_arbitrary_cumuls(in_array, out_array, size, (itype)dist->min, \
+			(itype)dist->max, dist->cumuls); \
+	\
+	/*elements are replaced with their indices: offsets from minimum for dense distribution or \
+	indices of their values for sparse one*/ \
+	size_t indices[DIST_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*bounds of binary search*/ \
+	size_t low, middle, high; \
+	/*description of wrong element of input array*/ \
+	struct hd_error err; \
+	int pass; \
+	size_t i; \
+	\
+	/*check an input array of dense distribution before writing anything to output array*/ \
+	if ( (dist->values == NULL) && check_##ctype##_range(in_array, size, (itype)dist->min, \
+		(itype)dist->max, &err) ) { \
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" ); \
+		return -1; \
+		} \
+	\
+	/*the first pass finds indices of all elements and checks them, so nothing is written to \
+	output array if some element is wrong; the second pass finds them again and encodes*/ \
+	for (pass = 0; pass < 2; pass++) \
+		for (start = 0; start < size; start += n) { \
+			n = size - start; \
+			if (n > DIST_BLOCK) \
+				n = DIST_BLOCK; \
+			\
+			if (dist->values == NULL) \
+				for (i = 0; i < n; i++) \
+					indices[i] = (uint64_t)in_array[start+i] - dist->min; \
+			else \
+				for (i = 0; i < n; i++) { \
+					low = 0; \
+					high = dist->wsize; \
+					while (low < high) { \
+						middle = low + (high - low)/2; \
+						if ((itype)dist->values[middle] < in_array[start+i]) \
+							low = middle + 1; \
+						else \
+							high = middle; \
+						} \
+					if ( (low == dist->wsize) || \
+						((itype)dist->values[low] != in_array[start+i]) ) { \
+						error("value in array isn't a value of distribution"); \
+						return -1; \
+						} \
+					indices[i] = low; \
+					} \
+			\
+			if (pass == 0) { \
+				if (check_indices(dist, indices, n)) \
+					return -1; \
+				} \
+			else \
+				encode_indices(dist, indices, out_array, start, n); \
+			} \
+	\
+	/*container of full distribution is a copy of intermediate array followed by random numbers*/ \
+	if (dist->full) \
+		randombytes( (unsigned char *)out_array + size*dist->csize, size*dist->csize ); \
+	\
+	return dist->osize; \
+}
+
+extern int encode_uint8_arbitrary_dist
+	ENCODE_DIST(uint8_t, uint8, HD_UINT8)
+
+extern int encode_int8_arbitrary_dist
+	ENCODE_DIST(int8_t, int8, HD_INT8)
+
+extern int encode_uint16_arbitrary_dist
+	ENCODE_DIST(uint16_t, uint16, HD_UINT16)
+
+extern int encode_int16_arbitrary_dist
+	ENCODE_DIST(int16_t, int16, HD_INT16)
+
+extern int encode_uint32_arbitrary_dist
+	ENCODE_DIST(uint32_t, uint32, HD_UINT32)
+
+extern int encode_int32_arbitrary_dist
+	ENCODE_DIST(int32_t, int32, HD_INT32)
+
+extern int encode_uint64_arbitrary_dist
+	ENCODE_DIST(uint64_t, uint64, HD_UINT64)
+
+extern int encode_int64_arbitrary_dist
+	ENCODE_DIST(int64_t, int64, HD_INT64)
+
+#undef ENCODE_DIST
+
+//get intermediate values of elements [start; start+n-1] of encoded array
+#define GET_INTERMEDIATE(ctype_t, ctype, otype) \
+do { \
+	ctype_t block_array[DIST_BLOCK]; \
+	\
+	if (dist->full) \
+		memcpy( block_array, (const ctype_t *)in_array + start, n*sizeof(ctype_t) ); \
+	else \
+		decode_##ctype##_uniform_unchecked((const otype *)in_array + start, block_array, n, 0, \
+			dist->total); \
+	for (i = 0; i < n; i++) \
+		temp_array[i] = block_array[i]; \
+} while (0)
+
+static void get_intermediate(const struct hd_dist *dist, const void *in_array,
+	uint32_t *temp_array, const size_t start, const size_t n)
+{
+	size_t i;
+
+	if (dist->csize == 1)
+		GET_INTERMEDIATE(uint8_t, uint8, uint16_t);
+	else if (dist->csize == 2)
+		GET_INTERMEDIATE(uint16_t, uint16, uint32_t);
+	else {
+		//intermediate values of 32 bits are decoded to temp_array directly
+		if (dist->full)
+			memcpy( temp_array, (const uint32_t *)in_array + start, n*sizeof(uint32_t) );
+		else
+			decode_uint32_uniform_unchecked((const uint64_t *)in_array + start, temp_array, n, 0,
+				dist->total);
+		}
+}
+
+#undef GET_INTERMEDIATE
+
+#define DECODE_DIST(itype, TYPE) \
+(const void *in_array, itype *out_array, const size_t size, const struct hd_dist *dist) \
+{ \
+	CHECK_DIST_ARGS(TYPE); \
+	\
+	/*intermediate values and indices of elements of current block*/ \
+	uint32_t temp_array[DIST_BLOCK]; \
+	size_t indices[DIST_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	const itype min = dist->min; \
+	size_t i; \
+	\
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > DIST_BLOCK) \
+			n = DIST_BLOCK; \
+		\
+		get_intermediate(dist, in_array, temp_array, start, n); \
+		if (find_indices(dist, temp_array, indices, n)) \
+			return -1; \
+		if (dist->values == NULL) \
+			for (i = 0; i < n; i++) \
+				out_array[start+i] = indices[i] + min; \
+		else \
+			for (i = 0; i < n; i++) \
+				out_array[start+i] = dist->values[indices[i]]; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_arbitrary_dist
+	DECODE_DIST(uint8_t, HD_UINT8)
+
+extern int decode_int8_arbitrary_dist
+	DECODE_DIST(int8_t, HD_INT8)
+
+extern int decode_uint16_arbitrary_dist
+	DECODE_DIST(uint16_t, HD_UINT16)
+
+extern int decode_int16_arbitrary_dist
+	DECODE_DIST(int16_t, HD_INT16)
+
+extern int decode_uint32_arbitrary_dist
+	DECODE_DIST(uint32_t, HD_UINT32)
+
+extern int decode_int32_arbitrary_dist
+	DECODE_DIST(int32_t, HD_INT32)
+
+extern int decode_uint64_arbitrary_dist
+	DECODE_DIST(uint64_t, HD_UINT64)
+
+extern int decode_int64_arbitrary_dist
+	DECODE_DIST(int64_t, HD_INT64)
+
+#undef DECODE_DIST
+#undef CHECK_DIST_ARGS
+#undef TABLE_MAX
+#undef CUMULS_BLOCK
+#undef DIST_BLOCK
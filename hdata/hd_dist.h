@@ -0,0 +1,275 @@
+/*
+distribution objects for arbitrary distributed integers
+license: BSD 2-Clause
+*/
+
+#ifndef HD_DIST_H
+#define HD_DIST_H
+
+#include "hd_common.h"
+#include "hd_int_uniform.h"
+#include "hd_int_arbitrary.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*distribution object is created once from range and weights and keeps cumulative weights, container
+type and structures for fast search of decoded elements, so DTE and DTD which use it do no work
+which depends on size of the range. encoded arrays are the same as ones of
+encode_itype_arbitrary(). distribution is never changed after creation, so it can be used by
+several threads at the same time.*/
+struct hd_dist;
+
+/*distributions with more elements than this number keep cumulative weights compressed: 64-bit
+ones for blocks of 256 elements and 16- or 32-bit ones from the start of block for elements, so
+they take 2-4 bytes per element instead of 16 and fit in cache better. blocks are searched in
+Eytzinger layout, which prefetches the next levels of tree, and elements by offsets in block.
+smaller distributions use guide table, which is faster while it fits in cache.*/
+#ifndef HD_DIST_GUIDE_MAX
+#define HD_DIST_GUIDE_MAX 16777216
+#endif
+
+//create a distribution of unsigned and signed 8-, 16-, 32- and 64-bit integers in [min; max] with
+//weights (max - min + 1 elements)
+extern struct hd_dist *create_uint8_dist(const uint8_t min, const uint8_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_int8_dist(const int8_t min, const int8_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_uint16_dist(const uint16_t min, const uint16_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_int16_dist(const int16_t min, const int16_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_uint32_dist(const uint32_t min, const uint32_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_int32_dist(const int32_t min, const int32_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_uint64_dist(const uint64_t min, const uint64_t max,
+	const uint32_t *weights);
+extern struct hd_dist *create_int64_dist(const int64_t min, const int64_t max,
+	const uint32_t *weights);
+
+//create a sparse distribution of values (count elements sorted in strictly ascending order) with
+//weights (count elements): memory and time of creation depend on count only, not on the range of
+//values, so it suits a few values spread over a wide range of 32- or 64-bit integers
+extern struct hd_dist *create_uint8_sparse_dist(const uint8_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_int8_sparse_dist(const int8_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_uint16_sparse_dist(const uint16_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_int16_sparse_dist(const int16_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_uint32_sparse_dist(const uint32_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_int32_sparse_dist(const int32_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_uint64_sparse_dist(const uint64_t *values, const uint32_t *weights,
+	const size_t count);
+extern struct hd_dist *create_int64_sparse_dist(const int64_t *values, const uint32_t *weights,
+	const size_t count);
+
+/*parametric distributions: cumulative weights are piecewise linear and computed in integer
+arithmetic by DTE and DTD, so memory and time of creation don't depend on the size of range (but
+[min; max] can't contain all 2^64 values). they are supported only with 128-bit integers.*/
+#ifdef HD_HAVE_INT128
+//piecewise linear histogram: k-th piece is [starts[k]; starts[k+1]-1] (the last one is
+//[starts[count-1]; max]), and its weight is split between its elements as evenly as possible
+extern struct hd_dist *create_uint8_piecewise_dist(const uint8_t *starts, const uint32_t *weights,
+	const size_t count, const uint8_t max);
+extern struct hd_dist *create_int8_piecewise_dist(const int8_t *starts, const uint32_t *weights,
+	const size_t count, const int8_t max);
+extern struct hd_dist *create_uint16_piecewise_dist(const uint16_t *starts,
+	const uint32_t *weights, const size_t count, const uint16_t max);
+extern struct hd_dist *create_int16_piecewise_dist(const int16_t *starts, const uint32_t *weights,
+	const size_t count, const int16_t max);
+extern struct hd_dist *create_uint32_piecewise_dist(const uint32_t *starts,
+	const uint32_t *weights, const size_t count, const uint32_t max);
+extern struct hd_dist *create_int32_piecewise_dist(const int32_t *starts, const uint32_t *weights,
+	const size_t count, const int32_t max);
+extern struct hd_dist *create_uint64_piecewise_dist(const uint64_t *starts,
+	const uint32_t *weights, const size_t count, const uint64_t max);
+extern struct hd_dist *create_int64_piecewise_dist(const int64_t *starts, const uint32_t *weights,
+	const size_t count, const int64_t max);
+
+/*normal (truncated to [min; max] and rounded to integers), geometric (probability of min + k is
+proportional to (1 - p)^k, 0 < p < 1) and Zipf (probability of min + k is proportional to
+1/(k + 1)^s, s > 0) distributions. total weight of their elements is about 2^32, every element
+gets weight 1 if the range has less than 2^32 elements, and the rest is split by probabilities.
+probabilities are computed in floating-point arithmetic at creation of distribution only, so the
+same distribution must be created with the same math library for encoding and decoding.*/
+extern struct hd_dist *create_uint8_normal_dist(const uint8_t min, const uint8_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_int8_normal_dist(const int8_t min, const int8_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_uint16_normal_dist(const uint16_t min, const uint16_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_int16_normal_dist(const int16_t min, const int16_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_uint32_normal_dist(const uint32_t min, const uint32_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_int32_normal_dist(const int32_t min, const int32_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_uint64_normal_dist(const uint64_t min, const uint64_t max,
+	const double mean, const double sd);
+extern struct hd_dist *create_int64_normal_dist(const int64_t min, const int64_t max,
+	const double mean, const double sd);
+
+extern struct hd_dist *create_uint8_geometric_dist(const uint8_t min, const uint8_t max,
+	const double p);
+extern struct hd_dist *create_int8_geometric_dist(const int8_t min, const int8_t max,
+	const double p);
+extern struct hd_dist *create_uint16_geometric_dist(const uint16_t min, const uint16_t max,
+	const double p);
+extern struct hd_dist *create_int16_geometric_dist(const int16_t min, const int16_t max,
+	const double p);
+extern struct hd_dist *create_uint32_geometric_dist(const uint32_t min, const uint32_t max,
+	const double p);
+extern struct hd_dist *create_int32_geometric_dist(const int32_t min, const int32_t max,
+	const double p);
+extern struct hd_dist *create_uint64_geometric_dist(const uint64_t min, const uint64_t max,
+	const double p);
+extern struct hd_dist *create_int64_geometric_dist(const int64_t min, const int64_t max,
+	const double p);
+
+extern struct hd_dist *create_uint8_zipf_dist(const uint8_t min, const uint8_t max,
+	const double s);
+extern struct hd_dist *create_int8_zipf_dist(const int8_t min, const int8_t max, const double s);
+extern struct hd_dist *create_uint16_zipf_dist(const uint16_t min, const uint16_t max,
+	const double s);
+extern struct hd_dist *create_int16_zipf_dist(const int16_t min, const int16_t max,
+	const double s);
+extern struct hd_dist *create_uint32_zipf_dist(const uint32_t min, const uint32_t max,
+	const double s);
+extern struct hd_dist *create_int32_zipf_dist(const int32_t min, const int32_t max,
+	const double s);
+extern struct hd_dist *create_uint64_zipf_dist(const uint64_t min, const uint64_t max,
+	const double s);
+extern struct hd_dist *create_int64_zipf_dist(const int64_t min, const int64_t max,
+	const double s);
+#endif
+
+//free a distribution
+extern void free_dist(struct hd_dist *dist);
+
+//get size of container element in bytes or -1 on error
+extern int dist_container_size(const struct hd_dist *dist);
+
+//learning of distributions from sample arrays. there are no threads in library, but arrays or
+//their parts can be counted separately (e.g. by several threads to their own counts), then
+//counts are merged by merge_counts() and quantized.
+
+//add the number of elements of array with every value in [min; max] to counts (max - min + 1
+//elements)
+extern int count_uint8_values(const uint8_t *array, const size_t size, const uint8_t min,
+	const uint8_t max, uint64_t *counts);
+extern int count_int8_values(const int8_t *array, const size_t size, const int8_t min,
+	const int8_t max, uint64_t *counts);
+extern int count_uint16_values(const uint16_t *array, const size_t size, const uint16_t min,
+	const uint16_t max, uint64_t *counts);
+extern int count_int16_values(const int16_t *array, const size_t size, const int16_t min,
+	const int16_t max, uint64_t *counts);
+extern int count_uint32_values(const uint32_t *array, const size_t size, const uint32_t min,
+	const uint32_t max, uint64_t *counts);
+extern int count_int32_values(const int32_t *array, const size_t size, const int32_t min,
+	const int32_t max, uint64_t *counts);
+extern int count_uint64_values(const uint64_t *array, const size_t size, const uint64_t min,
+	const uint64_t max, uint64_t *counts);
+extern int count_int64_values(const int64_t *array, const size_t size, const int64_t min,
+	const int64_t max, uint64_t *counts);
+
+//add other_counts to counts (wsize elements both), e.g. counts of different threads to the same
+//range. returns -1 if some sum doesn't fit in 64 bits, then counts aren't changed.
+extern int merge_counts(uint64_t *counts, const uint64_t *other_counts, const size_t wsize);
+
+//convert counts of values (wsize elements) to weights whose sum is less than 2^32: big counts are
+//scaled, but every counted value stays possible. smoothing is added to every weight, so every
+//value in the range is possible if it's not 0.
+extern int quantize_counts(const uint64_t *counts, const size_t wsize, const uint32_t smoothing,
+	uint32_t *weights);
+
+//create a distribution from count sample arrays with sizes: a distribution of values in
+//[min; max] or a sparse distribution of values which are in arrays
+extern struct hd_dist *learn_uint8_dist(const uint8_t *const *arrays, const size_t *sizes,
+	const size_t count, const uint8_t min, const uint8_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_int8_dist(const int8_t *const *arrays, const size_t *sizes,
+	const size_t count, const int8_t min, const int8_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_uint16_dist(const uint16_t *const *arrays, const size_t *sizes,
+	const size_t count, const uint16_t min, const uint16_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_int16_dist(const int16_t *const *arrays, const size_t *sizes,
+	const size_t count, const int16_t min, const int16_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_uint32_dist(const uint32_t *const *arrays, const size_t *sizes,
+	const size_t count, const uint32_t min, const uint32_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_int32_dist(const int32_t *const *arrays, const size_t *sizes,
+	const size_t count, const int32_t min, const int32_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_uint64_dist(const uint64_t *const *arrays, const size_t *sizes,
+	const size_t count, const uint64_t min, const uint64_t max, const uint32_t smoothing);
+extern struct hd_dist *learn_int64_dist(const int64_t *const *arrays, const size_t *sizes,
+	const size_t count, const int64_t min, const int64_t max, const uint32_t smoothing);
+
+extern struct hd_dist *learn_uint8_sparse_dist(const uint8_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_int8_sparse_dist(const int8_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_uint16_sparse_dist(const uint16_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_int16_sparse_dist(const int16_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_uint32_sparse_dist(const uint32_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_int32_sparse_dist(const int32_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_uint64_sparse_dist(const uint64_t *const *arrays, const size_t *sizes,
+	const size_t count);
+extern struct hd_dist *learn_int64_sparse_dist(const int64_t *const *arrays, const size_t *sizes,
+	const size_t count);
+
+//DTE and DTD with distribution object: out_array of encode function must have space for size
+//elements of container type. DTE returns size of container element in bytes or -1 on error,
+//type of elements must be the type of distribution. arrays of sparse distribution are encoded
+//like ones of indices of their values in [0; count-1]. on error nothing is written to out_array.
+extern int encode_uint8_arbitrary_dist(const uint8_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_uint8_arbitrary_dist(const void *in_array, uint8_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_int8_arbitrary_dist(const int8_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_int8_arbitrary_dist(const void *in_array, int8_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_uint16_arbitrary_dist(const uint16_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_uint16_arbitrary_dist(const void *in_array, uint16_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_int16_arbitrary_dist(const int16_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_int16_arbitrary_dist(const void *in_array, int16_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_uint32_arbitrary_dist(const uint32_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_uint32_arbitrary_dist(const void *in_array, uint32_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_int32_arbitrary_dist(const int32_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_int32_arbitrary_dist(const void *in_array, int32_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_uint64_arbitrary_dist(const uint64_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_uint64_arbitrary_dist(const void *in_array, uint64_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+extern int encode_int64_arbitrary_dist(const int64_t *in_array, void *out_array,
+	const size_t size, const struct hd_dist *dist);
+extern int decode_int64_arbitrary_dist(const void *in_array, int64_t *out_array,
+	const size_t size, const struct hd_dist *dist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,6 +9,10 @@ license: BSD 2-Clause
 #include "hd_common.h"
 #include "hd_int_arbitrary.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //functions for float type arrays
 /*convert fp number to integer and back such way that if (fp1 < fp2) then (int1 < int2), if
 (fp1 = fp2) then (int1 = int2), if (fp1 > fp2) then (int1 > int2), i.e. each integer value will
@@ -23,4 +27,8 @@ extern int uint64_to_double_uniform(const uint64_t *in_array, double *out_array,
 //check what container can be used for such array
 extern int container_float_uniform(const float min, const float max);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -5,136 +5,406 @@ license: BSD 2-Clause
 
 #include "hd_int_arbitrary.h"
 
-//first check if we can handle such array, then convert weights to cumulative weights
-/*optimization note: cumulative weights can be saved after computation in encoding stage and
-just loaded (rather then re-computed) in decoding stage*/
-#define CHECK_ARRAYS_GET_CUMULS() \
+//parameters in following generic functions:
+//itype - type of input elements
+//itype_name - name of itype in function names (e.g. uint8 for uint8_t)
+//ctype_t - type of intermediate elements, ctype - its name in function names
+//otype - type of container elements
+
+/*number of elements processed at once by functions which work with caller's memory only:
+intermediate and random values of a block are kept on stack*/
+#define ARBITRARY_BLOCK 1024
+
+//cumulative weights-------------------------------------------------------------------------------
+
+extern int get_cumuls(const uint32_t *weights, uint64_t *cumuls, const size_t wsize)
+{
+	/*check the arguments*/
+	if ( (weights == NULL) || (cumuls == NULL) || (wsize == 0) ) {
+		error("wrong arguments");
+		return -1;
+		}
+
+	/*current and previous cumulative weights*/
+	uint64_t current, prev;
+	size_t i;
+
+	/*convert weights to cumulative weights: cumuls[i] = sum of weights[j], where j = 0..i*/
+	current = 0;
+	for (i = 0; i < wsize; i++) {
+		prev = current;
+		current += weights[i];
+		if (current < prev) {
+			error("integer overflow during cumuls computation");
+			return -1;
+			}
+		cumuls[i] = current;
+		}
+
+	return 0;
+}
+
+//get size of container element in bytes by maximum cumulative weight
+static int container_by_total(const uint64_t total)
+{
+	if (total < 256)				//2^8
+		return sizeof(uint16_t);
+	else if (total < 65536)			//2^16
+		return sizeof(uint32_t);
+	else if (total < 4294967296)	//2^32
+		return sizeof(uint64_t);
+#ifdef HD_HAVE_INT128
+	//64-bit intermediate values are encoded in 128-bit containers by native 128-bit arithmetic
+	else
+		return sizeof(hd_uint128_t);
+#else
+	else {
+		error("too many values for any supported output type");
+		return -1;
+		}
+#endif
+}
+
+//get offset of the next element in container by maximum cumulative weight: if every intermediate
+//value is possible, then container is their copy followed by random numbers, so it's size of
+//intermediate element, else size of container element
+static int stride_by_total(const uint64_t total)
+{
+	const int osize = container_by_total(total);
+
+	if (osize < 0)
+		return -1;
+	if ( total == (UINT64_MAX >> (64 - 4*osize)) )
+		return osize/2;
+	return osize;
+}
+
+/*get size of weights and cumuls arrays. make a check for an overflow: it occurs if user wants to
+use too big weights and cumuls arrays (i.e., size_t type can't hold their size). to catch this
+situation, we make computations in biggest type available, then convert it to size_t. however,
+overflow can occur even in biggest type, so we should catch for this situation too.*/
+#define GET_WSIZE() \
 do { \
-	/*get size of weights and cumuls arrays*/ \
-	wsize_check = max - min + 1; \
+	wsize_check = (uint64_t)max - (uint64_t)min + 1; \
 	wsize = wsize_check; \
-	\
-	/*make a check for an overflow. it occurs if user wants to use too big weights and cumuls \
-	arrays (i.e., size_t type can't hold their size). to catch this situation, we make \
-	computations in biggest type available, then convert it to size_t. however, overflow can \
-	occur even in biggest type, so we should catch for this situation too.*/ \
-	/*optimization note: we can skip such check(s) if overflow(s) in question aren't possible, \
-	for example when we're handling (u)int8_t arrays*/ \
-	if ( (wsize != wsize_check) || ((max == UINT64_MAX) && (min == 0)) ) { \
+	if ( (wsize != wsize_check) || (wsize_check == 0) ) { \
 		error("can't handle such big supplementary arrays"); \
 		return -1; \
-	} \
-	\
-	if ( (cumuls = malloc(wsize*sizeof(uint64_t))) == NULL ) { \
-		error("couldn't allocate memory for cumuls"); \
+		} \
+} while (0)
+
+//generic function for getting container size------------------------------------------------------
+
+#define CONTAINER_ARBITRARY(itype) \
+(const itype min, const itype max, const uint32_t *weights) \
+{ \
+	/*check the arguments*/ \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	if (weights == NULL) { \
+		error("weights = NULL"); \
 		return -1; \
 		} \
 	\
-	/*convert weights to cumulative weights: cumuls[i] = sum of weights[j], where j = 0..i*/ \
+	/*current and previous cumulative weights*/ \
+	uint64_t current, prev; \
+	size_t i, wsize; \
+	uint64_t wsize_check; \
+	\
+	GET_WSIZE(); \
+	\
 	current = 0; \
 	for (i = 0; i < wsize; i++) { \
 		prev = current; \
 		current += weights[i]; \
 		if (current < prev) { \
 			error("integer overflow during cumuls computation"); \
-			free(cumuls); \
 			return -1; \
 			} \
-		cumuls[i] = current; \
 		} \
-} while(0)
+	\
+	return container_by_total(current); \
+}
 
-#define ENCODE_IN_TYPE_ARBITRARY(ctype_t, ctype, otype) \
+extern int container_uint8_arbitrary
+	CONTAINER_ARBITRARY(uint8_t)
+
+extern int container_int8_arbitrary
+	CONTAINER_ARBITRARY(int8_t)
+
+extern int container_uint16_arbitrary
+	CONTAINER_ARBITRARY(uint16_t)
+
+extern int container_int16_arbitrary
+	CONTAINER_ARBITRARY(int16_t)
+
+extern int container_uint32_arbitrary
+	CONTAINER_ARBITRARY(uint32_t)
+
+extern int container_int32_arbitrary
+	CONTAINER_ARBITRARY(int32_t)
+
+extern int container_uint64_arbitrary
+	CONTAINER_ARBITRARY(uint64_t)
+
+extern int container_int64_arbitrary
+	CONTAINER_ARBITRARY(int64_t)
+
+#undef CONTAINER_ARBITRARY
+
+//generic DTE function which uses caller's memory only---------------------------------------------
+
+/*intermediate values are encoded uniformly in [0; total] right in the loop which chooses them,
+like ENCODE_IN_INT_UNIFORM_KERNEL() in hd_int_uniform.c does, so decode_ctype_uniform() extracts
+them. every element takes two random numbers from one buffer: the first selects intermediate value
+and the second selects group. rtype - type of the first one: 64 bits are enough for weights, which
+are less than 2^32. STORE(p, x) - macro which writes encoded element x to container at p.*/
+#define ENCODE_IN_TYPE_ARBITRARY(ctype_t, otype, rtype, STORE) \
 do { \
-	/*index and weight of current element*/ \
-	size_t index; \
+	/*weight of current element (its index is declared by caller)*/ \
 	uint32_t weight; \
 	/*cumulative weight of previous element*/ \
 	uint64_t cumul_prev; \
-	/*arrays for temporary and random data (actually this is the same array in memory)*/ \
-	ctype_t *temp_array; \
-	otype *rand_array; \
-	/*return value*/ \
-	int rv; \
+	/*current intermediate value, then encoded element*/ \
+	otype oelt; \
+	/*random numbers of current block, two per element*/ \
+	otype rand_array[2*ARBITRARY_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*every intermediate value is possible, so container consists of their copy followed by \
+	random numbers, like for encode_ctype_uniform()*/ \
+	const bool full = (total == (ctype_t)-1); \
+	/*size of group, number of elements in the last group or 0 if it is full, and number of \
+	groups, see ENCODE_IN_INT_UNIFORM_KERNEL() for formulas*/ \
+	const otype group_size = (otype)total + 1; \
+	const otype last_group_size = ( (otype)-1 % group_size + 1 ) % group_size; \
+	const otype group_num = (otype)-1 / group_size + 1; \
 	\
-	if ( (temp_array = malloc(size*sizeof(otype))) == NULL ) { \
-		error("couldn't allocate memory for temp_array"); \
-		free(cumuls); \
-		return -1; \
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > ARBITRARY_BLOCK) \
+			n = ARBITRARY_BLOCK; \
+		\
+		randombytes( (unsigned char *)rand_array, 2*n*sizeof(otype) ); \
+		/*input array was checked by check_itype_range() already*/ \
+		for (i = 0; i < n; i++) { \
+			index = in_array[start+i] - min; \
+			\
+			if (index == 0) \
+				cumul_prev = 0; \
+			else \
+				cumul_prev = cumuls[index-1]; \
+			/*weight is the difference between two consecutive cumulative weights, it isn't 0 \
+			(impossible values were rejected before writing anything)*/ \
+			weight = cumuls[index] - cumul_prev; \
+			\
+			/*each intermediate value is pseudorandom value in [cumul_prev; cumuls[index]-1]*/ \
+			oelt = ((rtype)rand_array[2*i] % weight) + cumul_prev; \
+			\
+			if (full) { \
+				((ctype_t *)out_array)[start+i] = oelt; \
+				continue; \
+				} \
+			\
+			/*if the last group is full, then group_size divides 2^(8*sizeof(otype)) and group \
+			selection is just a multiplication; 1u prevents signed overflow after promotion of \
+			16-bit numbers. else place element in any group, excluding the last one if it \
+			doesn't fit there.*/ \
+			if (last_group_size == 0) \
+				oelt += 1u*rand_array[2*i+1] * group_size; \
+			else \
+				oelt += ( rand_array[2*i+1] % (group_num - (oelt >= last_group_size)) ) * \
+					group_size; \
+			STORE( (otype *)out_array + start + i, oelt ); \
+			} \
 		} \
-	randombytes( (unsigned char *)temp_array, size*sizeof(otype) ); \
-	rand_array = (otype *)temp_array; \
 	\
-	if ( (*out_array = malloc(size*sizeof(otype))) == NULL ) { \
-		error("couldn't allocate memory for out_array"); \
-		free(cumuls); \
-		free(temp_array); \
+	if (full) \
+		randombytes( (unsigned char *)out_array + size*sizeof(ctype_t), size*sizeof(ctype_t) ); \
+	\
+	return sizeof(otype); \
+} while (0)
+
+//elements of 2, 4 and 8-byte containers are stored in machine byte order
+#define STORE_NATIVE(p, x) memcpy( (p), &(x), sizeof(x) )
+
+#ifdef HD_HAVE_INT128
+//16-byte containers are little endian on every machine (see hd_int_uniform.c), so their elements
+//are stored by bytes; compilers merge these stores into one on little endian machines
+static void store_uint128_le(unsigned char *p, const hd_uint128_t x)
+{
+	int i;
+
+	for (i = 0; i < 16; i++)
+		p[i] = (unsigned char)(x >> 8*i);
+}
+
+#define STORE_UINT128_LE(p, x) store_uint128_le( (unsigned char *)(p), (x) )
+
+#define ENCODE_IN_UINT128_ARBITRARY() \
+		case sizeof(hd_uint128_t): \
+			ENCODE_IN_TYPE_ARBITRARY(uint64_t, hd_uint128_t, uint64_t, STORE_UINT128_LE)
+#else
+#define ENCODE_IN_UINT128_ARBITRARY()
+#endif
+
+#define ENCODE_ARBITRARY_CUMULS(itype, itype_name) \
+(const itype *in_array, void *out_array, const size_t size, \
+const itype min, const itype max, const uint64_t *cumuls) \
+{ \
+	/*check the arguments*/ \
+	if (in_array == NULL) { \
+		error("in_array = NULL"); \
+		return -1; \
+		} \
+	if (out_array == NULL) { \
+		error("out_array = NULL"); \
+		return -1; \
+		} \
+	if (size == 0) { \
+		error("size = 0"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	if (cumuls == NULL) { \
+		error("cumuls = NULL"); \
 		return -1; \
 		} \
 	\
+	/*maximum cumulative weight*/ \
+	uint64_t total; \
+	size_t i, wsize; \
+	uint64_t wsize_check; \
+	/*description of wrong element of input array*/ \
+	struct hd_error err; \
+	/*index of current element among weights*/ \
+	size_t index; \
+	\
+	GET_WSIZE(); \
+	total = cumuls[wsize-1]; \
+	\
+	/*check an input array before writing anything to output array*/ \
+	if (check_##itype_name##_range(in_array, size, min, max, &err)) { \
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" ); \
+		return -1; \
+		} \
+	/*values with zero weight are impossible according to cumuls, so they can't be encoded*/ \
 	for (i = 0; i < size; i++) { \
-		if (in_array[i] < min) { \
-			error("wrong min value"); \
-			free(cumuls); \
-			free(temp_array); \
-			free(*out_array); \
-			*out_array = NULL; \
+		index = in_array[i] - min; \
+		if (cumuls[index] == ( (index == 0) ? 0 : cumuls[index-1] )) { \
+			error("value in array is impossible according to cumuls"); \
 			return -1; \
 			} \
-		else if (in_array[i] > max) { \
-			error("wrong max value"); \
-			free(cumuls); \
-			free(temp_array); \
-			free(*out_array); \
-			*out_array = NULL; \
+		} \
+	\
+	/*check maximum value after encoding (i.e., maximum cumulative weight value)*/ \
+	switch (container_by_total(total)) { \
+		case sizeof(uint16_t): \
+			ENCODE_IN_TYPE_ARBITRARY(uint8_t, uint16_t, uint16_t, STORE_NATIVE); \
+		case sizeof(uint32_t): \
+			ENCODE_IN_TYPE_ARBITRARY(uint16_t, uint32_t, uint32_t, STORE_NATIVE); \
+		case sizeof(uint64_t): \
+			ENCODE_IN_TYPE_ARBITRARY(uint32_t, uint64_t, uint64_t, STORE_NATIVE); \
+		ENCODE_IN_UINT128_ARBITRARY(); \
+		default: \
 			return -1; \
-			} \
-		index = in_array[i] - min; \
+		} \
+}
+
+extern int encode_uint8_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(uint8_t, uint8)
+
+extern int encode_int8_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(int8_t, int8)
+
+extern int encode_uint16_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(uint16_t, uint16)
+
+extern int encode_int16_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(int16_t, int16)
+
+extern int encode_uint32_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(uint32_t, uint32)
+
+extern int encode_int32_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(int32_t, int32)
+
+extern int encode_uint64_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(uint64_t, uint64)
+
+extern int encode_int64_arbitrary_cumuls
+	ENCODE_ARBITRARY_CUMULS(int64_t, int64)
+
+#undef ENCODE_ARBITRARY_CUMULS
+#undef ENCODE_IN_UINT128_ARBITRARY
+#undef STORE_UINT128_LE
+#undef STORE_NATIVE
+#undef ENCODE_IN_TYPE_ARBITRARY
+
+//generic DTD function which uses caller's memory only---------------------------------------------
+
+#define DECODE_IN_TYPE_ARBITRARY(ctype_t, ctype, otype) \
+do { \
+	/*index of current element and bounds of binary search*/ \
+	size_t index, middle, high; \
+	/*intermediate values of current block*/ \
+	ctype_t temp_array[ARBITRARY_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	\
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > ARBITRARY_BLOCK) \
+			n = ARBITRARY_BLOCK; \
 		\
-		if (index == 0) \
-			cumul_prev = 0; \
+		/*firstly decode uniformly distributed temporary values*/ \
+		if (total == (ctype_t)-1) \
+			memcpy( temp_array, (const ctype_t *)in_array + start, n*sizeof(ctype_t) ); \
 		else \
-			cumul_prev = cumuls[index-1]; \
-		/*weight is the difference between two consecutive cumulative weights*/ \
-		weight = cumuls[index] - cumul_prev; \
+			decode_##ctype##_uniform_unchecked((const void *)((const otype *)in_array + start), \
+				temp_array, n, 0, total); \
 		\
-		/*check if current value is impossible according to cumuls*/ \
-		if (weight == 0) { \
-			error("value in array is impossible according to cumuls"); \
-			free(cumuls); \
-			free(temp_array); \
-			free(*out_array); \
-			*out_array = NULL; \
-			return -1; \
+		for (i = 0; i < n; i++) { \
+			/*find the first cumulative weight which is bigger than intermediate value by binary \
+			search. distribution objects (see hd_dist.h) use guide table, which is faster.*/ \
+			index = 0; \
+			high = wsize; \
+			while (index < high) { \
+				middle = index + (high - index)/2; \
+				if (temp_array[i] < cumuls[middle]) \
+					high = middle; \
+				else \
+					index = middle + 1; \
+				} \
+			\
+			if (index == wsize) { \
+				error("can't find corresponding cumuls element"); \
+				return -1; \
+				} \
+			\
+			out_array[start+i] = index + min; \
 			} \
-		\
-		/*each temp value is pseudorandom value in [cumul_prev; cumuls[index]-1]*/ \
-		/*we're very neat here: first we read rand_array member, which is two times bigger then \
-		temp_array member, then we write temp_array member, possibly overwriting rand_array \
-		member, which we don't need anymore*/ \
-		temp_array[i] = (rand_array[i] % weight) + cumul_prev; \
 		} \
 	\
-	/*finally encode uniformly distributed temporary values*/ \
-	rv = encode_##ctype##_uniform(temp_array, (otype *)*out_array, size, 0, cumuls[wsize-1]); \
-	\
-	free(cumuls); \
-	free(temp_array); \
-	\
-	/*if error happened, then return -1, else return size of output type in bytes*/ \
-	if (rv) { \
-		free(*out_array); \
-		*out_array = NULL; \
-		return -1; \
-		} \
-	else { \
-		return sizeof(otype); \
-		} \
-} while(0)
+	return 0; \
+} while (0)
 
-#define ENCODE_ARBITRARY(itype) \
-(const itype *in_array, void **out_array, const size_t size, \
-const itype min, const itype max, const uint32_t *weights) \
+#ifdef HD_HAVE_INT128
+#define DECODE_IN_UINT128_ARBITRARY() \
+		case sizeof(hd_uint128_t): \
+			DECODE_IN_TYPE_ARBITRARY(uint64_t, uint64, hd_uint128_t)
+#else
+#define DECODE_IN_UINT128_ARBITRARY()
+#endif
+
+#define DECODE_ARBITRARY_CUMULS(itype) \
+(const void *in_array, itype *out_array, const size_t size, const itype min, \
+const itype max, const uint64_t *cumuls) \
 { \
 	/*check the arguments*/ \
 	if (in_array == NULL) { \
@@ -153,134 +423,316 @@ const itype min, const itype max, const uint32_t *weights) \
 		error("min > max"); \
 		return -1; \
 		} \
-	if (weights == NULL) { \
-		error("weights = NULL"); \
+	if (cumuls == NULL) { \
+		error("cumuls = NULL"); \
 		return -1; \
 		} \
 	\
-	/*current and previous weights*/ \
-	uint64_t current, prev; \
-	/*cumulative weights*/ \
-	uint64_t *cumuls; \
+	/*maximum cumulative weight*/ \
+	uint64_t total; \
 	size_t i, wsize; \
 	uint64_t wsize_check; \
 	\
-	CHECK_ARRAYS_GET_CUMULS(); \
+	GET_WSIZE(); \
+	total = cumuls[wsize-1]; \
 	\
 	/*check maximum value after encoding (i.e., maximum cumulative weight value)*/ \
-	if (current < 256)				/*2^8*/ \
-		ENCODE_IN_TYPE_ARBITRARY(uint8_t, uint8, uint16_t); \
-	else if (current < 65536)		/*2^16*/ \
-		ENCODE_IN_TYPE_ARBITRARY(uint16_t, uint16, uint32_t); \
-	else if (current < 4294967296)	/*2^32*/ \
-		ENCODE_IN_TYPE_ARBITRARY(uint32_t, uint32, uint64_t); \
-	else { \
-		error("too many values for any supported output type"); \
-		free(cumuls); \
-		return -1; \
+	switch (container_by_total(total)) { \
+		case sizeof(uint16_t): \
+			DECODE_IN_TYPE_ARBITRARY(uint8_t, uint8, uint16_t); \
+		case sizeof(uint32_t): \
+			DECODE_IN_TYPE_ARBITRARY(uint16_t, uint16, uint32_t); \
+		case sizeof(uint64_t): \
+			DECODE_IN_TYPE_ARBITRARY(uint32_t, uint32, uint64_t); \
+		DECODE_IN_UINT128_ARBITRARY(); \
+		default: \
+			return -1; \
 		} \
 }
 
-extern int encode_uint8_arbitrary
-	ENCODE_ARBITRARY(uint8_t)
+extern int decode_uint8_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(uint8_t)
 
-extern int encode_int8_arbitrary
-	ENCODE_ARBITRARY(int8_t)
+extern int decode_int8_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(int8_t)
 
-extern int encode_uint16_arbitrary
-	ENCODE_ARBITRARY(uint16_t)
+extern int decode_uint16_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(uint16_t)
 
-extern int encode_int16_arbitrary
-	ENCODE_ARBITRARY(int16_t)
+extern int decode_int16_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(int16_t)
 
-extern int encode_uint32_arbitrary
-	ENCODE_ARBITRARY(uint32_t)
+extern int decode_uint32_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(uint32_t)
 
-extern int encode_int32_arbitrary
-	ENCODE_ARBITRARY(int32_t)
+extern int decode_int32_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(int32_t)
 
-extern int encode_uint64_arbitrary
-	ENCODE_ARBITRARY(uint64_t)
+extern int decode_uint64_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(uint64_t)
 
-extern int encode_int64_arbitrary
-	ENCODE_ARBITRARY(int64_t)
+extern int decode_int64_arbitrary_cumuls
+	DECODE_ARBITRARY_CUMULS(int64_t)
 
-#undef ENCODE_ARBITRARY
-#undef ENCODE_IN_TYPE_ARBITRARY
+#undef DECODE_ARBITRARY_CUMULS
+#undef DECODE_IN_UINT128_ARBITRARY
+#undef DECODE_IN_TYPE_ARBITRARY
 
-#define DECODE_IN_TYPE_ARBITRARY(ctype_t, ctype) \
-do { \
-	/*index and weight of current element*/ \
-	size_t index; \
-	/*uint32_t weight;*/ \
-	/*temporary array*/ \
-	ctype_t *temp_array; \
-	/*return value*/ \
-	int rv; \
+//generic DTD function with aggregation of decoded elements----------------------------------------
+
+#define DECODE_ARBITRARY_AGGREGATE(itype, itype_name) \
+(const void *in_array, const size_t size, const itype min, const itype max, \
+const uint64_t *cumuls, struct hd_##itype_name##_aggregate *agg) \
+{ \
+	/*decoded elements of current block*/ \
+	itype block_array[ARBITRARY_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*offset of the next element in container, see stride_by_total()*/ \
+	int stride; \
+	size_t wsize; \
+	uint64_t wsize_check; \
 	\
-	if ( (temp_array = malloc(size*sizeof(ctype_t))) == NULL ) { \
-		error("couldn't allocate memory for temp_array"); \
-		free(cumuls); \
+	/*check the arguments*/ \
+	if ( (in_array == NULL) || (size == 0) || (min > max) || (cumuls == NULL) || (agg == NULL) ) { \
+		error("wrong arguments"); \
 		return -1; \
 		} \
 	\
-	/*firstly decode uniformly distributed temporary values*/ \
-	/*optimization note: here we can use out_array instead of temp_array*/ \
-	rv = decode_##ctype##_uniform(in_array, temp_array, size, 0, cumuls[wsize-1]); \
-	if (rv < 0) { \
-		free(cumuls); \
-		free(temp_array); \
-		return rv; \
-		} \
+	GET_WSIZE(); \
+	if ( (stride = stride_by_total(cumuls[wsize-1])) < 0 ) \
+		return -1; \
 	\
-	for (i = 0; i < size; i++) { \
-		/*optimization note: binary search or some other clever algorithm would be much faster*/ \
-		for (index = 0; index < (max - min + 1); index++) { \
-			/*in this simple algorithm, (weight > 0) condition always holds, but generally we \
-			should check this*/ \
-			/*if (index == 0) \
-				weight = cumuls[index]; \
-			else \
-				weight = cumuls[index] - cumuls[index-1];*/ \
-			if ((temp_array[i] < cumuls[index]) /*&& (weight > 0)*/) \
-				break; \
-			} \
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > ARBITRARY_BLOCK) \
+			n = ARBITRARY_BLOCK; \
 		\
-		if (index == (max - min + 1)) { \
-			error("can't find corresponding cumuls element"); \
-			free(cumuls); \
-			free(temp_array); \
+		if (decode_##itype_name##_arbitrary_cumuls( \
+			(const unsigned char *)in_array + start*stride, block_array, n, min, max, cumuls) ) \
 			return -1; \
-			} \
-		\
-		out_array[i] = index + min; \
+		aggregate_##itype_name##_array(block_array, n, agg); \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(uint8_t, uint8)
+
+extern int decode_int8_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(int8_t, int8)
+
+extern int decode_uint16_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(uint16_t, uint16)
+
+extern int decode_int16_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(int16_t, int16)
+
+extern int decode_uint32_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(uint32_t, uint32)
+
+extern int decode_int32_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(int32_t, int32)
+
+extern int decode_uint64_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(uint64_t, uint64)
+
+extern int decode_int64_arbitrary_aggregate
+	DECODE_ARBITRARY_AGGREGATE(int64_t, int64)
+
+#undef DECODE_ARBITRARY_AGGREGATE
+
+//generic DTD function with selection of decoded elements------------------------------------------
+
+#define DECODE_ARBITRARY_SELECT(itype, itype_name) \
+(const void *in_array, const size_t size, const itype min, const itype max, \
+const uint64_t *cumuls, const itype lo, const itype hi, size_t *selection, itype *values, \
+size_t *count) \
+{ \
+	/*decoded elements of current block*/ \
+	itype block_array[ARBITRARY_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*number of elements selected in current block*/ \
+	size_t selected; \
+	size_t i; \
+	/*offset of the next element in container, see stride_by_total()*/ \
+	int stride; \
+	size_t wsize; \
+	uint64_t wsize_check; \
+	\
+	/*check the arguments*/ \
+	if ( (in_array == NULL) || (size == 0) || (min > max) || (cumuls == NULL) || \
+		(selection == NULL) || (count == NULL) ) { \
+		error("wrong arguments"); \
+		return -1; \
+		} \
+	\
+	GET_WSIZE(); \
+	if ( (stride = stride_by_total(cumuls[wsize-1])) < 0 ) \
+		return -1; \
+	\
+	*count = 0; \
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > ARBITRARY_BLOCK) \
+			n = ARBITRARY_BLOCK; \
 		\
-		/*if algorithm works right, this errors should never be thrown*/ \
-		if (out_array[i] < min) { \
-			error("algorithm error: wrong value < min"); \
-			free(cumuls); \
-			free(temp_array); \
+		if (decode_##itype_name##_arbitrary_cumuls( \
+			(const unsigned char *)in_array + start*stride, block_array, n, min, max, cumuls) ) \
 			return -1; \
+		select_##itype_name##_range(block_array, n, lo, hi, selection + *count, \
+			(values == NULL) ? NULL : values + *count, &selected); \
+		/*kernel returns indices in block, make them indices in whole array*/ \
+		for (i = *count; i < *count + selected; i++) \
+			selection[i] += start; \
+		*count += selected; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_arbitrary_select
+	DECODE_ARBITRARY_SELECT(uint8_t, uint8)
+
+extern int decode_int8_arbitrary_select
+	DECODE_ARBITRARY_SELECT(int8_t, int8)
+
+extern int decode_uint16_arbitrary_select
+	DECODE_ARBITRARY_SELECT(uint16_t, uint16)
+
+extern int decode_int16_arbitrary_select
+	DECODE_ARBITRARY_SELECT(int16_t, int16)
+
+extern int decode_uint32_arbitrary_select
+	DECODE_ARBITRARY_SELECT(uint32_t, uint32)
+
+extern int decode_int32_arbitrary_select
+	DECODE_ARBITRARY_SELECT(int32_t, int32)
+
+extern int decode_uint64_arbitrary_select
+	DECODE_ARBITRARY_SELECT(uint64_t, uint64)
+
+extern int decode_int64_arbitrary_select
+	DECODE_ARBITRARY_SELECT(int64_t, int64)
+
+#undef DECODE_ARBITRARY_SELECT
+
+//generic function for sampling of decoy arrays----------------------------------------------------
+
+/*intermediate values of every block are sampled uniformly from [0; total-1] and mapped to elements
+by cumuls right away, so decoy elements are distributed according to weights. if there are a few
+weights and intermediate values are 32-bit, then indices are ranks of values among cumuls (see
+rank_uint32_small()), else they are found by binary search*/
+#define SAMPLE_ARBITRARY(itype, itype_name) \
+(itype *out_array, const size_t size, const itype min, const itype max, const uint64_t *cumuls) \
+{ \
+	/*intermediate values of current block, 32-bit ones are sampled faster*/ \
+	uint64_t temp_array[ARBITRARY_BLOCK]; \
+	uint32_t small_array[ARBITRARY_BLOCK]; \
+	/*cumuls padded with UINT32_MAX and indices of elements of current block for ranking*/ \
+	uint32_t keys[HD_RANK_KEYS]; \
+	size_t indices[ARBITRARY_BLOCK]; \
+	bool rank; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*index of current element and bounds of binary search*/ \
+	size_t index, middle, high; \
+	size_t i, wsize; \
+	uint64_t wsize_check; \
+	\
+	/*check the arguments*/ \
+	if ( (out_array == NULL) || (size == 0) || (min > max) || (cumuls == NULL) ) { \
+		error("wrong arguments"); \
+		return -1; \
+		} \
+	\
+	GET_WSIZE(); \
+	if (cumuls[wsize-1] == 0) { \
+		error("all weights are zero"); \
+		return -1; \
+		} \
+	/*intermediate values must fit in supported types*/ \
+	if (container_by_total(cumuls[wsize-1]) < 0) \
+		return -1; \
+	\
+	/*padding keys must be bigger than every intermediate value*/ \
+	rank = (wsize <= HD_RANK_KEYS) && (cumuls[wsize-1] <= UINT32_MAX); \
+	if (rank) \
+		for (i = 0; i < HD_RANK_KEYS; i++) \
+			keys[i] = (i < wsize) ? cumuls[i] : UINT32_MAX; \
+	\
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > ARBITRARY_BLOCK) \
+			n = ARBITRARY_BLOCK; \
+		\
+		if (cumuls[wsize-1] <= 4294967296) { \
+			if (sample_uint32_uniform(small_array, n, 0, cumuls[wsize-1] - 1)) \
+				return -1; \
+			if (rank) { \
+				rank_uint32_small(keys, small_array, n, indices); \
+				for (i = 0; i < n; i++) \
+					out_array[start+i] = indices[i] + min; \
+				continue; \
+				} \
+			for (i = 0; i < n; i++) \
+				temp_array[i] = small_array[i]; \
 			} \
-		else if (out_array[i] > max) { \
-			error("algorithm error: wrong value > max"); \
-			free(cumuls); \
-			free(temp_array); \
+		else if (sample_uint64_uniform(temp_array, n, 0, cumuls[wsize-1] - 1)) \
 			return -1; \
+		for (i = 0; i < n; i++) { \
+			/*binary search, every value is less than the last cumulative weight*/ \
+			index = 0; \
+			high = wsize; \
+			while (index < high) { \
+				middle = index + (high - index)/2; \
+				if (temp_array[i] < cumuls[middle]) \
+					high = middle; \
+				else \
+					index = middle + 1; \
+				} \
+			out_array[start+i] = index + min; \
 			} \
 		} \
 	\
-	free(cumuls); \
-	free(temp_array); \
 	return 0; \
-} while (0)
+}
 
-#define DECODE_ARBITRARY(itype) \
-(const void *in_array, itype *out_array, const size_t size, const itype min, \
-const itype max, const uint32_t *weights) \
-{ \
-	/*check the arguments*/ \
-	/*optimization note: some of this checks can safely be delegated to decode_ctype_uniform()*/ \
+extern int sample_uint8_arbitrary
+	SAMPLE_ARBITRARY(uint8_t, uint8)
+
+extern int sample_int8_arbitrary
+	SAMPLE_ARBITRARY(int8_t, int8)
+
+extern int sample_uint16_arbitrary
+	SAMPLE_ARBITRARY(uint16_t, uint16)
+
+extern int sample_int16_arbitrary
+	SAMPLE_ARBITRARY(int16_t, int16)
+
+extern int sample_uint32_arbitrary
+	SAMPLE_ARBITRARY(uint32_t, uint32)
+
+extern int sample_int32_arbitrary
+	SAMPLE_ARBITRARY(int32_t, int32)
+
+extern int sample_uint64_arbitrary
+	SAMPLE_ARBITRARY(uint64_t, uint64)
+
+extern int sample_int64_arbitrary
+	SAMPLE_ARBITRARY(int64_t, int64)
+
+#undef SAMPLE_ARBITRARY
+
+//generic DTE and DTD functions which allocate memory themselves-----------------------------------
+
+//check the arguments, then allocate memory for cumulative weights and compute them
+/*optimization note: cumulative weights can be saved after computation in encoding stage and
+just loaded (rather then re-computed) in decoding stage, see encode_itype_arbitrary_cumuls()*/
+#define CHECK_ARRAYS_GET_CUMULS() \
+do { \
 	if (in_array == NULL) { \
 		error("in_array = NULL"); \
 		return -1; \
@@ -302,53 +754,122 @@ const itype max, const uint32_t *weights) \
 		return -1; \
 		} \
 	\
-	/*current and previous weights*/ \
-	uint64_t current, prev; \
+	GET_WSIZE(); \
+	\
+	if ( (cumuls = malloc(wsize*sizeof(uint64_t))) == NULL ) { \
+		error("couldn't allocate memory for cumuls"); \
+		return -1; \
+		} \
+	if (get_cumuls(weights, cumuls, wsize)) { \
+		free(cumuls); \
+		return -1; \
+		} \
+} while (0)
+
+#define ENCODE_ARBITRARY(itype, itype_name) \
+(const itype *in_array, void **out_array, const size_t size, \
+const itype min, const itype max, const uint32_t *weights) \
+{ \
 	/*cumulative weights*/ \
 	uint64_t *cumuls; \
-	size_t i, wsize; \
+	size_t wsize; \
 	uint64_t wsize_check; \
+	/*size of container element*/ \
+	int osize; \
 	\
 	CHECK_ARRAYS_GET_CUMULS(); \
 	\
-	/*check maximum value after encoding (i.e., maximum cumulative weight value)*/ \
-	if (current < 256)				/*2^8*/ \
-		DECODE_IN_TYPE_ARBITRARY(uint8_t, uint8); \
-	else if (current < 65536)		/*2^16*/ \
-		DECODE_IN_TYPE_ARBITRARY(uint16_t, uint16); \
-	else if (current < 4294967296)	/*2^32*/ \
-		DECODE_IN_TYPE_ARBITRARY(uint32_t, uint32); \
-	else { \
-		error("too many values for any supported output type"); \
+	if ( (osize = container_by_total(cumuls[wsize-1])) < 0 ) { \
 		free(cumuls); \
 		return -1; \
 		} \
+	if ( (*out_array = malloc(size*osize)) == NULL ) { \
+		error("couldn't allocate memory for out_array"); \
+		free(cumuls); \
+		return -1; \
+		} \
+	\
+	osize = encode_##itype_name##_arbitrary_cumuls(in_array, *out_array, size, min, max, cumuls); \
+	free(cumuls); \
+	\
+	/*if error happened (e.g. input array is out of range), then return -1, else return size of \
+	output type in bytes*/ \
+	if (osize < 0) { \
+		free(*out_array); \
+		*out_array = NULL; \
+		} \
+	return osize; \
+}
+
+extern int encode_uint8_arbitrary
+	ENCODE_ARBITRARY(uint8_t, uint8)
+
+extern int encode_int8_arbitrary
+	ENCODE_ARBITRARY(int8_t, int8)
+
+extern int encode_uint16_arbitrary
+	ENCODE_ARBITRARY(uint16_t, uint16)
+
+extern int encode_int16_arbitrary
+	ENCODE_ARBITRARY(int16_t, int16)
+
+extern int encode_uint32_arbitrary
+	ENCODE_ARBITRARY(uint32_t, uint32)
+
+extern int encode_int32_arbitrary
+	ENCODE_ARBITRARY(int32_t, int32)
+
+extern int encode_uint64_arbitrary
+	ENCODE_ARBITRARY(uint64_t, uint64)
+
+extern int encode_int64_arbitrary
+	ENCODE_ARBITRARY(int64_t, int64)
+
+#undef ENCODE_ARBITRARY
+
+#define DECODE_ARBITRARY(itype, itype_name) \
+(const void *in_array, itype *out_array, const size_t size, const itype min, \
+const itype max, const uint32_t *weights) \
+{ \
+	/*cumulative weights*/ \
+	uint64_t *cumuls; \
+	size_t wsize; \
+	uint64_t wsize_check; \
+	/*return value*/ \
+	int rv; \
+	\
+	CHECK_ARRAYS_GET_CUMULS(); \
+	\
+	rv = decode_##itype_name##_arbitrary_cumuls(in_array, out_array, size, min, max, cumuls); \
+	free(cumuls); \
+	return rv; \
 }
 
 extern int decode_uint8_arbitrary
-	DECODE_ARBITRARY(uint8_t)
+	DECODE_ARBITRARY(uint8_t, uint8)
 
 extern int decode_int8_arbitrary
-	DECODE_ARBITRARY(int8_t)
+	DECODE_ARBITRARY(int8_t, int8)
 
 extern int decode_uint16_arbitrary
-	DECODE_ARBITRARY(uint16_t)
+	DECODE_ARBITRARY(uint16_t, uint16)
 
 extern int decode_int16_arbitrary
-	DECODE_ARBITRARY(int16_t)
+	DECODE_ARBITRARY(int16_t, int16)
 
 extern int decode_uint32_arbitrary
-	DECODE_ARBITRARY(uint32_t)
+	DECODE_ARBITRARY(uint32_t, uint32)
 
 extern int decode_int32_arbitrary
-	DECODE_ARBITRARY(int32_t)
+	DECODE_ARBITRARY(int32_t, int32)
 
 extern int decode_uint64_arbitrary
-	DECODE_ARBITRARY(uint64_t)
+	DECODE_ARBITRARY(uint64_t, uint64)
 
 extern int decode_int64_arbitrary
-	DECODE_ARBITRARY(int64_t)
+	DECODE_ARBITRARY(int64_t, int64)
 
 #undef DECODE_ARBITRARY
-#undef DECODE_IN_TYPE_ARBITRARY
 #undef CHECK_ARRAYS_GET_CUMULS
+#undef GET_WSIZE
+#undef ARBITRARY_BLOCK
@@ -9,7 +9,13 @@ license: BSD 2-Clause
 #include "hd_common.h"
 #include "hd_int_uniform.h"
 
-//DTE and DTD for unsigned and signed 8-, 16-, 32- and 64-bit integer arrays
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//DTE and DTD for unsigned and signed 8-, 16-, 32- and 64-bit integer arrays. container elements
+//take 2, 4 or 8 bytes if sum of weights is less than 2^8, 2^16 or 2^32, and 16 bytes otherwise
+//(only where 128-bit integers are supported)
 extern int encode_uint8_arbitrary(const uint8_t *in_array, void **out_array,
 	const size_t size, const uint8_t min, const uint8_t max, const uint32_t *weights);
 extern int decode_uint8_arbitrary(const void *in_array, uint8_t *out_array,
@@ -50,4 +56,142 @@ extern int encode_int64_arbitrary(const int64_t *in_array, void **out_array,
 extern int decode_int64_arbitrary(const void *in_array, int64_t *out_array,
 	const size_t size, const int64_t min, const int64_t max, const uint32_t *weights);
 
+/*functions below don't allocate memory: container of size elements takes
+size*container_itype_arbitrary() bytes, cumulative weights are computed by get_cumuls() once and
+can be reused by any number of calls. encoded arrays are the same as ones of functions above.*/
+
+//convert wsize weights to cumulative weights, return -1 on overflow
+extern int get_cumuls(const uint32_t *weights, uint64_t *cumuls, const size_t wsize);
+
+//get size of container element in bytes for weights of values from min to max, or -1 on error
+extern int container_uint8_arbitrary(const uint8_t min, const uint8_t max,
+	const uint32_t *weights);
+extern int container_int8_arbitrary(const int8_t min, const int8_t max, const uint32_t *weights);
+extern int container_uint16_arbitrary(const uint16_t min, const uint16_t max,
+	const uint32_t *weights);
+extern int container_int16_arbitrary(const int16_t min, const int16_t max,
+	const uint32_t *weights);
+extern int container_uint32_arbitrary(const uint32_t min, const uint32_t max,
+	const uint32_t *weights);
+extern int container_int32_arbitrary(const int32_t min, const int32_t max,
+	const uint32_t *weights);
+extern int container_uint64_arbitrary(const uint64_t min, const uint64_t max,
+	const uint32_t *weights);
+extern int container_int64_arbitrary(const int64_t min, const int64_t max,
+	const uint32_t *weights);
+
+//DTE and DTD with precomputed cumulative weights of (max-min+1) values, DTE returns size of
+//container element in bytes like encode_itype_arbitrary(). DTE checks input array (range and
+//weights of its values) before writing anything to out_array, but after any failure (-1) contents
+//of out_array are undefined.
+extern int encode_uint8_arbitrary_cumuls(const uint8_t *in_array, void *out_array,
+	const size_t size, const uint8_t min, const uint8_t max, const uint64_t *cumuls);
+extern int decode_uint8_arbitrary_cumuls(const void *in_array, uint8_t *out_array,
+	const size_t size, const uint8_t min, const uint8_t max, const uint64_t *cumuls);
+
+extern int encode_int8_arbitrary_cumuls(const int8_t *in_array, void *out_array,
+	const size_t size, const int8_t min, const int8_t max, const uint64_t *cumuls);
+extern int decode_int8_arbitrary_cumuls(const void *in_array, int8_t *out_array,
+	const size_t size, const int8_t min, const int8_t max, const uint64_t *cumuls);
+
+extern int encode_uint16_arbitrary_cumuls(const uint16_t *in_array, void *out_array,
+	const size_t size, const uint16_t min, const uint16_t max, const uint64_t *cumuls);
+extern int decode_uint16_arbitrary_cumuls(const void *in_array, uint16_t *out_array,
+	const size_t size, const uint16_t min, const uint16_t max, const uint64_t *cumuls);
+
+extern int encode_int16_arbitrary_cumuls(const int16_t *in_array, void *out_array,
+	const size_t size, const int16_t min, const int16_t max, const uint64_t *cumuls);
+extern int decode_int16_arbitrary_cumuls(const void *in_array, int16_t *out_array,
+	const size_t size, const int16_t min, const int16_t max, const uint64_t *cumuls);
+
+extern int encode_uint32_arbitrary_cumuls(const uint32_t *in_array, void *out_array,
+	const size_t size, const uint32_t min, const uint32_t max, const uint64_t *cumuls);
+extern int decode_uint32_arbitrary_cumuls(const void *in_array, uint32_t *out_array,
+	const size_t size, const uint32_t min, const uint32_t max, const uint64_t *cumuls);
+
+extern int encode_int32_arbitrary_cumuls(const int32_t *in_array, void *out_array,
+	const size_t size, const int32_t min, const int32_t max, const uint64_t *cumuls);
+extern int decode_int32_arbitrary_cumuls(const void *in_array, int32_t *out_array,
+	const size_t size, const int32_t min, const int32_t max, const uint64_t *cumuls);
+
+extern int encode_uint64_arbitrary_cumuls(const uint64_t *in_array, void *out_array,
+	const size_t size, const uint64_t min, const uint64_t max, const uint64_t *cumuls);
+extern int decode_uint64_arbitrary_cumuls(const void *in_array, uint64_t *out_array,
+	const size_t size, const uint64_t min, const uint64_t max, const uint64_t *cumuls);
+
+extern int encode_int64_arbitrary_cumuls(const int64_t *in_array, void *out_array,
+	const size_t size, const int64_t min, const int64_t max, const uint64_t *cumuls);
+extern int decode_int64_arbitrary_cumuls(const void *in_array, int64_t *out_array,
+	const size_t size, const int64_t min, const int64_t max, const uint64_t *cumuls);
+
+//DTD with aggregation: decode array by small blocks and add decoded elements to agg (see
+//aggregate_itype_array()) instead of writing them to output array
+extern int decode_uint8_arbitrary_aggregate(const void *in_array, const size_t size,
+	const uint8_t min, const uint8_t max, const uint64_t *cumuls, struct hd_uint8_aggregate *agg);
+extern int decode_int8_arbitrary_aggregate(const void *in_array, const size_t size,
+	const int8_t min, const int8_t max, const uint64_t *cumuls, struct hd_int8_aggregate *agg);
+extern int decode_uint16_arbitrary_aggregate(const void *in_array, const size_t size,
+	const uint16_t min, const uint16_t max, const uint64_t *cumuls, struct hd_uint16_aggregate *agg);
+extern int decode_int16_arbitrary_aggregate(const void *in_array, const size_t size,
+	const int16_t min, const int16_t max, const uint64_t *cumuls, struct hd_int16_aggregate *agg);
+extern int decode_uint32_arbitrary_aggregate(const void *in_array, const size_t size,
+	const uint32_t min, const uint32_t max, const uint64_t *cumuls, struct hd_uint32_aggregate *agg);
+extern int decode_int32_arbitrary_aggregate(const void *in_array, const size_t size,
+	const int32_t min, const int32_t max, const uint64_t *cumuls, struct hd_int32_aggregate *agg);
+extern int decode_uint64_arbitrary_aggregate(const void *in_array, const size_t size,
+	const uint64_t min, const uint64_t max, const uint64_t *cumuls, struct hd_uint64_aggregate *agg);
+extern int decode_int64_arbitrary_aggregate(const void *in_array, const size_t size,
+	const int64_t min, const int64_t max, const uint64_t *cumuls, struct hd_int64_aggregate *agg);
+
+//DTD with selection: decode array by small blocks and write indices of decoded elements from
+//[lo; hi] to selection and the elements themselves to values (if it's not NULL), see
+//select_itype_range(); selection and values must have space for size elements
+extern int decode_uint8_arbitrary_select(const void *in_array, const size_t size,
+	const uint8_t min, const uint8_t max, const uint64_t *cumuls, const uint8_t lo,
+	const uint8_t hi, size_t *selection, uint8_t *values, size_t *count);
+extern int decode_int8_arbitrary_select(const void *in_array, const size_t size,
+	const int8_t min, const int8_t max, const uint64_t *cumuls, const int8_t lo,
+	const int8_t hi, size_t *selection, int8_t *values, size_t *count);
+extern int decode_uint16_arbitrary_select(const void *in_array, const size_t size,
+	const uint16_t min, const uint16_t max, const uint64_t *cumuls, const uint16_t lo,
+	const uint16_t hi, size_t *selection, uint16_t *values, size_t *count);
+extern int decode_int16_arbitrary_select(const void *in_array, const size_t size,
+	const int16_t min, const int16_t max, const uint64_t *cumuls, const int16_t lo,
+	const int16_t hi, size_t *selection, int16_t *values, size_t *count);
+extern int decode_uint32_arbitrary_select(const void *in_array, const size_t size,
+	const uint32_t min, const uint32_t max, const uint64_t *cumuls, const uint32_t lo,
+	const uint32_t hi, size_t *selection, uint32_t *values, size_t *count);
+extern int decode_int32_arbitrary_select(const void *in_array, const size_t size,
+	const int32_t min, const int32_t max, const uint64_t *cumuls, const int32_t lo,
+	const int32_t hi, size_t *selection, int32_t *values, size_t *count);
+extern int decode_uint64_arbitrary_select(const void *in_array, const size_t size,
+	const uint64_t min, const uint64_t max, const uint64_t *cumuls, const uint64_t lo,
+	const uint64_t hi, size_t *selection, uint64_t *values, size_t *count);
+extern int decode_int64_arbitrary_select(const void *in_array, const size_t size,
+	const int64_t min, const int64_t max, const uint64_t *cumuls, const int64_t lo,
+	const int64_t hi, size_t *selection, int64_t *values, size_t *count);
+
+//sampling of decoys: write to out_array elements which are distributed according to weights,
+//like results of decoding with a wrong key (see sample_itype_uniform())
+extern int sample_uint8_arbitrary(uint8_t *out_array, const size_t size, const uint8_t min,
+	const uint8_t max, const uint64_t *cumuls);
+extern int sample_int8_arbitrary(int8_t *out_array, const size_t size, const int8_t min,
+	const int8_t max, const uint64_t *cumuls);
+extern int sample_uint16_arbitrary(uint16_t *out_array, const size_t size, const uint16_t min,
+	const uint16_t max, const uint64_t *cumuls);
+extern int sample_int16_arbitrary(int16_t *out_array, const size_t size, const int16_t min,
+	const int16_t max, const uint64_t *cumuls);
+extern int sample_uint32_arbitrary(uint32_t *out_array, const size_t size, const uint32_t min,
+	const uint32_t max, const uint64_t *cumuls);
+extern int sample_int32_arbitrary(int32_t *out_array, const size_t size, const int32_t min,
+	const int32_t max, const uint64_t *cumuls);
+extern int sample_uint64_arbitrary(uint64_t *out_array, const size_t size, const uint64_t min,
+	const uint64_t max, const uint64_t *cumuls);
+extern int sample_int64_arbitrary(int64_t *out_array, const size_t size, const int64_t min,
+	const int64_t max, const uint64_t *cumuls);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -9,16 +9,16 @@ license: BSD 2-Clause
 //itype - type of input elements
 //utype - unsigned type of same size as input type
 //otype - type of output elements (always unsigned, size is twice larger than size of itype)
+//ctype - name of itype in function names (e.g. uint8 for uint8_t)
 //UTYPE_MAX, OTYPE_MAX - maximum possible values of utype and otype, respectively
 //ISPACE - size of itype and utype code space (equals UTYPE_MAX + 1)
 //OSPACE - size of otype code space (equals OTYPE_MAX + 1)
 
-//generic DTE function for encoding integer arrays in integer arrays-------------------------------
+//checks of the arguments-------------------------------------------------------------------------
 
-#define ENCODE_IN_INT_UNIFORM(itype, utype, otype, UTYPE_MAX, OTYPE_MAX) \
-(const itype *in_array, otype *out_array, const size_t size, const itype min, const itype max) \
-{ \
-	/*check the arguments*/ \
+//check the arguments common for all DTE and DTD functions
+#define CHECK_ARGS() \
+do { \
 	if (in_array == NULL) { \
 		error("in_array = NULL"); \
 		return -1; \
@@ -35,7 +35,32 @@ license: BSD 2-Clause
 		error("min > max"); \
 		return -1; \
 		} \
+} while (0)
+
+/*check an input array of DTE function before writing anything to output array, so kernels don't
+need any checks. if every value is possible, then any input array is right.*/
+#define CHECK_RANGE(ctype, TYPE_MIN, TYPE_MAX) \
+do { \
+	/*description of wrong element of input array*/ \
+	struct hd_error err; \
 	\
+	if ( !( (min == TYPE_MIN) && (max == TYPE_MAX) ) && \
+		check_##ctype##_range(in_array, size, min, max, &err) ) { \
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" ); \
+		return -1; \
+		} \
+} while (0)
+
+//generic DTE kernel for encoding integer arrays in integer arrays---------------------------------
+
+/*kernels don't check anything, so input array must be checked before. random numbers for group
+selection are taken from rand_array, which must contain size*sizeof(otype) random bytes. rand_array
+can be the same array as out_array: every random number is read before corresponding output element
+is written. this lets the caller fill random numbers for many arrays at once (see hd_plan.c).*/
+#define ENCODE_IN_INT_UNIFORM_KERNEL(itype, utype, otype, UTYPE_MAX, OTYPE_MAX) \
+(const itype *in_array, otype *out_array, const otype *rand_array, const size_t size, \
+const itype min, const itype max) \
+{ \
 	/*current processing element after type promotion*/ \
 	otype oelt; \
 	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
@@ -46,6 +71,8 @@ license: BSD 2-Clause
 	(a + b) mod c = ( (a mod c) + (b mod c) ) mod c, but since c >= 2 where last_group_size is \
 	used, then 1 mod c = 1.*/\
 	const utype last_group_size = ( (OTYPE_MAX) % group_size + 1 ) % group_size; \
+	/*binary logarithm of group_size if it is a power of two*/ \
+	unsigned int shift; \
 	size_t i; \
 	\
 	/*if every value is possible*/ \
@@ -54,25 +81,31 @@ license: BSD 2-Clause
 	if (group_size == ( (otype)(UTYPE_MAX)+1 ) ) { \
 		/*then just copy input array to output array to create a first part*/ \
 		memcpy(out_array, in_array, size*sizeof(itype)); \
-		/*follow it by random numbers to create a second part*/ \
-		randombytes( (unsigned char *)out_array + size*sizeof(itype), \
-				size*(sizeof(otype) - sizeof(itype)) ); \
-		return 0; \
+		/*follow it by random numbers to create a second part (if rand_array is out_array then \
+		they are already there)*/ \
+		if (rand_array != out_array) \
+			memcpy( (unsigned char *)out_array + size*sizeof(itype), \
+					(const unsigned char *)rand_array + size*sizeof(itype), \
+					size*(sizeof(otype) - sizeof(itype)) ); \
+		return; \
 		} \
 	\
-	/*write the random numbers to output array*/ \
-	randombytes( (unsigned char *)out_array, size*sizeof(otype) ); \
-	\
 	/*if only one value is possible then use a random number for encoding each number*/ \
 	if (group_size == 1) { \
-		/*we're already done with random numbers, but we should check an input array*/ \
-		for (i = 0; i < size; i++) { \
-			if (in_array[i] != min) { \
-				error("wrong min or max value"); \
-				return -1; \
-				} \
-			} \
-		return 0; \
+		if (rand_array != out_array) \
+			memcpy(out_array, rand_array, size*sizeof(otype)); \
+		return; \
+		} \
+	\
+	/*if group_size is a power of two, then OSPACE is divided by it without remainder, so the last \
+	group is full, and group selection is just a shift: (rand % group_num) * group_size = \
+	rand << log2(group_size) (mod OSPACE)*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (shift = 0; ( (otype)1 << shift ) != group_size; shift++) \
+			; \
+		for (i = 0; i < size; i++) \
+			out_array[i] = (otype)(in_array[i] - (otype)min) + (otype)(rand_array[i] << shift); \
+		return; \
 		} \
 	\
 	/*total number of groups (from ISPACE+1 to OSPACE/2), so they will have indexes in interval \
@@ -80,75 +113,178 @@ license: BSD 2-Clause
 	formula is faster, more portable and reliable. see math.c for equivalence proof.*/ \
 	const otype group_num = (OTYPE_MAX) / group_size + 1; \
 	\
-	/*else encode each number using random numbers from out_array for group selection*/ \
+	/*else encode each number using random numbers from rand_array for group selection*/ \
 	for (i = 0; i < size; i++) { \
-		if (in_array[i] < min) { \
-			error("wrong min value"); \
-			return -1; \
-			} \
-		else if (in_array[i] > max) { \
-			error("wrong max value"); \
-			return -1; \
-			} \
 		/*note type promotion here: algorithm don't work right without it on e.g. int32 tests*/ \
 		oelt = in_array[i] - (otype)min; 		/*normalize current element and make type promotion*/ \
 		\
-		/*if we can place the current element in any group (including the last one) then do it*/ \
-		if ( (oelt < last_group_size) || (last_group_size == 0) ) \
-			oelt += (out_array[i] % group_num) * group_size; \
-		/*else place it in any group excluding the last one*/ \
-		else \
-			oelt += ( out_array[i] % (group_num-1) ) * group_size; \
+		/*if we can place the current element in any group (including the last one) then do it, \
+		else place it in any group excluding the last one. comparison result is used instead of \
+		branch here.*/ \
+		oelt += ( rand_array[i] % \
+			(group_num - ( (last_group_size != 0) & (oelt >= last_group_size) )) ) * group_size; \
 		\
 		out_array[i] = oelt;	/*finally write it to buffer*/ \
 		} \
-	\
-	return 0; \
 }
 
-extern int encode_uint8_uniform
-	ENCODE_IN_INT_UNIFORM(uint8_t, uint8_t, uint16_t, UINT8_MAX, UINT16_MAX)
+static void encode_uint8_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(uint8_t, uint8_t, uint16_t, UINT8_MAX, UINT16_MAX)
 
-extern int encode_int8_uniform
-	ENCODE_IN_INT_UNIFORM(int8_t, uint8_t, uint16_t, UINT8_MAX, UINT16_MAX)
+static void encode_int8_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(int8_t, uint8_t, uint16_t, UINT8_MAX, UINT16_MAX)
 
-extern int encode_uint16_uniform
-	ENCODE_IN_INT_UNIFORM(uint16_t, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX)
+static void encode_uint16_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(uint16_t, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX)
 
-extern int encode_int16_uniform
-	ENCODE_IN_INT_UNIFORM(int16_t, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX)
+static void encode_int16_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(int16_t, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX)
 
-extern int encode_uint32_uniform
-	ENCODE_IN_INT_UNIFORM(uint32_t, uint32_t, uint64_t, UINT32_MAX, UINT64_MAX)
+static void encode_uint32_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(uint32_t, uint32_t, uint64_t, UINT32_MAX, UINT64_MAX)
 
-extern int encode_int32_uniform
-	ENCODE_IN_INT_UNIFORM(int32_t, uint32_t, uint64_t, UINT32_MAX, UINT64_MAX)
+static void encode_int32_uniform_kernel
+	ENCODE_IN_INT_UNIFORM_KERNEL(int32_t, uint32_t, uint64_t, UINT32_MAX, UINT64_MAX)
+
+#undef ENCODE_IN_INT_UNIFORM_KERNEL
 
-#undef ENCODE_IN_INT_UNIFORM
+//generic DTE kernel for encoding integer arrays in 128-bit numbers-------------------------------
 
-//generic DTE function for encoding integer arrays in mpz_t arrays---------------------------------
+/*64-bit integers are encoded in 128-bit numbers, which are saved as 16 little endian bytes. if
+compiler supports unsigned __int128 and machine is little endian, then they are loaded and stored
+by memcpy() and processed natively, so functions below never allocate memory. else they are
+processed with GNU MP. define HD_GMP_UINT128 to use GNU MP anyway, e.g. for testing.*/
+#if defined(__SIZEOF_INT128__) && defined(__BYTE_ORDER__) && \
+	(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) && !defined(HD_GMP_UINT128)
+#define NATIVE_UINT128
+#endif
 
-#define ENCODE_IN_MPZ_UNIFORM(itype, TYPE_MIN, TYPE_MAX) \
-(const itype *in_array, unsigned char *out_array, const size_t size, const itype min, const itype max) \
+#ifdef NATIVE_UINT128
+
+//rand_array must contain 16*size random bytes and can be the same array as out_array
+#define ENCODE_IN_UINT128_UNIFORM_KERNEL(itype, TYPE_MIN, TYPE_MAX) \
+(const itype *in_array, unsigned char *out_array, const unsigned char *rand_array, \
+const size_t size, const itype min, const itype max) \
 { \
-	/*check the arguments*/ \
-	if (in_array == NULL) { \
-		error("in_array = NULL"); \
-		return -1; \
+	/*current processing element after type promotion and its random number*/ \
+	unsigned __int128 oelt, rand; \
+	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
+	const unsigned __int128 group_size = (unsigned __int128)( (uint64_t)max - (uint64_t)min ) + 1; \
+	/*binary logarithm of group_size if it is a power of two*/ \
+	unsigned int shift; \
+	size_t i; \
+	\
+	/*if every value is possible*/ \
+	if ( (min == TYPE_MIN) && (max == TYPE_MAX) ) { \
+		/*then just copy input array to output array to create a first part*/ \
+		memcpy(out_array, in_array, size*sizeof(itype)); \
+		/*follow it by random numbers to create a second part*/ \
+		if (rand_array != out_array) \
+			memcpy( out_array + size*sizeof(itype), rand_array + size*sizeof(itype), \
+					size*(16 - sizeof(itype)) ); \
+		return; \
 		} \
-	if (out_array == NULL) { \
-		error("out_array = NULL"); \
-		return -1; \
+	\
+	/*if only one value is possible then use a random number for encoding each number*/ \
+	if (min == max) { \
+		if (rand_array != out_array) \
+			memcpy(out_array, rand_array, 16*size); \
+		return; \
 		} \
-	if (size == 0) { \
-		error("size = 0"); \
-		return -1; \
+	\
+	/*if group_size is a power of two then group selection is just a shift*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (shift = 0; ( (unsigned __int128)1 << shift ) != group_size; shift++) \
+			; \
+		for (i = 0; i < size; i++) { \
+			memcpy(&rand, rand_array+16*i, 16); \
+			oelt = (uint64_t)in_array[i] - (uint64_t)min; \
+			oelt += rand << shift; \
+			memcpy(out_array+16*i, &oelt, 16); \
+			} \
+		return; \
 		} \
-	if (min > max) { \
-		error("min > max"); \
-		return -1; \
+	\
+	/*number of elements in the last group or 0 if the last group is full, and total number of \
+	groups, see ENCODE_IN_INT_UNIFORM_KERNEL() for formulas. OTYPE_MAX = 2^128 - 1 here.*/ \
+	const uint64_t last_group_size = ( ~(unsigned __int128)0 % group_size + 1 ) % group_size; \
+	const unsigned __int128 group_num = ~(unsigned __int128)0 / group_size + 1; \
+	\
+	/*else encode each number using random numbers from rand_array for group selection*/ \
+	for (i = 0; i < size; i++) { \
+		memcpy(&rand, rand_array+16*i, 16); \
+		oelt = (uint64_t)in_array[i] - (uint64_t)min; \
+		oelt += ( rand % \
+			(group_num - ( (last_group_size != 0) & (oelt >= last_group_size) )) ) * group_size; \
+		memcpy(out_array+16*i, &oelt, 16); \
+		} \
+}
+
+static void encode_uint64_uniform_kernel
+	ENCODE_IN_UINT128_UNIFORM_KERNEL(uint64_t, 0, UINT64_MAX)
+
+static void encode_int64_uniform_kernel
+	ENCODE_IN_UINT128_UNIFORM_KERNEL(int64_t, INT64_MIN, INT64_MAX)
+
+#undef ENCODE_IN_UINT128_UNIFORM_KERNEL
+
+#else
+
+/*if group_size = max - min + 1 is a power of two, then (rand % group_num) * group_size is a shift
+of 128-bit number, which is done with two 64-bit halves instead of GNU MP. mpz_export() and
+mpz_import() in functions below save 128-bit numbers as little endian ones on every machine, but
+the halves are loaded and stored by memcpy(), so this fast path is used only on little endian
+machines.*/
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+#define POW2_MPZ_ENCODE() \
+do { \
+	/*halves of current element, the least significant one first*/ \
+	uint64_t halves[2]; \
+	/*binary logarithm of group_size, from 1 to 63*/ \
+	unsigned int shift; \
+	\
+	normalized = max - min; \
+	if ( (normalized & (normalized + 1)) == 0 ) { \
+		for (shift = 0; ( (uint64_t)1 << shift ) != normalized + 1; shift++) \
+			; \
+		for (i = 0; i < size; i++) { \
+			memcpy(halves, rand_array+16*i, 16); \
+			halves[1] = (halves[1] << shift) | (halves[0] >> (64 - shift)); \
+			halves[0] = (halves[0] << shift) | (uint64_t)(in_array[i] - min); \
+			memcpy(out_array+16*i, halves, 16); \
+			} \
+		return; \
 		} \
+} while (0)
+
+#define POW2_MPZ_DECODE() \
+do { \
+	/*the least significant half of current element*/ \
+	uint64_t half; \
 	\
+	normalized = max - min; \
+	if ( (normalized & (normalized + 1)) == 0 ) { \
+		for (i = 0; i < size; i++) { \
+			memcpy(&half, in_array+16*i, 8); \
+			out_array[i] = (half & normalized) + min; \
+			} \
+		return 0; \
+		} \
+} while (0)
+
+#else
+
+#define POW2_MPZ_ENCODE() do {} while (0)
+#define POW2_MPZ_DECODE() do {} while (0)
+
+#endif
+
+//rand_array must contain 16*size random bytes and can be the same array as out_array
+#define ENCODE_IN_MPZ_UNIFORM_KERNEL(itype, TYPE_MIN, TYPE_MAX) \
+(const itype *in_array, unsigned char *out_array, const unsigned char *rand_array, \
+const size_t size, const itype min, const itype max) \
+{ \
 	/*current processing element after type promotion*/ \
 	mpz_t oelt; \
 	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
@@ -170,25 +306,21 @@ extern int encode_int32_uniform
 		/*then just copy input array to output array to create a first part*/ \
 		memcpy(out_array, in_array, size*sizeof(itype)); \
 		/*follow it by random numbers to create a second part*/ \
-		randombytes( out_array + size*sizeof(itype), size*(16 - sizeof(itype)) ); \
-		return 0; \
+		if (rand_array != out_array) \
+			memcpy( out_array + size*sizeof(itype), rand_array + size*sizeof(itype), \
+					size*(16 - sizeof(itype)) ); \
+		return; \
 		} \
 	\
-	/*write the random numbers to output array*/ \
-	randombytes(out_array, 16*size); \
-	\
 	/*if only one value is possible then use a random number for encoding each number*/ \
 	if (min == max) { \
-		/*we're already done with random numbers, but we should check an input array*/ \
-		for (i = 0; i < size; i++) { \
-			if (in_array[i] != min) { \
-				error("wrong min or max value"); \
-				return -1; \
-				} \
-			} \
-		return 0; \
+		if (rand_array != out_array) \
+			memcpy(out_array, rand_array, 16*size); \
+		return; \
 		} \
 	\
+	POW2_MPZ_ENCODE(); \
+	\
 	mpz_inits(oelt, group_size, group_num, group_num_minus_1, tmp, NULL); \
 	\
 	/*group_size = max - min + 1*/ \
@@ -221,17 +353,8 @@ extern int encode_int32_uniform
 	mpz_set(group_num_minus_1, group_num); \
 	mpz_add_ui(group_num, group_num, 1); \
 	\
-	/*else encode each number using random numbers from out_array for group selection*/ \
+	/*else encode each number using random numbers from rand_array for group selection*/ \
 	for (i = 0; i < size; i++) { \
-		if (in_array[i] < min) { \
-			error("wrong min value"); \
-			return -1; \
-			} \
-		else if (in_array[i] > max) { \
-			error("wrong max value"); \
-			return -1; \
-			} \
-		\
 		/*normalize current element and make type promotion: oelt = in_array[i] - min*/ \
 		normalized = in_array[i] - min; \
 		mpz_set_ui(oelt, normalized >> 32); \
@@ -239,12 +362,12 @@ extern int encode_int32_uniform
 		mpz_add_ui(oelt, oelt, normalized & 0xFFFFFFFF); \
 		\
 		/*if we can place the current element in any group (including the last one) then do it:
-		oelt += (out_array[i] % group_num) * group_size*/ \
-		mpz_import(tmp, 16/sizeof(int), -1, sizeof(int), 0, 0, out_array+16*i); \
+		oelt += (rand_array[i] % group_num) * group_size*/ \
+		mpz_import(tmp, 16/sizeof(int), -1, sizeof(int), -1, 0, rand_array+16*i); \
 		if ( (normalized < last_group_size) || (last_group_size == 0) ) \
 			mpz_tdiv_r(tmp, tmp, group_num); \
 		/*else place it in any group excluding the last one:
-		oelt += ( out_array[i] % (group_num-1) ) * group_size*/ \
+		oelt += ( rand_array[i] % (group_num-1) ) * group_size*/ \
 		else \
 			mpz_tdiv_r(tmp, tmp, group_num_minus_1); \
 		mpz_mul(tmp, tmp, group_size); \
@@ -253,46 +376,343 @@ extern int encode_int32_uniform
 		/*we must clear destination memory because garbage there may not be overwritten by next \
 		call: e.g., if current variable fits in 3 words then 4th word won't be overwritten*/ \
 		memset(out_array+16*i, 0, 16); \
-		mpz_export(out_array+16*i, NULL, -1, sizeof(int), 0, 0, oelt); \
+		mpz_export(out_array+16*i, NULL, -1, sizeof(int), -1, 0, oelt); \
 		} \
 	\
 	mpz_clears(oelt, group_size, group_num, group_num_minus_1, tmp, NULL); \
-	return 0; \
 }
 
-extern int encode_uint64_uniform
-	ENCODE_IN_MPZ_UNIFORM(uint64_t, 0, UINT64_MAX)
+static void encode_uint64_uniform_kernel
+	ENCODE_IN_MPZ_UNIFORM_KERNEL(uint64_t, 0, UINT64_MAX)
 
-extern int encode_int64_uniform
-	ENCODE_IN_MPZ_UNIFORM(int64_t, INT64_MIN, INT64_MAX)
+static void encode_int64_uniform_kernel
+	ENCODE_IN_MPZ_UNIFORM_KERNEL(int64_t, INT64_MIN, INT64_MAX)
 
-#undef ENCODE_IN_MPZ_UNIFORM
+#undef ENCODE_IN_MPZ_UNIFORM_KERNEL
 
-//generic DTE function for extracting integer arrays from integer arrays---------------------------
+#endif
 
-#define DECODE_IN_INT_UNIFORM(itype, otype, UTYPE_MAX) \
-(const otype *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
+//generic DTE kernel for encoding 128-bit integer arrays in 256-bit numbers-----------------------
+
+#ifdef HD_HAVE_INT128
+
+/*128-bit integers are encoded in 256-bit numbers, which are saved as 32 bytes: two 128-bit
+halves, the least significant one first. OSPACE = 2^256 can't be divided natively, so group of
+random number is selected in another, but equivalent way: if rand = k*group_size + r, where
+r < group_size, then encoded element is k*group_size + normalized element. if it doesn't fit in 256
+bits (it's possible only in the last group), then previous group is used.*/
+
+//get (hi*2^128 + lo) mod group_size, where group_size isn't a power of two
+static hd_uint128_t mod_uint256(const hd_uint128_t hi, const hd_uint128_t lo,
+	const hd_uint128_t group_size)
+{
+	/*64-bit digits of lo, the most significant one first*/
+	const uint64_t digits[2] = {lo >> 64, lo};
+	/*remainder, normalized divisor and its most significant digit*/
+	hd_uint128_t rem, divisor;
+	uint64_t divisor_hi;
+	/*current dividend (top*2^64 + low), product of divisor and estimated quotient digit
+	(prod_hi*2^64 + prod_lo) and the digit itself*/
+	hd_uint128_t top, prod_hi;
+	uint64_t low, prod_lo, q;
+	unsigned int shift;
+	int i;
+
+	rem = hi % group_size;
+
+	/*if group_size fits in 64 bits, then divide by 64-bit digits natively: every step divides
+	128-bit number by 64-bit one*/
+	if ( (group_size >> 64) == 0 ) {
+		rem = ( (rem << 64) | digits[0] ) % group_size;
+		return ( (rem << 64) | digits[1] ) % group_size;
+		}
+
+	/*else divide by 64-bit digits with Knuth's algorithm D: divisor is shifted left until its most
+	significant bit is set, then quotient digit estimated by the most significant digit of divisor
+	is greater than the right one at most by 2. dividend is shifted by the same number of bits, so
+	remainder is shifted back at the end of each step. precomputed reciprocals would need 256-bit
+	multiplications, so they aren't used here.*/
+	shift = __builtin_clzll(group_size >> 64);
+	divisor = group_size << shift;
+	divisor_hi = divisor >> 64;
+
+	for (i = 0; i < 2; i++) {
+		/*rem < group_size, so normalized dividend fits in 192 bits*/
+		top = rem << shift;
+		if (shift != 0)
+			top |= digits[i] >> (64 - shift);
+		low = digits[i] << shift;
+
+		/*estimate quotient digit, then correct it*/
+		q = ( (top >> 64) == divisor_hi ) ? UINT64_MAX : (uint64_t)(top / divisor_hi);
+		/*prod_hi holds product of the least significant digits first*/
+		prod_hi = (hd_uint128_t)q * (uint64_t)divisor;
+		prod_lo = prod_hi;
+		prod_hi = (hd_uint128_t)q * divisor_hi + (prod_hi >> 64);
+		while ( (prod_hi > top) || ( (prod_hi == top) && (prod_lo > low) ) ) {
+			prod_hi -= divisor_hi + ( prod_lo < (uint64_t)divisor );
+			prod_lo -= (uint64_t)divisor;
+			}
+
+		/*remainder is less than divisor, so it fits in 128 bits*/
+		rem = ( (top - prod_hi - (low < prod_lo)) << 64 ) | (uint64_t)(low - prod_lo);
+		rem >>= shift;
+		}
+
+	return rem;
+}
+
+//rand_array must contain 32*size random bytes and can be the same array as out_array
+#define ENCODE_IN_UINT256_UNIFORM_KERNEL(itype, TYPE_MIN, TYPE_MAX) \
+(const itype *in_array, unsigned char *out_array, const unsigned char *rand_array, \
+const size_t size, const itype min, const itype max) \
 { \
-	/*check the arguments*/ \
-	if (in_array == NULL) { \
-		error("in_array = NULL"); \
-		return -1; \
+	/*halves of current random number and processing element, the least significant one first*/ \
+	hd_uint128_t halves[2]; \
+	/*normalized value of current element*/ \
+	hd_uint128_t normalized; \
+	/*remainder of current random number and carry of addition*/ \
+	hd_uint128_t rem, carry; \
+	/*size of full group in elements, from 1 to 2^128-1 (or 0 if every value is possible)*/ \
+	const hd_uint128_t group_size = (hd_uint128_t)max - (hd_uint128_t)min + 1; \
+	size_t i; \
+	\
+	/*if every value is possible*/ \
+	if ( (min == TYPE_MIN) && (max == TYPE_MAX) ) { \
+		/*then just copy input array to output array to create a first part*/ \
+		memcpy(out_array, in_array, size*sizeof(itype)); \
+		/*follow it by random numbers to create a second part*/ \
+		if (rand_array != out_array) \
+			memcpy( out_array + size*sizeof(itype), rand_array + size*sizeof(itype), \
+					size*(32 - sizeof(itype)) ); \
+		return; \
 		} \
-	if (out_array == NULL) { \
-		error("out_array = NULL"); \
-		return -1; \
+	\
+	/*if only one value is possible then use a random number for encoding each number*/ \
+	if (min == max) { \
+		if (rand_array != out_array) \
+			memcpy(out_array, rand_array, 32*size); \
+		return; \
 		} \
-	if (size == 0) { \
-		error("size = 0"); \
-		return -1; \
+	\
+	/*if group_size is a power of two, then OSPACE is divided by it without remainder, so the last \
+	group is full, and rand - r is rand with cleared low bits*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (i = 0; i < size; i++) { \
+			memcpy(halves, rand_array+32*i, 32); \
+			halves[0] = (halves[0] & ~(group_size - 1)) | ( (hd_uint128_t)in_array[i] - \
+				(hd_uint128_t)min ); \
+			memcpy(out_array+32*i, halves, 32); \
+			} \
+		return; \
 		} \
-	if (min > max) { \
-		error("min > max"); \
+	\
+	/*else encode each number using random numbers from rand_array for group selection*/ \
+	for (i = 0; i < size; i++) { \
+		memcpy(halves, rand_array+32*i, 32); \
+		normalized = (hd_uint128_t)in_array[i] - (hd_uint128_t)min; \
+		rem = mod_uint256(halves[1], halves[0], group_size); \
+		\
+		/*halves = rand - rem, it doesn't underflow*/ \
+		halves[1] -= (halves[0] < rem); \
+		halves[0] -= rem; \
+		/*halves += normalized*/ \
+		halves[0] += normalized; \
+		carry = (halves[0] < normalized); \
+		halves[1] += carry; \
+		/*if the last group is too small for this element, then use the previous one*/ \
+		if ( carry & (halves[1] == 0) ) { \
+			halves[1] -= (halves[0] < group_size); \
+			halves[0] -= group_size; \
+			} \
+		\
+		memcpy(out_array+32*i, halves, 32); \
+		} \
+}
+
+static void encode_uint128_uniform_kernel
+	ENCODE_IN_UINT256_UNIFORM_KERNEL(hd_uint128_t, 0, HD_UINT128_MAX)
+
+static void encode_int128_uniform_kernel
+	ENCODE_IN_UINT256_UNIFORM_KERNEL(hd_int128_t, HD_INT128_MIN, HD_INT128_MAX)
+
+#undef ENCODE_IN_UINT256_UNIFORM_KERNEL
+
+#endif
+
+//generic DTE functions----------------------------------------------------------------------------
+
+//unchecked DTE: write the random numbers to output array, then encode in place
+#define ENCODE_UNIFORM_UNCHECKED(itype, otype, ctype, OSIZE) \
+(const itype *in_array, otype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	randombytes( (unsigned char *)out_array, size*(OSIZE) ); \
+	encode_##ctype##_uniform_kernel(in_array, out_array, out_array, size, min, max); \
+	return 0; \
+}
+
+extern int encode_uint8_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(uint8_t, uint16_t, uint8, sizeof(uint16_t))
+
+extern int encode_int8_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(int8_t, uint16_t, int8, sizeof(uint16_t))
+
+extern int encode_uint16_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(uint16_t, uint32_t, uint16, sizeof(uint32_t))
+
+extern int encode_int16_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(int16_t, uint32_t, int16, sizeof(uint32_t))
+
+extern int encode_uint32_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(uint32_t, uint64_t, uint32, sizeof(uint64_t))
+
+extern int encode_int32_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(int32_t, uint64_t, int32, sizeof(uint64_t))
+
+extern int encode_uint64_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(uint64_t, unsigned char, uint64, 16)
+
+extern int encode_int64_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(int64_t, unsigned char, int64, 16)
+
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(hd_uint128_t, unsigned char, uint128, 32)
+
+extern int encode_int128_uniform_unchecked
+	ENCODE_UNIFORM_UNCHECKED(hd_int128_t, unsigned char, int128, 32)
+#endif
+
+#undef ENCODE_UNIFORM_UNCHECKED
+
+//checked DTE with random numbers from rand_array
+#define ENCODE_UNIFORM_RAND(itype, otype, ctype, TYPE_MIN, TYPE_MAX) \
+(const itype *in_array, otype *out_array, const otype *rand_array, const size_t size, \
+const itype min, const itype max) \
+{ \
+	/*check the arguments*/ \
+	CHECK_ARGS(); \
+	if (rand_array == NULL) { \
+		error("rand_array = NULL"); \
 		return -1; \
 		} \
+	CHECK_RANGE(ctype, TYPE_MIN, TYPE_MAX); \
+	\
+	encode_##ctype##_uniform_kernel(in_array, out_array, rand_array, size, min, max); \
+	return 0; \
+}
+
+extern int encode_uint8_uniform_rand
+	ENCODE_UNIFORM_RAND(uint8_t, uint16_t, uint8, 0, UINT8_MAX)
+
+extern int encode_int8_uniform_rand
+	ENCODE_UNIFORM_RAND(int8_t, uint16_t, int8, INT8_MIN, INT8_MAX)
+
+extern int encode_uint16_uniform_rand
+	ENCODE_UNIFORM_RAND(uint16_t, uint32_t, uint16, 0, UINT16_MAX)
+
+extern int encode_int16_uniform_rand
+	ENCODE_UNIFORM_RAND(int16_t, uint32_t, int16, INT16_MIN, INT16_MAX)
+
+extern int encode_uint32_uniform_rand
+	ENCODE_UNIFORM_RAND(uint32_t, uint64_t, uint32, 0, UINT32_MAX)
+
+extern int encode_int32_uniform_rand
+	ENCODE_UNIFORM_RAND(int32_t, uint64_t, int32, INT32_MIN, INT32_MAX)
+
+extern int encode_uint64_uniform_rand
+	ENCODE_UNIFORM_RAND(uint64_t, unsigned char, uint64, 0, UINT64_MAX)
+
+extern int encode_int64_uniform_rand
+	ENCODE_UNIFORM_RAND(int64_t, unsigned char, int64, INT64_MIN, INT64_MAX)
+
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform_rand
+	ENCODE_UNIFORM_RAND(hd_uint128_t, unsigned char, uint128, 0, HD_UINT128_MAX)
+
+extern int encode_int128_uniform_rand
+	ENCODE_UNIFORM_RAND(hd_int128_t, unsigned char, int128, HD_INT128_MIN, HD_INT128_MAX)
+#endif
+
+#undef ENCODE_UNIFORM_RAND
+
+//checked DTE: wrapper around unchecked one
+#define ENCODE_UNIFORM(itype, otype, ctype, TYPE_MIN, TYPE_MAX) \
+(const itype *in_array, otype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	/*check the arguments*/ \
+	CHECK_ARGS(); \
+	CHECK_RANGE(ctype, TYPE_MIN, TYPE_MAX); \
 	\
+	return encode_##ctype##_uniform_unchecked(in_array, out_array, size, min, max); \
+}
+
+extern int encode_uint8_uniform
+	ENCODE_UNIFORM(uint8_t, uint16_t, uint8, 0, UINT8_MAX)
+
+extern int encode_int8_uniform
+	ENCODE_UNIFORM(int8_t, uint16_t, int8, INT8_MIN, INT8_MAX)
+
+extern int encode_uint16_uniform
+	ENCODE_UNIFORM(uint16_t, uint32_t, uint16, 0, UINT16_MAX)
+
+extern int encode_int16_uniform
+	ENCODE_UNIFORM(int16_t, uint32_t, int16, INT16_MIN, INT16_MAX)
+
+extern int encode_uint32_uniform
+	ENCODE_UNIFORM(uint32_t, uint64_t, uint32, 0, UINT32_MAX)
+
+extern int encode_int32_uniform
+	ENCODE_UNIFORM(int32_t, uint64_t, int32, INT32_MIN, INT32_MAX)
+
+extern int encode_uint64_uniform
+	ENCODE_UNIFORM(uint64_t, unsigned char, uint64, 0, UINT64_MAX)
+
+extern int encode_int64_uniform
+	ENCODE_UNIFORM(int64_t, unsigned char, int64, INT64_MIN, INT64_MAX)
+
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform
+	ENCODE_UNIFORM(hd_uint128_t, unsigned char, uint128, 0, HD_UINT128_MAX)
+
+extern int encode_int128_uniform
+	ENCODE_UNIFORM(hd_int128_t, unsigned char, int128, HD_INT128_MIN, HD_INT128_MAX)
+#endif
+
+#undef ENCODE_UNIFORM
+
+//generic unchecked DTD function for extracting integer arrays from integer arrays-----------------
+
+//high 32 and 64 bits of products of two 32-bit and two 64-bit numbers, respectively
+#define MULHI32(a, b) ( (uint32_t)( ( (uint64_t)(a) * (b) ) >> 32 ) )
+
+static uint64_t mulhi64(const uint64_t a, const uint64_t b)
+{
+#ifdef HD_HAVE_INT128
+	return ( (hd_uint128_t)a * b ) >> 64;
+#else
+	const uint64_t alo = (uint32_t)a, ahi = a >> 32, blo = (uint32_t)b, bhi = b >> 32;
+	//middle partial products with carries from the lower ones
+	const uint64_t mid = ahi*blo + ( (alo*blo) >> 32 );
+	
+	return ahi*bhi + (mid >> 32) + ( ( (uint32_t)mid + alo*bhi ) >> 32 );
+#endif
+}
+
+/*remainder of division by group_size is computed by multiplication by its reciprocal
+recip = floor(2^RBITS / group_size), where RBITS is size of rtype in bits: quotient
+(number*recip) >> RBITS is less than the true one by at most 1 for numbers less than 2^RBITS, so
+remainder needs at most one correction. results are the same as ones of division.
+MULHI(a, b) - high RBITS bits of product of two rtype numbers*/
+#define DECODE_IN_INT_UNIFORM_UNCHECKED(itype, otype, rtype, UTYPE_MAX, MULHI) \
+(const otype *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
+{ \
 	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
 	const otype group_size = (otype)max - min + 1; \
+	/*reciprocal of group_size and remainder of current element, from 0 to 2*group_size-1 before \
+	correction*/ \
+	rtype recip; \
+	otype rem; \
 	size_t i; \
 	\
 	/*if every value is possible then just copy first part of input array to output array*/ \
@@ -310,75 +730,112 @@ extern int encode_int64_uniform
 		return 0; \
 		} \
 	\
-	/*else decode each number*/ \
+	/*if group_size is a power of two then get value in first group by a mask*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (i = 0; i < size; i++) \
+			out_array[i] = (in_array[i] & (group_size - 1)) + min; \
+		return 0; \
+		} \
+	\
+	/*else decode each number: get its value in first group, denormalize it, do a type \
+	regression. group_size isn't a power of two, so floor(2^RBITS / group_size) equals \
+	floor( (2^RBITS - 1) / group_size )*/ \
+	recip = (rtype)-1 / group_size; \
 	for (i = 0; i < size; i++) { \
-		/*get its value in first group, denormalize it, do a type regression*/ \
-		out_array[i] = (in_array[i] % group_size) + min; \
-		\
-		/*if algorithm works right, this errors should never be thrown*/ \
-		if (out_array[i] < min) { \
-			error("algorithm error: wrong value < min"); \
-			return -1; \
-			} \
-		else if (out_array[i] > max) { \
-			error("algorithm error: wrong value > max"); \
-			return -1; \
-			} \
+		rem = in_array[i] - (otype)MULHI(in_array[i], recip) * group_size; \
+		out_array[i] = rem - (rem >= group_size)*group_size + min; \
 		} \
 	\
 	return 0; \
 }
 
-extern int decode_uint8_uniform
-	DECODE_IN_INT_UNIFORM(uint8_t, uint16_t, UINT8_MAX)
+extern int decode_uint8_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(uint8_t, uint16_t, uint32_t, UINT8_MAX, MULHI32)
 
-extern int decode_int8_uniform
-	DECODE_IN_INT_UNIFORM(int8_t, uint16_t, UINT8_MAX)
+extern int decode_int8_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(int8_t, uint16_t, uint32_t, UINT8_MAX, MULHI32)
 
-extern int decode_uint16_uniform
-	DECODE_IN_INT_UNIFORM(uint16_t, uint32_t, UINT16_MAX)
+extern int decode_uint16_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(uint16_t, uint32_t, uint32_t, UINT16_MAX, MULHI32)
 
-extern int decode_int16_uniform
-	DECODE_IN_INT_UNIFORM(int16_t, uint32_t, UINT16_MAX)
+extern int decode_int16_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(int16_t, uint32_t, uint32_t, UINT16_MAX, MULHI32)
 
-extern int decode_uint32_uniform
-	DECODE_IN_INT_UNIFORM(uint32_t, uint64_t, UINT32_MAX)
+extern int decode_uint32_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(uint32_t, uint64_t, uint64_t, UINT32_MAX, mulhi64)
 
-extern int decode_int32_uniform
-	DECODE_IN_INT_UNIFORM(int32_t, uint64_t, UINT32_MAX)
+extern int decode_int32_uniform_unchecked
+	DECODE_IN_INT_UNIFORM_UNCHECKED(int32_t, uint64_t, uint64_t, UINT32_MAX, mulhi64)
 
-#undef DECODE_IN_INT_UNIFORM
+#undef DECODE_IN_INT_UNIFORM_UNCHECKED
+#undef MULHI32
 
-//generic DTE function for extracting integer arrays from mpz_t arrays-----------------------------
+//generic unchecked DTD function for extracting integer arrays from 128-bit numbers---------------
 
-#define DECODE_IN_MPZ_UNIFORM(itype, TYPE_MIN, TYPE_MAX) \
+#ifdef NATIVE_UINT128
+
+#define DECODE_IN_UINT128_UNIFORM_UNCHECKED(itype, TYPE_MIN, TYPE_MAX) \
 (const unsigned char *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
 { \
-	/*check the arguments*/ \
-	if (in_array == NULL) { \
-		error("in_array = NULL"); \
-		return -1; \
-		} \
-	if (out_array == NULL) { \
-		error("out_array = NULL"); \
-		return -1; \
-		} \
-	if (size == 0) { \
-		error("size = 0"); \
-		return -1; \
-		} \
-	if (min > max) { \
-		error("min > max"); \
-		return -1; \
-		} \
-	\
 	/*current processing element before type promotion*/ \
-	mpz_t ielt; \
+	unsigned __int128 ielt; \
 	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
-	mpz_t group_size; \
-	/*temporary variable for different computations*/ \
-	mpz_t tmp; \
-	/*normalized value of current element*/ \
+	const unsigned __int128 group_size = (unsigned __int128)( (uint64_t)max - (uint64_t)min ) + 1; \
+	size_t i; \
+	\
+	/*if every value is possible then just copy first part of input array to output array*/ \
+	if ( (min == TYPE_MIN) && (max == TYPE_MAX) ) { \
+		memcpy(out_array, in_array, size*sizeof(itype)); \
+		return 0; \
+		} \
+	\
+	/*if only one value is possible then fill output array with this value*/ \
+	if (min == max) { \
+		for (i = 0; i < size; i++) \
+			out_array[i] = min; \
+		return 0; \
+		} \
+	\
+	/*if group_size is a power of two then get value in first group by a mask*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (i = 0; i < size; i++) { \
+			memcpy(&ielt, in_array+16*i, 16); \
+			out_array[i] = (uint64_t)(ielt & (group_size - 1)) + (uint64_t)min; \
+			} \
+		return 0; \
+		} \
+	\
+	/*else decode each number: get its value in first group, denormalize it, do a type \
+	regression*/ \
+	for (i = 0; i < size; i++) { \
+		memcpy(&ielt, in_array+16*i, 16); \
+		out_array[i] = (uint64_t)(ielt % group_size) + (uint64_t)min; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint64_uniform_unchecked
+	DECODE_IN_UINT128_UNIFORM_UNCHECKED(uint64_t, 0, UINT64_MAX)
+
+extern int decode_int64_uniform_unchecked
+	DECODE_IN_UINT128_UNIFORM_UNCHECKED(int64_t, INT64_MIN, INT64_MAX)
+
+#undef DECODE_IN_UINT128_UNIFORM_UNCHECKED
+
+#else
+
+
+#define DECODE_IN_MPZ_UNIFORM_UNCHECKED(itype, TYPE_MIN, TYPE_MAX) \
+(const unsigned char *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	/*current processing element before type promotion*/ \
+	mpz_t ielt; \
+	/*size of full group in elements, from 1 to (itype_MAX-itype_MIN+1)*/ \
+	mpz_t group_size; \
+	/*temporary variable for different computations*/ \
+	mpz_t tmp; \
+	/*normalized value of current element*/ \
 	uint64_t normalized; \
 	size_t i; \
 	\
@@ -395,6 +852,8 @@ extern int decode_int32_uniform
 		return 0; \
 		} \
 	\
+	POW2_MPZ_DECODE(); \
+	\
 	mpz_inits(ielt, group_size, tmp, NULL); \
 	\
 	/*group_size = max - min + 1*/ \
@@ -408,7 +867,7 @@ extern int decode_int32_uniform
 	for (i = 0; i < size; i++) { \
 		/*get its value in first group, denormalize it, do a type regression*/ \
 		/*out_array[i] = (in_array[i] % group_size) + min*/ \
-		mpz_import(ielt, 16/sizeof(int), -1, sizeof(int), 0, 0, in_array+16*i); \
+		mpz_import(ielt, 16/sizeof(int), -1, sizeof(int), -1, 0, in_array+16*i); \
 		mpz_tdiv_r(ielt, ielt, group_size); \
 		/*save second half (i.e. its most significant 4 bytes) of ielt in tmp, first half (i.e. \
 		its least significant 4 bytes) in ielt*/ \
@@ -419,26 +878,619 @@ extern int decode_int32_uniform
 		normalized <<= 32; \
 		normalized += mpz_get_ui(ielt); \
 		out_array[i] = normalized + min; \
-		\
-		/*if algorithm works right, this errors should never be thrown*/ \
-		if (out_array[i] < min) { \
-			error("algorithm error: wrong value < min"); \
-			return -1; \
-			} \
-		else if (out_array[i] > max) { \
-			error("algorithm error: wrong value > max"); \
-			return -1; \
-			} \
 		} \
 	\
 	mpz_clears(ielt, group_size, tmp, NULL); \
 	return 0; \
 }
 
+extern int decode_uint64_uniform_unchecked
+	DECODE_IN_MPZ_UNIFORM_UNCHECKED(uint64_t, 0, UINT64_MAX)
+
+extern int decode_int64_uniform_unchecked
+	DECODE_IN_MPZ_UNIFORM_UNCHECKED(int64_t, INT64_MIN, INT64_MAX)
+
+#undef DECODE_IN_MPZ_UNIFORM_UNCHECKED
+#undef POW2_MPZ_DECODE
+#undef POW2_MPZ_ENCODE
+
+#endif
+
+#undef NATIVE_UINT128
+
+//generic unchecked DTD function for extracting 128-bit integer arrays from 256-bit numbers--------
+
+#ifdef HD_HAVE_INT128
+
+#define DECODE_IN_UINT256_UNIFORM_UNCHECKED(itype, TYPE_MIN, TYPE_MAX) \
+(const unsigned char *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	/*halves of current processing element, the least significant one first*/ \
+	hd_uint128_t halves[2]; \
+	/*size of full group in elements, from 1 to 2^128-1 (or 0 if every value is possible)*/ \
+	const hd_uint128_t group_size = (hd_uint128_t)max - (hd_uint128_t)min + 1; \
+	size_t i; \
+	\
+	/*if every value is possible then just copy first part of input array to output array*/ \
+	if ( (min == TYPE_MIN) && (max == TYPE_MAX) ) { \
+		memcpy(out_array, in_array, size*sizeof(itype)); \
+		return 0; \
+		} \
+	\
+	/*if only one value is possible then fill output array with this value*/ \
+	if (min == max) { \
+		for (i = 0; i < size; i++) \
+			out_array[i] = min; \
+		return 0; \
+		} \
+	\
+	/*if group_size is a power of two then get value in first group by a mask*/ \
+	if ( (group_size & (group_size - 1)) == 0 ) { \
+		for (i = 0; i < size; i++) { \
+			memcpy(halves, in_array+32*i, 16); \
+			out_array[i] = (halves[0] & (group_size - 1)) + (hd_uint128_t)min; \
+			} \
+		return 0; \
+		} \
+	\
+	/*else decode each number: get its value in first group, denormalize it, do a type \
+	regression*/ \
+	for (i = 0; i < size; i++) { \
+		memcpy(halves, in_array+32*i, 32); \
+		out_array[i] = mod_uint256(halves[1], halves[0], group_size) + (hd_uint128_t)min; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint128_uniform_unchecked
+	DECODE_IN_UINT256_UNIFORM_UNCHECKED(hd_uint128_t, 0, HD_UINT128_MAX)
+
+extern int decode_int128_uniform_unchecked
+	DECODE_IN_UINT256_UNIFORM_UNCHECKED(hd_int128_t, HD_INT128_MIN, HD_INT128_MAX)
+
+#undef DECODE_IN_UINT256_UNIFORM_UNCHECKED
+
+#endif
+
+//generic checked DTD function: wrapper around unchecked one---------------------------------------
+
+#define DECODE_UNIFORM(itype, otype, ctype) \
+(const otype *in_array, itype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	/*check the arguments*/ \
+	CHECK_ARGS(); \
+	\
+	decode_##ctype##_uniform_unchecked(in_array, out_array, size, min, max); \
+	\
+	/*if algorithm works right, this error should never be thrown*/ \
+	if (check_##ctype##_range(out_array, size, min, max, NULL)) { \
+		error("algorithm error: wrong decoded value"); \
+		return -1; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_uniform
+	DECODE_UNIFORM(uint8_t, uint16_t, uint8)
+
+extern int decode_int8_uniform
+	DECODE_UNIFORM(int8_t, uint16_t, int8)
+
+extern int decode_uint16_uniform
+	DECODE_UNIFORM(uint16_t, uint32_t, uint16)
+
+extern int decode_int16_uniform
+	DECODE_UNIFORM(int16_t, uint32_t, int16)
+
+extern int decode_uint32_uniform
+	DECODE_UNIFORM(uint32_t, uint64_t, uint32)
+
+extern int decode_int32_uniform
+	DECODE_UNIFORM(int32_t, uint64_t, int32)
+
 extern int decode_uint64_uniform
-	DECODE_IN_MPZ_UNIFORM(uint64_t, 0, UINT64_MAX)
+	DECODE_UNIFORM(uint64_t, unsigned char, uint64)
 
 extern int decode_int64_uniform
-	DECODE_IN_MPZ_UNIFORM(int64_t, INT64_MIN, INT64_MAX)
+	DECODE_UNIFORM(int64_t, unsigned char, int64)
+
+#ifdef HD_HAVE_INT128
+extern int decode_uint128_uniform
+	DECODE_UNIFORM(hd_uint128_t, unsigned char, uint128)
+
+extern int decode_int128_uniform
+	DECODE_UNIFORM(hd_int128_t, unsigned char, int128)
+#endif
+
+#undef DECODE_UNIFORM
+
+//generic DTD functions with aggregation or selection of decoded elements--------------------------
+
+//number of elements decoded at once to buffer on stack, which is processed while it's in cache
+#define DECODE_BLOCK 1024
+
+#define DECODE_UNIFORM_AGGREGATE(itype, otype, ctype, OSIZE, TYPE_MIN, TYPE_MAX) \
+(const otype *in_array, const size_t size, const itype min, const itype max, \
+struct hd_##ctype##_aggregate *agg) \
+{ \
+	/*decoded elements of current block*/ \
+	itype block_array[DECODE_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*if every value is possible then container is a copy of input array followed by random \
+	numbers, so blocks are taken from this copy*/ \
+	const size_t stride = ( (min == TYPE_MIN) && (max == TYPE_MAX) ) ? sizeof(itype) : (OSIZE); \
+	\
+	/*check the arguments*/ \
+	if (in_array == NULL) { \
+		error("in_array = NULL"); \
+		return -1; \
+		} \
+	if (size == 0) { \
+		error("size = 0"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	if (agg == NULL) { \
+		error("agg = NULL"); \
+		return -1; \
+		} \
+	\
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > DECODE_BLOCK) \
+			n = DECODE_BLOCK; \
+		\
+		decode_##ctype##_uniform_unchecked( (const otype *)( (const unsigned char *)in_array + \
+			start*stride ), block_array, n, min, max); \
+		aggregate_##ctype##_array(block_array, n, agg); \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(uint8_t, uint16_t, uint8, sizeof(uint16_t), 0, UINT8_MAX)
+
+extern int decode_int8_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(int8_t, uint16_t, int8, sizeof(uint16_t), INT8_MIN, INT8_MAX)
+
+extern int decode_uint16_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(uint16_t, uint32_t, uint16, sizeof(uint32_t), 0, UINT16_MAX)
+
+extern int decode_int16_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(int16_t, uint32_t, int16, sizeof(uint32_t), INT16_MIN, INT16_MAX)
+
+extern int decode_uint32_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(uint32_t, uint64_t, uint32, sizeof(uint64_t), 0, UINT32_MAX)
+
+extern int decode_int32_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(int32_t, uint64_t, int32, sizeof(uint64_t), INT32_MIN, INT32_MAX)
+
+extern int decode_uint64_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(uint64_t, unsigned char, uint64, 16, 0, UINT64_MAX)
+
+extern int decode_int64_uniform_aggregate
+	DECODE_UNIFORM_AGGREGATE(int64_t, unsigned char, int64, 16, INT64_MIN, INT64_MAX)
+
+#undef DECODE_UNIFORM_AGGREGATE
+
+#define DECODE_UNIFORM_SELECT(itype, otype, ctype, OSIZE, TYPE_MIN, TYPE_MAX) \
+(const otype *in_array, const size_t size, const itype min, const itype max, const itype lo, \
+const itype hi, size_t *selection, itype *values, size_t *count) \
+{ \
+	/*decoded elements of current block*/ \
+	itype block_array[DECODE_BLOCK]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	/*number of elements selected in current block*/ \
+	size_t selected; \
+	size_t i; \
+	/*if every value is possible then container is a copy of input array followed by random \
+	numbers, so blocks are taken from this copy*/ \
+	const size_t stride = ( (min == TYPE_MIN) && (max == TYPE_MAX) ) ? sizeof(itype) : (OSIZE); \
+	\
+	/*check the arguments*/ \
+	if (in_array == NULL) { \
+		error("in_array = NULL"); \
+		return -1; \
+		} \
+	if (size == 0) { \
+		error("size = 0"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	if ( (selection == NULL) || (count == NULL) ) { \
+		error("selection = NULL or count = NULL"); \
+		return -1; \
+		} \
+	\
+	*count = 0; \
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > DECODE_BLOCK) \
+			n = DECODE_BLOCK; \
+		\
+		decode_##ctype##_uniform_unchecked( (const otype *)( (const unsigned char *)in_array + \
+			start*stride ), block_array, n, min, max); \
+		select_##ctype##_range(block_array, n, lo, hi, selection + *count, \
+			(values == NULL) ? NULL : values + *count, &selected); \
+		/*kernel returns indices in block, make them indices in whole array*/ \
+		for (i = *count; i < *count + selected; i++) \
+			selection[i] += start; \
+		*count += selected; \
+		} \
+	\
+	return 0; \
+}
+
+extern int decode_uint8_uniform_select
+	DECODE_UNIFORM_SELECT(uint8_t, uint16_t, uint8, sizeof(uint16_t), 0, UINT8_MAX)
+
+extern int decode_int8_uniform_select
+	DECODE_UNIFORM_SELECT(int8_t, uint16_t, int8, sizeof(uint16_t), INT8_MIN, INT8_MAX)
+
+extern int decode_uint16_uniform_select
+	DECODE_UNIFORM_SELECT(uint16_t, uint32_t, uint16, sizeof(uint32_t), 0, UINT16_MAX)
+
+extern int decode_int16_uniform_select
+	DECODE_UNIFORM_SELECT(int16_t, uint32_t, int16, sizeof(uint32_t), INT16_MIN, INT16_MAX)
+
+extern int decode_uint32_uniform_select
+	DECODE_UNIFORM_SELECT(uint32_t, uint64_t, uint32, sizeof(uint64_t), 0, UINT32_MAX)
+
+extern int decode_int32_uniform_select
+	DECODE_UNIFORM_SELECT(int32_t, uint64_t, int32, sizeof(uint64_t), INT32_MIN, INT32_MAX)
+
+extern int decode_uint64_uniform_select
+	DECODE_UNIFORM_SELECT(uint64_t, unsigned char, uint64, 16, 0, UINT64_MAX)
+
+extern int decode_int64_uniform_select
+	DECODE_UNIFORM_SELECT(int64_t, unsigned char, int64, 16, INT64_MIN, INT64_MAX)
+
+#undef DECODE_UNIFORM_SELECT
+
+//generic function for sampling of decoy arrays----------------------------------------------------
+
+/*decoy array is a result of decoding of random container array, so random containers of every
+block are generated in buffer on stack and decoded by unchecked DTD right away. containers are
+generated by OpenSSL random generator by blocks of SAMPLE_BYTES bytes: it works in user space and
+has separate state for every thread, so it's much faster than randombytes(), and several threads
+can sample different parts of the same array at once*/
+#define SAMPLE_BYTES 32768
+
+#define SAMPLE_UNIFORM(itype, otype, ctype, OSIZE) \
+(itype *out_array, const size_t size, const itype min, const itype max) \
+{ \
+	/*random containers of current block*/ \
+	otype rand_array[SAMPLE_BYTES/sizeof(otype)]; \
+	/*first element and size of current block*/ \
+	size_t start, n; \
+	\
+	/*check the arguments*/ \
+	if (out_array == NULL) { \
+		error("out_array = NULL"); \
+		return -1; \
+		} \
+	if (size == 0) { \
+		error("size = 0"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	\
+	for (start = 0; start < size; start += n) { \
+		n = size - start; \
+		if (n > SAMPLE_BYTES/(OSIZE)) \
+			n = SAMPLE_BYTES/(OSIZE); \
+		\
+		if (RAND_bytes((unsigned char *)rand_array, n*(OSIZE)) != 1) { \
+			error("couldn't generate random containers"); \
+			return -1; \
+			} \
+		decode_##ctype##_uniform_unchecked(rand_array, out_array + start, n, min, max); \
+		} \
+	\
+	return 0; \
+}
+
+extern int sample_uint8_uniform
+	SAMPLE_UNIFORM(uint8_t, uint16_t, uint8, sizeof(uint16_t))
+
+extern int sample_int8_uniform
+	SAMPLE_UNIFORM(int8_t, uint16_t, int8, sizeof(uint16_t))
+
+extern int sample_uint16_uniform
+	SAMPLE_UNIFORM(uint16_t, uint32_t, uint16, sizeof(uint32_t))
+
+extern int sample_int16_uniform
+	SAMPLE_UNIFORM(int16_t, uint32_t, int16, sizeof(uint32_t))
+
+extern int sample_uint32_uniform
+	SAMPLE_UNIFORM(uint32_t, uint64_t, uint32, sizeof(uint64_t))
+
+extern int sample_int32_uniform
+	SAMPLE_UNIFORM(int32_t, uint64_t, int32, sizeof(uint64_t))
+
+extern int sample_uint64_uniform
+	SAMPLE_UNIFORM(uint64_t, unsigned char, uint64, 16)
+
+extern int sample_int64_uniform
+	SAMPLE_UNIFORM(int64_t, unsigned char, int64, 16)
+
+#ifdef HD_HAVE_INT128
+extern int sample_uint128_uniform
+	SAMPLE_UNIFORM(hd_uint128_t, unsigned char, uint128, 32)
+
+extern int sample_int128_uniform
+	SAMPLE_UNIFORM(hd_int128_t, unsigned char, int128, 32)
+#endif
+
+#undef SAMPLE_UNIFORM
+#undef SAMPLE_BYTES
+#undef DECODE_BLOCK
+
+//table-driven DTE and DTD for 8-bit integers-----------------------------------------------------
+
+/*there are only 65536 container values for 8-bit integers, so tables for them are small enough:
+container to value table for decoding, and tables of group offsets for every random number for
+encoding. so decoding is a single table lookup per element, and encoding is a lookup and addition.*/
+struct hd_table8 {
+	enum hd_type type;		//HD_UINT8 or HD_INT8: uint8_t and int8_t tables differ
+	uint8_t min, max;		//range of values (bits of int8_t values for int8_t arrays)
+	bool full;				//true if every value is possible, then tables aren't used
+	uint16_t last_group_size;
+	//decoded values of all container values
+	uint8_t values[UINT16_MAX + 1];
+	/*offsets[0][r] = (r % group_num) * group_size for elements which can be placed in any group,
+	offsets[1][r] = ( r % (group_num - 1) ) * group_size for other elements*/
+	uint16_t offsets[2][UINT16_MAX + 1];
+	};
+
+#define CREATE_TABLE8(itype, TYPE, TYPE_MIN, TYPE_MAX) \
+(const itype min, const itype max) \
+{ \
+	if (min > max) { \
+		error("min > max"); \
+		return NULL; \
+		} \
+	\
+	struct hd_table8 *table; \
+	/*see ENCODE_IN_INT_UNIFORM_KERNEL() for description of this values*/ \
+	const uint32_t group_size = (uint8_t)( (uint8_t)max - (uint8_t)min ) + 1; \
+	const uint32_t group_num = UINT16_MAX / group_size + 1; \
+	uint32_t i; \
+	\
+	if ( (table = malloc(sizeof(struct hd_table8))) == NULL ) { \
+		error("couldn't allocate memory for table"); \
+		return NULL; \
+		} \
+	table->type = TYPE; \
+	table->min = min; \
+	table->max = max; \
+	table->full = (min == TYPE_MIN) && (max == TYPE_MAX); \
+	if (table->full) \
+		return table; \
+	\
+	table->last_group_size = ( UINT16_MAX % group_size + 1 ) % group_size; \
+	for (i = 0; i <= UINT16_MAX; i++) { \
+		table->values[i] = (i % group_size) + (uint8_t)min; \
+		table->offsets[0][i] = (i % group_num) * group_size; \
+		/*if the last group is full then every element can be placed in any group*/ \
+		table->offsets[1][i] = (table->last_group_size != 0) ? \
+			(i % (group_num - 1)) * group_size : table->offsets[0][i]; \
+		} \
+	return table; \
+}
+
+extern struct hd_table8 *create_uint8_uniform_table
+	CREATE_TABLE8(uint8_t, HD_UINT8, 0, UINT8_MAX)
+
+extern struct hd_table8 *create_int8_uniform_table
+	CREATE_TABLE8(int8_t, HD_INT8, INT8_MIN, INT8_MAX)
+
+#undef CREATE_TABLE8
+
+extern void free_uniform_table(struct hd_table8 *table)
+{
+	free(table);
+}
+
+#define ENCODE_TABLE8(itype, ctype, TYPE, TYPE_MIN, TYPE_MAX) \
+(const struct hd_table8 *table, const itype *in_array, uint16_t *out_array, const size_t size) \
+{ \
+	if (table == NULL) { \
+		error("table = NULL"); \
+		return -1; \
+		} \
+	if (table->type != TYPE) { \
+		error("type of table differs from type of array"); \
+		return -1; \
+		} \
+	\
+	const itype min = table->min; \
+	const itype max = table->max; \
+	/*normalized value of current element*/ \
+	uint8_t normalized; \
+	size_t i; \
+	\
+	/*check the arguments*/ \
+	CHECK_ARGS(); \
+	CHECK_RANGE(ctype, TYPE_MIN, TYPE_MAX); \
+	\
+	if (table->full) \
+		return encode_##ctype##_uniform_unchecked(in_array, out_array, size, min, max); \
+	\
+	/*write the random numbers to output array, then encode in place*/ \
+	randombytes( (unsigned char *)out_array, size*sizeof(uint16_t) ); \
+	for (i = 0; i < size; i++) { \
+		normalized = (uint8_t)in_array[i] - table->min; \
+		out_array[i] = normalized + \
+			table->offsets[normalized >= table->last_group_size][out_array[i]]; \
+		} \
+	return 0; \
+}
+
+extern int encode_uint8_uniform_table
+	ENCODE_TABLE8(uint8_t, uint8, HD_UINT8, 0, UINT8_MAX)
+
+extern int encode_int8_uniform_table
+	ENCODE_TABLE8(int8_t, int8, HD_INT8, INT8_MIN, INT8_MAX)
+
+#undef ENCODE_TABLE8
+
+#define DECODE_TABLE8(itype, ctype, TYPE) \
+(const struct hd_table8 *table, const uint16_t *in_array, itype *out_array, const size_t size) \
+{ \
+	if (table == NULL) { \
+		error("table = NULL"); \
+		return -1; \
+		} \
+	if (table->type != TYPE) { \
+		error("type of table differs from type of array"); \
+		return -1; \
+		} \
+	\
+	const itype min = table->min; \
+	const itype max = table->max; \
+	size_t i; \
+	\
+	/*check the arguments*/ \
+	CHECK_ARGS(); \
+	\
+	if (table->full) \
+		return decode_##ctype##_uniform_unchecked(in_array, out_array, size, min, max); \
+	\
+	for (i = 0; i < size; i++) \
+		out_array[i] = table->values[in_array[i]]; \
+	return 0; \
+}
+
+extern int decode_uint8_uniform_table
+	DECODE_TABLE8(uint8_t, uint8, HD_UINT8)
+
+extern int decode_int8_uniform_table
+	DECODE_TABLE8(int8_t, int8, HD_INT8)
+
+#undef DECODE_TABLE8
+#undef CHECK_RANGE
+#undef CHECK_ARGS
+
+//range widening policy----------------------------------------------------------------------------
+
+#define WIDEN_RANGE(itype, utype, TYPE_MAX) \
+(itype *min, itype *max) \
+{ \
+	/*check the arguments*/ \
+	if ( (min == NULL) || (max == NULL) ) { \
+		error("min or max = NULL"); \
+		return -1; \
+		} \
+	if (*min > *max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	\
+	/*size of range minus 1 and number of values after min (same-width variables are compared, \
+	since 8 and 16-bit expressions are promoted to int)*/ \
+	utype span = (utype)*max - (utype)*min; \
+	const utype room = (utype)(TYPE_MAX) - (utype)*min; \
+	unsigned int shift; \
+	\
+	/*round it up to 2^k - 1 by setting all bits below the highest one*/ \
+	for (shift = 1; shift < 8*sizeof(utype); shift <<= 1) \
+		span |= span >> shift; \
+	\
+	/*keep min if it's possible, else move the range to the end of type*/ \
+	if (room >= span) \
+		*max = (utype)*min + span; \
+	else { \
+		*max = TYPE_MAX; \
+		*min = (utype)(TYPE_MAX) - span; \
+		} \
+	\
+	return 0; \
+}
+
+extern int widen_uint8_range
+	WIDEN_RANGE(uint8_t, uint8_t, UINT8_MAX)
+
+extern int widen_int8_range
+	WIDEN_RANGE(int8_t, uint8_t, INT8_MAX)
+
+extern int widen_uint16_range
+	WIDEN_RANGE(uint16_t, uint16_t, UINT16_MAX)
+
+extern int widen_int16_range
+	WIDEN_RANGE(int16_t, uint16_t, INT16_MAX)
+
+extern int widen_uint32_range
+	WIDEN_RANGE(uint32_t, uint32_t, UINT32_MAX)
+
+extern int widen_int32_range
+	WIDEN_RANGE(int32_t, uint32_t, INT32_MAX)
+
+extern int widen_uint64_range
+	WIDEN_RANGE(uint64_t, uint64_t, UINT64_MAX)
+
+extern int widen_int64_range
+	WIDEN_RANGE(int64_t, uint64_t, INT64_MAX)
+
+#undef WIDEN_RANGE
+
+//size of container element------------------------------------------------------------------------
+
+#define CONTAINER_UNIFORM(itype, OSIZE) \
+(const itype min, const itype max) \
+{ \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	\
+	return OSIZE; \
+}
+
+extern int container_uint8_uniform
+	CONTAINER_UNIFORM(uint8_t, sizeof(uint16_t))
+
+extern int container_int8_uniform
+	CONTAINER_UNIFORM(int8_t, sizeof(uint16_t))
+
+extern int container_uint16_uniform
+	CONTAINER_UNIFORM(uint16_t, sizeof(uint32_t))
+
+extern int container_int16_uniform
+	CONTAINER_UNIFORM(int16_t, sizeof(uint32_t))
+
+extern int container_uint32_uniform
+	CONTAINER_UNIFORM(uint32_t, sizeof(uint64_t))
+
+extern int container_int32_uniform
+	CONTAINER_UNIFORM(int32_t, sizeof(uint64_t))
+
+extern int container_uint64_uniform
+	CONTAINER_UNIFORM(uint64_t, 16)
+
+extern int container_int64_uniform
+	CONTAINER_UNIFORM(int64_t, 16)
+
+#ifdef HD_HAVE_INT128
+extern int container_uint128_uniform
+	CONTAINER_UNIFORM(hd_uint128_t, 32)
+
+extern int container_int128_uniform
+	CONTAINER_UNIFORM(hd_int128_t, 32)
+#endif
 
-#undef DECODE_IN_MPZ_UNIFORM
+#undef CONTAINER_UNIFORM
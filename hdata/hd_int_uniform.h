@@ -8,6 +8,10 @@ license: BSD 2-Clause
 
 #include "hd_common.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //DTE and DTD for unsigned and signed 8-, 16-, 32- and 64-bit integer arrays
 extern int encode_uint8_uniform(const uint8_t *in_array, uint16_t *out_array,
 	const size_t size, const uint8_t min, const uint8_t max);
@@ -49,4 +53,227 @@ extern int encode_int64_uniform(const int64_t *in_array, unsigned char *out_arra
 extern int decode_int64_uniform(const unsigned char *in_array, int64_t *out_array,
 	const size_t size, const int64_t min, const int64_t max);
 
+//128-bit integers are encoded in 32 bytes each
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform(const hd_uint128_t *in_array, unsigned char *out_array,
+	const size_t size, const hd_uint128_t min, const hd_uint128_t max);
+extern int decode_uint128_uniform(const unsigned char *in_array, hd_uint128_t *out_array,
+	const size_t size, const hd_uint128_t min, const hd_uint128_t max);
+
+extern int encode_int128_uniform(const hd_int128_t *in_array, unsigned char *out_array,
+	const size_t size, const hd_int128_t min, const hd_int128_t max);
+extern int decode_int128_uniform(const unsigned char *in_array, hd_int128_t *out_array,
+	const size_t size, const hd_int128_t min, const hd_int128_t max);
+#endif
+
+//DTE for the same arrays which takes random numbers from rand_array (of the same type and size as
+//out_array, can be out_array itself) instead of generating them
+extern int encode_uint8_uniform_rand(const uint8_t *in_array, uint16_t *out_array,
+	const uint16_t *rand_array, const size_t size, const uint8_t min, const uint8_t max);
+extern int encode_int8_uniform_rand(const int8_t *in_array, uint16_t *out_array,
+	const uint16_t *rand_array, const size_t size, const int8_t min, const int8_t max);
+
+extern int encode_uint16_uniform_rand(const uint16_t *in_array, uint32_t *out_array,
+	const uint32_t *rand_array, const size_t size, const uint16_t min, const uint16_t max);
+extern int encode_int16_uniform_rand(const int16_t *in_array, uint32_t *out_array,
+	const uint32_t *rand_array, const size_t size, const int16_t min, const int16_t max);
+
+extern int encode_uint32_uniform_rand(const uint32_t *in_array, uint64_t *out_array,
+	const uint64_t *rand_array, const size_t size, const uint32_t min, const uint32_t max);
+extern int encode_int32_uniform_rand(const int32_t *in_array, uint64_t *out_array,
+	const uint64_t *rand_array, const size_t size, const int32_t min, const int32_t max);
+
+extern int encode_uint64_uniform_rand(const uint64_t *in_array, unsigned char *out_array,
+	const unsigned char *rand_array, const size_t size, const uint64_t min, const uint64_t max);
+extern int encode_int64_uniform_rand(const int64_t *in_array, unsigned char *out_array,
+	const unsigned char *rand_array, const size_t size, const int64_t min, const int64_t max);
+
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform_rand(const hd_uint128_t *in_array, unsigned char *out_array,
+	const unsigned char *rand_array, const size_t size, const hd_uint128_t min,
+	const hd_uint128_t max);
+extern int encode_int128_uniform_rand(const hd_int128_t *in_array, unsigned char *out_array,
+	const unsigned char *rand_array, const size_t size, const hd_int128_t min,
+	const hd_int128_t max);
+#endif
+
+//unchecked DTE and DTD for trusted input: the arguments and the range of input array are not
+//checked, so they must be right (e.g. checked once by check_itype_range() for many calls).
+//functions above are wrappers around them which check everything
+extern int encode_uint8_uniform_unchecked(const uint8_t *in_array, uint16_t *out_array,
+	const size_t size, const uint8_t min, const uint8_t max);
+extern int decode_uint8_uniform_unchecked(const uint16_t *in_array, uint8_t *out_array,
+	const size_t size, const uint8_t min, const uint8_t max);
+extern int encode_int8_uniform_unchecked(const int8_t *in_array, uint16_t *out_array,
+	const size_t size, const int8_t min, const int8_t max);
+extern int decode_int8_uniform_unchecked(const uint16_t *in_array, int8_t *out_array,
+	const size_t size, const int8_t min, const int8_t max);
+
+extern int encode_uint16_uniform_unchecked(const uint16_t *in_array, uint32_t *out_array,
+	const size_t size, const uint16_t min, const uint16_t max);
+extern int decode_uint16_uniform_unchecked(const uint32_t *in_array, uint16_t *out_array,
+	const size_t size, const uint16_t min, const uint16_t max);
+extern int encode_int16_uniform_unchecked(const int16_t *in_array, uint32_t *out_array,
+	const size_t size, const int16_t min, const int16_t max);
+extern int decode_int16_uniform_unchecked(const uint32_t *in_array, int16_t *out_array,
+	const size_t size, const int16_t min, const int16_t max);
+
+extern int encode_uint32_uniform_unchecked(const uint32_t *in_array, uint64_t *out_array,
+	const size_t size, const uint32_t min, const uint32_t max);
+extern int decode_uint32_uniform_unchecked(const uint64_t *in_array, uint32_t *out_array,
+	const size_t size, const uint32_t min, const uint32_t max);
+extern int encode_int32_uniform_unchecked(const int32_t *in_array, uint64_t *out_array,
+	const size_t size, const int32_t min, const int32_t max);
+extern int decode_int32_uniform_unchecked(const uint64_t *in_array, int32_t *out_array,
+	const size_t size, const int32_t min, const int32_t max);
+
+extern int encode_uint64_uniform_unchecked(const uint64_t *in_array, unsigned char *out_array,
+	const size_t size, const uint64_t min, const uint64_t max);
+extern int decode_uint64_uniform_unchecked(const unsigned char *in_array, uint64_t *out_array,
+	const size_t size, const uint64_t min, const uint64_t max);
+extern int encode_int64_uniform_unchecked(const int64_t *in_array, unsigned char *out_array,
+	const size_t size, const int64_t min, const int64_t max);
+extern int decode_int64_uniform_unchecked(const unsigned char *in_array, int64_t *out_array,
+	const size_t size, const int64_t min, const int64_t max);
+
+#ifdef HD_HAVE_INT128
+extern int encode_uint128_uniform_unchecked(const hd_uint128_t *in_array, unsigned char *out_array,
+	const size_t size, const hd_uint128_t min, const hd_uint128_t max);
+extern int decode_uint128_uniform_unchecked(const unsigned char *in_array, hd_uint128_t *out_array,
+	const size_t size, const hd_uint128_t min, const hd_uint128_t max);
+extern int encode_int128_uniform_unchecked(const hd_int128_t *in_array, unsigned char *out_array,
+	const size_t size, const hd_int128_t min, const hd_int128_t max);
+extern int decode_int128_uniform_unchecked(const unsigned char *in_array, hd_int128_t *out_array,
+	const size_t size, const hd_int128_t min, const hd_int128_t max);
+#endif
+
+//DTD with aggregation: decode array by small blocks and add decoded elements to agg (see
+//aggregate_itype_array()) instead of writing them to output array
+extern int decode_uint8_uniform_aggregate(const uint16_t *in_array, const size_t size,
+	const uint8_t min, const uint8_t max, struct hd_uint8_aggregate *agg);
+extern int decode_int8_uniform_aggregate(const uint16_t *in_array, const size_t size,
+	const int8_t min, const int8_t max, struct hd_int8_aggregate *agg);
+extern int decode_uint16_uniform_aggregate(const uint32_t *in_array, const size_t size,
+	const uint16_t min, const uint16_t max, struct hd_uint16_aggregate *agg);
+extern int decode_int16_uniform_aggregate(const uint32_t *in_array, const size_t size,
+	const int16_t min, const int16_t max, struct hd_int16_aggregate *agg);
+extern int decode_uint32_uniform_aggregate(const uint64_t *in_array, const size_t size,
+	const uint32_t min, const uint32_t max, struct hd_uint32_aggregate *agg);
+extern int decode_int32_uniform_aggregate(const uint64_t *in_array, const size_t size,
+	const int32_t min, const int32_t max, struct hd_int32_aggregate *agg);
+extern int decode_uint64_uniform_aggregate(const unsigned char *in_array, const size_t size,
+	const uint64_t min, const uint64_t max, struct hd_uint64_aggregate *agg);
+extern int decode_int64_uniform_aggregate(const unsigned char *in_array, const size_t size,
+	const int64_t min, const int64_t max, struct hd_int64_aggregate *agg);
+
+//DTD with selection: decode array by small blocks and write indices of decoded elements from
+//[lo; hi] to selection and the elements themselves to values (if it's not NULL), see
+//select_itype_range(); selection and values must have space for size elements
+extern int decode_uint8_uniform_select(const uint16_t *in_array, const size_t size,
+	const uint8_t min, const uint8_t max, const uint8_t lo, const uint8_t hi, size_t *selection,
+	uint8_t *values, size_t *count);
+extern int decode_int8_uniform_select(const uint16_t *in_array, const size_t size,
+	const int8_t min, const int8_t max, const int8_t lo, const int8_t hi, size_t *selection,
+	int8_t *values, size_t *count);
+extern int decode_uint16_uniform_select(const uint32_t *in_array, const size_t size,
+	const uint16_t min, const uint16_t max, const uint16_t lo, const uint16_t hi, size_t *selection,
+	uint16_t *values, size_t *count);
+extern int decode_int16_uniform_select(const uint32_t *in_array, const size_t size,
+	const int16_t min, const int16_t max, const int16_t lo, const int16_t hi, size_t *selection,
+	int16_t *values, size_t *count);
+extern int decode_uint32_uniform_select(const uint64_t *in_array, const size_t size,
+	const uint32_t min, const uint32_t max, const uint32_t lo, const uint32_t hi, size_t *selection,
+	uint32_t *values, size_t *count);
+extern int decode_int32_uniform_select(const uint64_t *in_array, const size_t size,
+	const int32_t min, const int32_t max, const int32_t lo, const int32_t hi, size_t *selection,
+	int32_t *values, size_t *count);
+extern int decode_uint64_uniform_select(const unsigned char *in_array, const size_t size,
+	const uint64_t min, const uint64_t max, const uint64_t lo, const uint64_t hi, size_t *selection,
+	uint64_t *values, size_t *count);
+extern int decode_int64_uniform_select(const unsigned char *in_array, const size_t size,
+	const int64_t min, const int64_t max, const int64_t lo, const int64_t hi, size_t *selection,
+	int64_t *values, size_t *count);
+
+//sampling of decoys: write to out_array elements which are distributed exactly as decoded random
+//container elements, i.e. as results of decoding with a wrong key. it's faster than decoding of
+//random array, because random containers are generated by OpenSSL random generator and decoded by
+//small blocks. several decoy arrays of the same range can be sampled at once as one big array.
+//there are no threads in library, but different parts of out_array can be sampled by several
+//threads at once: functions have no shared state, and OpenSSL generator is thread-safe
+extern int sample_uint8_uniform(uint8_t *out_array, const size_t size, const uint8_t min,
+	const uint8_t max);
+extern int sample_int8_uniform(int8_t *out_array, const size_t size, const int8_t min,
+	const int8_t max);
+extern int sample_uint16_uniform(uint16_t *out_array, const size_t size, const uint16_t min,
+	const uint16_t max);
+extern int sample_int16_uniform(int16_t *out_array, const size_t size, const int16_t min,
+	const int16_t max);
+extern int sample_uint32_uniform(uint32_t *out_array, const size_t size, const uint32_t min,
+	const uint32_t max);
+extern int sample_int32_uniform(int32_t *out_array, const size_t size, const int32_t min,
+	const int32_t max);
+extern int sample_uint64_uniform(uint64_t *out_array, const size_t size, const uint64_t min,
+	const uint64_t max);
+extern int sample_int64_uniform(int64_t *out_array, const size_t size, const int64_t min,
+	const int64_t max);
+#ifdef HD_HAVE_INT128
+extern int sample_uint128_uniform(hd_uint128_t *out_array, const size_t size,
+	const hd_uint128_t min, const hd_uint128_t max);
+extern int sample_int128_uniform(hd_int128_t *out_array, const size_t size, const hd_int128_t min,
+	const hd_int128_t max);
+#endif
+
+//table-driven DTE and DTD for 8-bit integers: tables for range [min; max] are created once (they
+//take about 320 KB) and can be used for many arrays. encoded arrays are the same as ones of
+//encode_itype_uniform(), so they can be decoded by either function. table remembers its type, and
+//functions for the other 8-bit type reject it.
+struct hd_table8;
+
+extern struct hd_table8 *create_uint8_uniform_table(const uint8_t min, const uint8_t max);
+extern struct hd_table8 *create_int8_uniform_table(const int8_t min, const int8_t max);
+extern void free_uniform_table(struct hd_table8 *table);
+
+extern int encode_uint8_uniform_table(const struct hd_table8 *table, const uint8_t *in_array,
+	uint16_t *out_array, const size_t size);
+extern int decode_uint8_uniform_table(const struct hd_table8 *table, const uint16_t *in_array,
+	uint8_t *out_array, const size_t size);
+
+extern int encode_int8_uniform_table(const struct hd_table8 *table, const int8_t *in_array,
+	uint16_t *out_array, const size_t size);
+extern int decode_int8_uniform_table(const struct hd_table8 *table, const uint16_t *in_array,
+	int8_t *out_array, const size_t size);
+
+//range widening policy: replace [min; max] with the smallest range which contains it, has
+//power-of-two size and fits in the type. such ranges are encoded and decoded by shifts and masks
+//instead of divisions, but decoys can contain values outside of original range, so use it only if
+//schema allows them. the same widened range must be used for encoding and decoding.
+extern int widen_uint8_range(uint8_t *min, uint8_t *max);
+extern int widen_int8_range(int8_t *min, int8_t *max);
+extern int widen_uint16_range(uint16_t *min, uint16_t *max);
+extern int widen_int16_range(int16_t *min, int16_t *max);
+extern int widen_uint32_range(uint32_t *min, uint32_t *max);
+extern int widen_int32_range(int32_t *min, int32_t *max);
+extern int widen_uint64_range(uint64_t *min, uint64_t *max);
+extern int widen_int64_range(int64_t *min, int64_t *max);
+
+//size of container element in bytes for range [min; max] or -1 on error. container of size
+//elements takes size*container_itype_uniform() bytes; functions above write it to caller's memory
+//and never allocate memory.
+extern int container_uint8_uniform(const uint8_t min, const uint8_t max);
+extern int container_int8_uniform(const int8_t min, const int8_t max);
+extern int container_uint16_uniform(const uint16_t min, const uint16_t max);
+extern int container_int16_uniform(const int16_t min, const int16_t max);
+extern int container_uint32_uniform(const uint32_t min, const uint32_t max);
+extern int container_int32_uniform(const int32_t min, const int32_t max);
+extern int container_uint64_uniform(const uint64_t min, const uint64_t max);
+extern int container_int64_uniform(const int64_t min, const int64_t max);
+#ifdef HD_HAVE_INT128
+extern int container_uint128_uniform(const hd_uint128_t min, const hd_uint128_t max);
+extern int container_int128_uniform(const hd_int128_t min, const hd_int128_t max);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
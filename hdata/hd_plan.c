@@ -0,0 +1,925 @@
+/*
+column plans for encoding and decoding of record batches
+license: BSD 2-Clause
+*/
+
+#include "hd_plan.h"
+
+//parameters in following generic functions:
+//itype - type of input elements
+//otype - type of container elements
+//ctype - name of itype in function names (e.g. uint8 for uint8_t)
+//ctype_t - type of intermediate elements for arbitrary distribution
+//TYPE - value of enum hd_type for itype
+//TYPE_MIN, TYPE_MAX - minimum and maximum possible values of itype
+//OSIZE - size of container element in bytes
+
+//description of one column
+struct hd_column {
+	enum hd_type type;		//type of input elements
+	uint64_t min, max;		//minimum and maximum values (signed ones are sign-extended)
+	size_t isize;			//size of input element in bytes
+	size_t osize;			//size of container element in bytes
+	/*size of intermediate element in bytes for arbitrary distribution, 0 for uniform one.
+	intermediate values are uniformly distributed in [0; cumuls[wsize-1]] and then encoded to
+	container elements.*/
+	size_t csize;
+	/*true if every value of input (intermediate) type is possible, then container consists of copy
+	of input (intermediate) array followed by random numbers*/
+	bool full;
+	uint64_t *cumuls;		//cumulative weights, NULL for uniform distribution
+	size_t wsize;			//size of cumuls array
+	size_t rsize;			//number of random bytes needed for each row
+};
+
+struct hd_plan {
+	struct hd_column *columns;
+	size_t colnum;
+	size_t rsize;				//number of random bytes needed for each row of all columns
+	bool widen;					//true if ranges of new uniform columns are widened
+	unsigned char *rand_buf;	//random numbers for all columns of current block
+	//intermediate values of current column of current block (at most 4 bytes each)
+	uint32_t temp_buf[HD_PLAN_BLOCK];
+};
+
+/*random numbers of each column begin at offset which is multiple of this number of rows, so they
+are properly aligned for any container type*/
+#define ROWS_ALIGN 16
+
+//create an empty plan and free it with all its columns--------------------------------------------
+
+extern struct hd_plan *create_plan(void)
+{
+	struct hd_plan *plan;
+
+	if ( (plan = calloc(1, sizeof(struct hd_plan))) == NULL ) {
+		error("couldn't allocate memory for plan");
+		return NULL;
+		}
+	return plan;
+}
+
+extern void free_plan(struct hd_plan *plan)
+{
+	size_t i;
+
+	if (plan == NULL)
+		return;
+	for (i = 0; i < plan->colnum; i++)
+		free(plan->columns[i].cumuls);
+	free(plan->columns);
+	free(plan->rand_buf);
+	free(plan);
+}
+
+extern int set_plan_widening(struct hd_plan *plan, const bool widen)
+{
+	if (plan == NULL) {
+		error("plan = NULL");
+		return -1;
+		}
+	plan->widen = widen;
+	return 0;
+}
+
+//add column to plan and grow plan's buffer for random numbers, return index of column
+static int add_column(struct hd_plan *plan, const struct hd_column *column)
+{
+	struct hd_column *columns;
+	unsigned char *rand_buf;
+
+	if (plan->colnum >= INT32_MAX) {
+		error("too many columns");
+		return -1;
+		}
+
+	if ( (columns = realloc(plan->columns, (plan->colnum+1)*sizeof(struct hd_column))) == NULL ) {
+		error("couldn't allocate memory for columns");
+		return -1;
+		}
+	plan->columns = columns;
+
+	if ( (rand_buf = realloc(plan->rand_buf, HD_PLAN_BLOCK*(plan->rsize + column->rsize))) ==
+		NULL ) {
+		error("couldn't allocate memory for rand_buf");
+		return -1;
+		}
+	plan->rand_buf = rand_buf;
+
+	plan->columns[plan->colnum] = *column;
+	plan->rsize += column->rsize;
+	return plan->colnum++;
+}
+
+extern struct hd_plan *copy_plan(const struct hd_plan *plan)
+{
+	struct hd_plan *copy;
+	struct hd_column column;
+	size_t i;
+
+	if (plan == NULL) {
+		error("plan = NULL");
+		return NULL;
+		}
+	if ( (copy = create_plan()) == NULL )
+		return NULL;
+	copy->widen = plan->widen;
+
+	//columns are added one by one, so free_plan() frees everything on error
+	for (i = 0; i < plan->colnum; i++) {
+		column = plan->columns[i];
+		if (column.cumuls != NULL) {
+			if ( (column.cumuls = malloc(column.wsize*sizeof(uint64_t))) == NULL ) {
+				error("couldn't allocate memory for cumuls");
+				free_plan(copy);
+				return NULL;
+				}
+			memcpy(column.cumuls, plan->columns[i].cumuls, column.wsize*sizeof(uint64_t));
+			}
+		if (add_column(copy, &column) < 0) {
+			free(column.cumuls);
+			free_plan(copy);
+			return NULL;
+			}
+		}
+
+	return copy;
+}
+
+//generic functions for adding columns-------------------------------------------------------------
+
+#define ADD_UNIFORM_COLUMN(itype, ctype, TYPE, TYPE_MIN, TYPE_MAX, OSIZE) \
+(struct hd_plan *plan, itype min, itype max) \
+{ \
+	/*check the arguments*/ \
+	if (plan == NULL) { \
+		error("plan = NULL"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	\
+	struct hd_column column; \
+	\
+	if (plan->widen) \
+		widen_##ctype##_range(&min, &max); \
+	\
+	memset(&column, 0, sizeof(column)); \
+	column.type = TYPE; \
+	column.min = min; \
+	column.max = max; \
+	column.isize = sizeof(itype); \
+	column.osize = OSIZE; \
+	column.full = (min == TYPE_MIN) && (max == TYPE_MAX); \
+	column.rsize = OSIZE; \
+	\
+	return add_column(plan, &column); \
+}
+
+extern int add_uint8_uniform_column
+	ADD_UNIFORM_COLUMN(uint8_t, uint8, HD_UINT8, 0, UINT8_MAX, 2)
+
+extern int add_int8_uniform_column
+	ADD_UNIFORM_COLUMN(int8_t, int8, HD_INT8, INT8_MIN, INT8_MAX, 2)
+
+extern int add_uint16_uniform_column
+	ADD_UNIFORM_COLUMN(uint16_t, uint16, HD_UINT16, 0, UINT16_MAX, 4)
+
+extern int add_int16_uniform_column
+	ADD_UNIFORM_COLUMN(int16_t, int16, HD_INT16, INT16_MIN, INT16_MAX, 4)
+
+extern int add_uint32_uniform_column
+	ADD_UNIFORM_COLUMN(uint32_t, uint32, HD_UINT32, 0, UINT32_MAX, 8)
+
+extern int add_int32_uniform_column
+	ADD_UNIFORM_COLUMN(int32_t, int32, HD_INT32, INT32_MIN, INT32_MAX, 8)
+
+extern int add_uint64_uniform_column
+	ADD_UNIFORM_COLUMN(uint64_t, uint64, HD_UINT64, 0, UINT64_MAX, 16)
+
+extern int add_int64_uniform_column
+	ADD_UNIFORM_COLUMN(int64_t, int64, HD_INT64, INT64_MIN, INT64_MAX, 16)
+
+#undef ADD_UNIFORM_COLUMN
+
+#define ADD_ARBITRARY_COLUMN(itype, TYPE) \
+(struct hd_plan *plan, const itype min, const itype max, const uint32_t *weights) \
+{ \
+	/*check the arguments*/ \
+	if (plan == NULL) { \
+		error("plan = NULL"); \
+		return -1; \
+		} \
+	if (min > max) { \
+		error("min > max"); \
+		return -1; \
+		} \
+	if (weights == NULL) { \
+		error("weights = NULL"); \
+		return -1; \
+		} \
+	\
+	struct hd_column column; \
+	/*current and previous cumulative weights*/ \
+	uint64_t current, prev; \
+	uint64_t wsize_check; \
+	size_t i; \
+	int rv; \
+	\
+	memset(&column, 0, sizeof(column)); \
+	column.type = TYPE; \
+	column.min = min; \
+	column.max = max; \
+	column.isize = sizeof(itype); \
+	\
+	/*get size of weights and cumuls arrays. it is 0 after an overflow if every value of 64-bit \
+	type is possible, and it can be too big for size_t type.*/ \
+	wsize_check = (uint64_t)max - (uint64_t)min + 1; \
+	column.wsize = wsize_check; \
+	if ( (wsize_check == 0) || (column.wsize != wsize_check) ) { \
+		error("can't handle such big supplementary arrays"); \
+		return -1; \
+		} \
+	\
+	if ( (column.cumuls = malloc(column.wsize*sizeof(uint64_t))) == NULL ) { \
+		error("couldn't allocate memory for cumuls"); \
+		return -1; \
+		} \
+	\
+	/*convert weights to cumulative weights: cumuls[i] = sum of weights[j], where j = 0..i*/ \
+	current = 0; \
+	for (i = 0; i < column.wsize; i++) { \
+		prev = current; \
+		current += weights[i]; \
+		if (current < prev) { \
+			error("integer overflow during cumuls computation"); \
+			free(column.cumuls); \
+			return -1; \
+			} \
+		column.cumuls[i] = current; \
+		} \
+	\
+	/*choose intermediate and container types by maximum cumulative weight value*/ \
+	if (current == 0) { \
+		error("all weights are 0"); \
+		free(column.cumuls); \
+		return -1; \
+		} \
+	else if (current < 256)			/*2^8*/ \
+		column.csize = 1; \
+	else if (current < 65536)		/*2^16*/ \
+		column.csize = 2; \
+	else if (current < 4294967296)	/*2^32*/ \
+		column.csize = 4; \
+	else { \
+		error("too many values for any supported output type"); \
+		free(column.cumuls); \
+		return -1; \
+		} \
+	column.osize = 2*column.csize; \
+	/*intermediate values are in [0; current], so every value is possible if current is the \
+	maximum value of intermediate type*/ \
+	column.full = ( current == (UINT64_MAX >> (64 - 8*column.csize)) ); \
+	/*random numbers for intermediate values and for their encoding*/ \
+	column.rsize = 2*column.osize; \
+	\
+	if ( (rv = add_column(plan, &column)) < 0 ) \
+		free(column.cumuls); \
+	return rv; \
+}
+
+extern int add_uint8_arbitrary_column
+	ADD_ARBITRARY_COLUMN(uint8_t, HD_UINT8)
+
+extern int add_int8_arbitrary_column
+	ADD_ARBITRARY_COLUMN(int8_t, HD_INT8)
+
+extern int add_uint16_arbitrary_column
+	ADD_ARBITRARY_COLUMN(uint16_t, HD_UINT16)
+
+extern int add_int16_arbitrary_column
+	ADD_ARBITRARY_COLUMN(int16_t, HD_INT16)
+
+extern int add_uint32_arbitrary_column
+	ADD_ARBITRARY_COLUMN(uint32_t, HD_UINT32)
+
+extern int add_int32_arbitrary_column
+	ADD_ARBITRARY_COLUMN(int32_t, HD_INT32)
+
+extern int add_uint64_arbitrary_column
+	ADD_ARBITRARY_COLUMN(uint64_t, HD_UINT64)
+
+extern int add_int64_arbitrary_column
+	ADD_ARBITRARY_COLUMN(int64_t, HD_INT64)
+
+#undef ADD_ARBITRARY_COLUMN
+
+extern int plan_container_size(const struct hd_plan *plan, const size_t column)
+{
+	//check the arguments
+	if (plan == NULL) {
+		error("plan = NULL");
+		return -1;
+		}
+	if (column >= plan->colnum) {
+		error("column >= number of columns");
+		return -1;
+		}
+
+	return plan->columns[column].osize;
+}
+
+//generic functions for conversion between arbitrary and intermediate values-----------------------
+
+//check that elements of input array are in range and have nonzero weights
+#define CHECK_ARBITRARY(itype, ctype) \
+(const struct hd_column *column, const itype *in_array, const size_t size) \
+{ \
+	const itype min = column->min, max = column->max; \
+	/*index and cumulative weight of previous element*/ \
+	size_t index; \
+	uint64_t cumul_prev; \
+	/*description of wrong element of input array*/ \
+	struct hd_error err; \
+	size_t i; \
+	\
+	if (check_##ctype##_range(in_array, size, min, max, &err)) { \
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" ); \
+		return -1; \
+		} \
+	\
+	for (i = 0; i < size; i++) { \
+		index = (uint64_t)in_array[i] - (uint64_t)min; \
+		cumul_prev = (index == 0) ? 0 : column->cumuls[index-1]; \
+		if (column->cumuls[index] == cumul_prev) { \
+			error("value in array is impossible according to cumuls"); \
+			return -1; \
+			} \
+		} \
+	\
+	return 0; \
+}
+
+static int check_uint8_arbitrary
+	CHECK_ARBITRARY(uint8_t, uint8)
+
+static int check_int8_arbitrary
+	CHECK_ARBITRARY(int8_t, int8)
+
+static int check_uint16_arbitrary
+	CHECK_ARBITRARY(uint16_t, uint16)
+
+static int check_int16_arbitrary
+	CHECK_ARBITRARY(int16_t, int16)
+
+static int check_uint32_arbitrary
+	CHECK_ARBITRARY(uint32_t, uint32)
+
+static int check_int32_arbitrary
+	CHECK_ARBITRARY(int32_t, int32)
+
+static int check_uint64_arbitrary
+	CHECK_ARBITRARY(uint64_t, uint64)
+
+static int check_int64_arbitrary
+	CHECK_ARBITRARY(int64_t, int64)
+
+#undef CHECK_ARBITRARY
+
+//each intermediate value is pseudorandom value in [cumuls[index-1]; cumuls[index]-1]
+#define MAP_IN_TYPE_ARBITRARY(ctype_t, otype) \
+do { \
+	ctype_t *temp = temp_array; \
+	const otype *rand = (const otype *)rand_array; \
+	\
+	for (i = 0; i < size; i++) { \
+		index = (uint64_t)in_array[i] - (uint64_t)min; \
+		\
+		if (index == 0) \
+			cumul_prev = 0; \
+		else \
+			cumul_prev = column->cumuls[index-1]; \
+		/*weight is the difference between two consecutive cumulative weights*/ \
+		weight = column->cumuls[index] - cumul_prev; \
+		\
+		temp[i] = (rand[i] % weight) + cumul_prev; \
+		} \
+} while (0)
+
+//elements of input array must be checked by check_itype_arbitrary()
+#define MAP_ARBITRARY(itype, ctype) \
+(const struct hd_column *column, const itype *in_array, void *temp_array, \
+const unsigned char *rand_array, const size_t size) \
+{ \
+	const itype min = column->min; \
+	/*index, weight and cumulative weight of previous element*/ \
+	size_t index; \
+	uint64_t weight, cumul_prev; \
+	size_t i; \
+	\
+	if (column->csize == 1) \
+		MAP_IN_TYPE_ARBITRARY(uint8_t, uint16_t); \
+	else if (column->csize == 2) \
+		MAP_IN_TYPE_ARBITRARY(uint16_t, uint32_t); \
+	else \
+		MAP_IN_TYPE_ARBITRARY(uint32_t, uint64_t); \
+	\
+	return 0; \
+}
+
+static int map_uint8_arbitrary
+	MAP_ARBITRARY(uint8_t, uint8)
+
+static int map_int8_arbitrary
+	MAP_ARBITRARY(int8_t, int8)
+
+static int map_uint16_arbitrary
+	MAP_ARBITRARY(uint16_t, uint16)
+
+static int map_int16_arbitrary
+	MAP_ARBITRARY(int16_t, int16)
+
+static int map_uint32_arbitrary
+	MAP_ARBITRARY(uint32_t, uint32)
+
+static int map_int32_arbitrary
+	MAP_ARBITRARY(int32_t, int32)
+
+static int map_uint64_arbitrary
+	MAP_ARBITRARY(uint64_t, uint64)
+
+static int map_int64_arbitrary
+	MAP_ARBITRARY(int64_t, int64)
+
+#undef MAP_ARBITRARY
+#undef MAP_IN_TYPE_ARBITRARY
+
+//find the first cumulative weight which is bigger than intermediate value by binary search
+#define UNMAP_IN_TYPE_ARBITRARY(ctype_t) \
+do { \
+	const ctype_t *temp = temp_array; \
+	\
+	for (i = 0; i < size; i++) { \
+		low = 0; \
+		high = column->wsize; \
+		while (low < high) { \
+			middle = low + (high - low)/2; \
+			if (temp[i] < column->cumuls[middle]) \
+				high = middle; \
+			else \
+				low = middle + 1; \
+			} \
+		\
+		if (low == column->wsize) { \
+			error("can't find corresponding cumuls element"); \
+			return -1; \
+			} \
+		\
+		out_array[i] = low + min; \
+		} \
+} while (0)
+
+#define UNMAP_ARBITRARY(itype) \
+(const struct hd_column *column, const void *temp_array, itype *out_array, const size_t size) \
+{ \
+	const itype min = column->min; \
+	/*bounds of binary search*/ \
+	size_t low, middle, high; \
+	size_t i; \
+	\
+	if (column->csize == 1) \
+		UNMAP_IN_TYPE_ARBITRARY(uint8_t); \
+	else if (column->csize == 2) \
+		UNMAP_IN_TYPE_ARBITRARY(uint16_t); \
+	else \
+		UNMAP_IN_TYPE_ARBITRARY(uint32_t); \
+	\
+	return 0; \
+}
+
+static int unmap_uint8_arbitrary
+	UNMAP_ARBITRARY(uint8_t)
+
+static int unmap_int8_arbitrary
+	UNMAP_ARBITRARY(int8_t)
+
+static int unmap_uint16_arbitrary
+	UNMAP_ARBITRARY(uint16_t)
+
+static int unmap_int16_arbitrary
+	UNMAP_ARBITRARY(int16_t)
+
+static int unmap_uint32_arbitrary
+	UNMAP_ARBITRARY(uint32_t)
+
+static int unmap_int32_arbitrary
+	UNMAP_ARBITRARY(int32_t)
+
+static int unmap_uint64_arbitrary
+	UNMAP_ARBITRARY(uint64_t)
+
+static int unmap_int64_arbitrary
+	UNMAP_ARBITRARY(int64_t)
+
+#undef UNMAP_ARBITRARY
+#undef UNMAP_IN_TYPE_ARBITRARY
+
+//encoding and decoding of one block of one column-------------------------------------------------
+
+/*if every value is possible then container array consists of copy of input array followed by random
+numbers, so rows [start; start+n-1] of size rows are placed in two separate parts of it*/
+static void encode_full_block(const unsigned char *in_block, unsigned char *out_array,
+	const unsigned char *rand_block, const size_t isize, const size_t osize, const size_t start,
+	const size_t n, const size_t size)
+{
+	memcpy(out_array + start*isize, in_block, n*isize);
+	memcpy(out_array + size*isize + start*(osize-isize), rand_block, n*(osize-isize));
+}
+
+#define CALL_WITH_TYPE(FUNCTION, ...) \
+do { \
+	switch (column->type) { \
+		case HD_UINT8: \
+			rv = FUNCTION(uint8_t, uint8, uint16_t, __VA_ARGS__); \
+			break; \
+		case HD_INT8: \
+			rv = FUNCTION(int8_t, int8, uint16_t, __VA_ARGS__); \
+			break; \
+		case HD_UINT16: \
+			rv = FUNCTION(uint16_t, uint16, uint32_t, __VA_ARGS__); \
+			break; \
+		case HD_INT16: \
+			rv = FUNCTION(int16_t, int16, uint32_t, __VA_ARGS__); \
+			break; \
+		case HD_UINT32: \
+			rv = FUNCTION(uint32_t, uint32, uint64_t, __VA_ARGS__); \
+			break; \
+		case HD_INT32: \
+			rv = FUNCTION(int32_t, int32, uint64_t, __VA_ARGS__); \
+			break; \
+		case HD_UINT64: \
+			rv = FUNCTION(uint64_t, uint64, unsigned char, __VA_ARGS__); \
+			break; \
+		case HD_INT64: \
+			rv = FUNCTION(int64_t, int64, unsigned char, __VA_ARGS__); \
+			break; \
+		default: \
+			error("unknown column type"); \
+			rv = -1; \
+		} \
+} while (0)
+
+#define CALL_WITH_CTYPE(FUNCTION, ...) \
+do { \
+	if (column->csize == 1) \
+		rv = FUNCTION(uint8_t, uint8, uint16_t, __VA_ARGS__); \
+	else if (column->csize == 2) \
+		rv = FUNCTION(uint16_t, uint16, uint32_t, __VA_ARGS__); \
+	else \
+		rv = FUNCTION(uint32_t, uint32, uint64_t, __VA_ARGS__); \
+} while (0)
+
+#define ENCODE_UNIFORM_BLOCK(itype, ctype, otype, in_block, min, max) \
+	encode_##ctype##_uniform_rand( (const itype *)(in_block), \
+		(otype *)( (unsigned char *)out_array + start*column->osize ), \
+		(const otype *)rand_block, n, min, max)
+
+#define CHECK_ARBITRARY_BLOCK(itype, ctype, otype, unused) \
+	check_##ctype##_arbitrary(column, (const itype *)in_array + start, n)
+
+#define CHECK_UNIFORM_BLOCK(itype, ctype, otype, unused) \
+	check_##ctype##_range( (const itype *)in_array + start, n, column->min, column->max, &err)
+
+#define MAP_ARBITRARY_BLOCK(itype, ctype, otype, unused) \
+	map_##ctype##_arbitrary(column, (const itype *)in_array + start, plan->temp_buf, rand_block, n)
+
+//columns are checked when they are added to plan, so unchecked DTD is used
+#define DECODE_UNIFORM_BLOCK(itype, ctype, otype, out_block, min, max) \
+	decode_##ctype##_uniform_unchecked( \
+		(const otype *)( (const unsigned char *)in_array + start*column->osize ), \
+		(itype *)(out_block), n, min, max)
+
+#define UNMAP_ARBITRARY_BLOCK(itype, ctype, otype, unused) \
+	unmap_##ctype##_arbitrary(column, plan->temp_buf, (itype *)out_block, n)
+
+//check rows [start; start+n-1] of column before anything is written to encoded columns
+static int check_block(const struct hd_column *column, const void *in_array, const size_t start,
+	const size_t n)
+{
+	//description of wrong element of input array
+	struct hd_error err;
+	int rv;
+
+	//every value is possible
+	if ( (column->cumuls == NULL) && column->full )
+		return 0;
+
+	if (column->cumuls != NULL) {
+		CALL_WITH_TYPE(CHECK_ARBITRARY_BLOCK, 0);
+		return rv;
+		}
+	CALL_WITH_TYPE(CHECK_UNIFORM_BLOCK, 0);
+	if (rv)
+		error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" );
+	return rv;
+}
+
+//rand_block contains n_aligned*rsize random bytes for this column
+static int encode_block(struct hd_plan *plan, const struct hd_column *column,
+	const void *in_array, void *out_array, const unsigned char *rand_block, const size_t start,
+	const size_t n, const size_t n_aligned, const size_t size)
+{
+	int rv;
+
+	//uniform distribution
+	if (column->cumuls == NULL) {
+		if (column->full) {
+			encode_full_block( (const unsigned char *)in_array + start*column->isize, out_array,
+				rand_block, column->isize, column->osize, start, n, size);
+			return 0;
+			}
+		CALL_WITH_TYPE(ENCODE_UNIFORM_BLOCK,
+			(const unsigned char *)in_array + start*column->isize, column->min, column->max);
+		return rv;
+		}
+
+	//arbitrary distribution: get intermediate values using first half of random numbers
+	CALL_WITH_TYPE(MAP_ARBITRARY_BLOCK, 0);
+	if (rv)
+		return rv;
+
+	//then encode them using second half
+	rand_block += n_aligned*column->osize;
+	if (column->full) {
+		encode_full_block( (const unsigned char *)plan->temp_buf, out_array, rand_block,
+			column->csize, column->osize, start, n, size);
+		return 0;
+		}
+	CALL_WITH_CTYPE(ENCODE_UNIFORM_BLOCK, plan->temp_buf, 0, column->cumuls[column->wsize-1]);
+	return rv;
+}
+
+//out_block is output for rows [start; start+n-1] only
+static int decode_block(struct hd_plan *plan, const struct hd_column *column,
+	const void *in_array, void *out_block, const size_t start, const size_t n)
+{
+	int rv;
+
+	//uniform distribution
+	if (column->cumuls == NULL) {
+		//if every value is possible then just copy first part of input array to output array
+		if (column->full) {
+			memcpy(out_block, (const unsigned char *)in_array + start*column->isize,
+				n*column->isize);
+			return 0;
+			}
+		CALL_WITH_TYPE(DECODE_UNIFORM_BLOCK, out_block, column->min, column->max);
+		return rv;
+		}
+
+	//arbitrary distribution: firstly decode uniformly distributed intermediate values
+	if (column->full)
+		memcpy(plan->temp_buf, (const unsigned char *)in_array + start*column->csize,
+			n*column->csize);
+	else {
+		CALL_WITH_CTYPE(DECODE_UNIFORM_BLOCK, plan->temp_buf, 0, column->cumuls[column->wsize-1]);
+		if (rv)
+			return rv;
+		}
+
+	//then find corresponding values
+	CALL_WITH_TYPE(UNMAP_ARBITRARY_BLOCK, 0);
+	return rv;
+}
+
+#undef UNMAP_ARBITRARY_BLOCK
+#undef DECODE_UNIFORM_BLOCK
+#undef MAP_ARBITRARY_BLOCK
+#undef CHECK_UNIFORM_BLOCK
+#undef CHECK_ARBITRARY_BLOCK
+#undef ENCODE_UNIFORM_BLOCK
+#undef CALL_WITH_CTYPE
+#undef CALL_WITH_TYPE
+
+//DTE and DTD for record batch---------------------------------------------------------------------
+
+//check the arguments of DTE and DTD for rows [start; start+n-1] of record batch of size rows
+static int check_plan_args(const struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size, const size_t start, const size_t n)
+{
+	size_t j;
+
+	if (plan == NULL) {
+		error("plan = NULL");
+		return -1;
+		}
+	if (in_columns == NULL) {
+		error("in_columns = NULL");
+		return -1;
+		}
+	if (out_columns == NULL) {
+		error("out_columns = NULL");
+		return -1;
+		}
+	if (n == 0) {
+		error("size = 0");
+		return -1;
+		}
+	if ( (start > size) || (n > size - start) ) {
+		error("rows are out of record batch");
+		return -1;
+		}
+	if (plan->colnum == 0) {
+		error("plan has no columns");
+		return -1;
+		}
+	for (j = 0; j < plan->colnum; j++) {
+		if (in_columns[j] == NULL) {
+			error("in_columns[j] = NULL");
+			return -1;
+			}
+		if (out_columns[j] == NULL) {
+			error("out_columns[j] = NULL");
+			return -1;
+			}
+		}
+
+	return 0;
+}
+
+extern int encode_plan_rows(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size, const size_t start, const size_t n)
+{
+	//check the arguments
+	if (check_plan_args(plan, in_columns, out_columns, size, start, n))
+		return -1;
+
+	//first row and number of rows in current block, the latter rounded up to ROWS_ALIGN
+	size_t block_start, block_n, n_aligned;
+	//random numbers for current column of current block
+	unsigned char *rand_block;
+	size_t j;
+
+	//all rows of all columns are checked before anything is written to encoded columns
+	for (j = 0; j < plan->colnum; j++)
+		if (check_block(plan->columns + j, in_columns[j], start, n))
+			return -1;
+
+	for (block_start = start; block_start < start + n; block_start += block_n) {
+		block_n = start + n - block_start;
+		if (block_n > HD_PLAN_BLOCK)
+			block_n = HD_PLAN_BLOCK;
+		n_aligned = (block_n + ROWS_ALIGN - 1) / ROWS_ALIGN * ROWS_ALIGN;
+
+		//get random numbers for all columns of this block at once
+		randombytes(plan->rand_buf, n_aligned*plan->rsize);
+
+		rand_block = plan->rand_buf;
+		for (j = 0; j < plan->colnum; j++) {
+			if (encode_block(plan, plan->columns + j, in_columns[j], out_columns[j], rand_block,
+				block_start, block_n, n_aligned, size))
+				return -1;
+			rand_block += n_aligned*plan->columns[j].rsize;
+			}
+		}
+
+	return 0;
+}
+
+extern int decode_plan_rows(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size, const size_t start, const size_t n)
+{
+	//check the arguments
+	if (check_plan_args(plan, in_columns, out_columns, size, start, n))
+		return -1;
+
+	//first row and number of rows in current block
+	size_t block_start, block_n;
+	size_t j;
+
+	for (block_start = start; block_start < start + n; block_start += block_n) {
+		block_n = start + n - block_start;
+		if (block_n > HD_PLAN_BLOCK)
+			block_n = HD_PLAN_BLOCK;
+
+		for (j = 0; j < plan->colnum; j++)
+			if (decode_block(plan, plan->columns + j, in_columns[j],
+				(unsigned char *)out_columns[j] + block_start*plan->columns[j].isize, block_start,
+				block_n))
+				return -1;
+		}
+
+	return 0;
+}
+
+extern int encode_plan(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size)
+{
+	return encode_plan_rows(plan, in_columns, out_columns, size, 0, size);
+}
+
+extern int decode_plan(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size)
+{
+	return decode_plan_rows(plan, in_columns, out_columns, size, 0, size);
+}
+
+//lazy decoding of one column----------------------------------------------------------------------
+
+struct hd_cursor {
+	struct hd_plan *plan;
+	//index of column: add_column() reallocates array of plan's columns, so pointer to column
+	//becomes invalid when new column is added
+	size_t column;
+	const void *in_array;		//encoded column
+	size_t size;				//number of its elements
+	size_t position;			//first element which isn't decoded yet
+	//decoded elements of current block (at most 8 bytes each)
+	uint64_t block_buf[HD_CURSOR_BLOCK];
+};
+
+extern struct hd_cursor *create_cursor(struct hd_plan *plan, const size_t column,
+	const void *in_array, const size_t size)
+{
+	struct hd_cursor *cursor;
+
+	//check the arguments
+	if (plan == NULL) {
+		error("plan = NULL");
+		return NULL;
+		}
+	if (column >= plan->colnum) {
+		error("column >= number of columns");
+		return NULL;
+		}
+	if (in_array == NULL) {
+		error("in_array = NULL");
+		return NULL;
+		}
+	if (size == 0) {
+		error("size = 0");
+		return NULL;
+		}
+
+	if ( (cursor = malloc(sizeof(struct hd_cursor))) == NULL ) {
+		error("couldn't allocate memory for cursor");
+		return NULL;
+		}
+	cursor->plan = plan;
+	cursor->column = column;
+	cursor->in_array = in_array;
+	cursor->size = size;
+	cursor->position = 0;
+	return cursor;
+}
+
+extern void free_cursor(struct hd_cursor *cursor)
+{
+	free(cursor);
+}
+
+extern int cursor_next_block(struct hd_cursor *cursor, const void **block)
+{
+	//check the arguments
+	if (cursor == NULL) {
+		error("cursor = NULL");
+		return -1;
+		}
+	if (block == NULL) {
+		error("block = NULL");
+		return -1;
+		}
+
+	//number of elements in this block
+	size_t n = cursor->size - cursor->position;
+
+	if (n > HD_CURSOR_BLOCK)
+		n = HD_CURSOR_BLOCK;
+	*block = cursor->block_buf;
+	if (n == 0)
+		return 0;
+
+	if (decode_block(cursor->plan, &cursor->plan->columns[cursor->column], cursor->in_array,
+		cursor->block_buf, cursor->position, n))
+		return -1;
+	cursor->position += n;
+	return n;
+}
+
+extern int cursor_skip(struct hd_cursor *cursor, const size_t n)
+{
+	//check the arguments
+	if (cursor == NULL) {
+		error("cursor = NULL");
+		return -1;
+		}
+
+	//elements after the end of column can't be decoded anyway
+	if (n > cursor->size - cursor->position)
+		cursor->position = cursor->size;
+	else
+		cursor->position += n;
+	return 0;
+}
@@ -0,0 +1,113 @@
+/*
+column plans for encoding and decoding of record batches
+license: BSD 2-Clause
+*/
+
+#ifndef HD_PLAN_H
+#define HD_PLAN_H
+
+#include "hd_common.h"
+#include "hd_int_uniform.h"
+#include "hd_int_arbitrary.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*plan describes types, ranges and distributions of all columns of a table. record batch is encoded
+(decoded) by blocks of HD_PLAN_BLOCK rows: every column of current block is processed before next
+block, and random numbers for all columns of a block are generated by one randombytes() call. every
+column is encoded in the same format as by encode_itype_uniform() or encode_itype_arbitrary(), so it
+can be decoded either by decode_plan() or by corresponding decode function.
+
+plan owns buffers for random and temporary data, so one plan must not be used by several threads at
+the same time. there are no threads in library, but different rows of the same record batch can be
+encoded (decoded) by several threads with encode_plan_rows() (decode_plan_rows()), each with its
+own copy of plan made by copy_plan().*/
+#define HD_PLAN_BLOCK 1024
+
+struct hd_plan;
+
+//create an empty plan and free it with all its columns
+extern struct hd_plan *create_plan(void);
+extern void free_plan(struct hd_plan *plan);
+
+//create a plan with the same columns and widening policy as plan, e.g. for another thread
+extern struct hd_plan *copy_plan(const struct hd_plan *plan);
+
+//turn range widening policy (see widen_itype_range()) on or off for uniform columns which will be
+//added to plan after this call. it's off by default.
+extern int set_plan_widening(struct hd_plan *plan, const bool widen);
+
+//add a column of unsigned and signed 8-, 16-, 32- and 64-bit integers with uniform distribution
+//to plan, return its index or -1 on error
+extern int add_uint8_uniform_column(struct hd_plan *plan, const uint8_t min, const uint8_t max);
+extern int add_int8_uniform_column(struct hd_plan *plan, const int8_t min, const int8_t max);
+extern int add_uint16_uniform_column(struct hd_plan *plan, const uint16_t min, const uint16_t max);
+extern int add_int16_uniform_column(struct hd_plan *plan, const int16_t min, const int16_t max);
+extern int add_uint32_uniform_column(struct hd_plan *plan, const uint32_t min, const uint32_t max);
+extern int add_int32_uniform_column(struct hd_plan *plan, const int32_t min, const int32_t max);
+extern int add_uint64_uniform_column(struct hd_plan *plan, const uint64_t min, const uint64_t max);
+extern int add_int64_uniform_column(struct hd_plan *plan, const int64_t min, const int64_t max);
+
+//same for arbitrary distribution, weights are copied to plan as cumulative weights
+extern int add_uint8_arbitrary_column(struct hd_plan *plan, const uint8_t min, const uint8_t max,
+	const uint32_t *weights);
+extern int add_int8_arbitrary_column(struct hd_plan *plan, const int8_t min, const int8_t max,
+	const uint32_t *weights);
+extern int add_uint16_arbitrary_column(struct hd_plan *plan, const uint16_t min,
+	const uint16_t max, const uint32_t *weights);
+extern int add_int16_arbitrary_column(struct hd_plan *plan, const int16_t min, const int16_t max,
+	const uint32_t *weights);
+extern int add_uint32_arbitrary_column(struct hd_plan *plan, const uint32_t min,
+	const uint32_t max, const uint32_t *weights);
+extern int add_int32_arbitrary_column(struct hd_plan *plan, const int32_t min, const int32_t max,
+	const uint32_t *weights);
+extern int add_uint64_arbitrary_column(struct hd_plan *plan, const uint64_t min,
+	const uint64_t max, const uint32_t *weights);
+extern int add_int64_arbitrary_column(struct hd_plan *plan, const int64_t min, const int64_t max,
+	const uint32_t *weights);
+
+//get size of container element of column in bytes or -1 on error
+extern int plan_container_size(const struct hd_plan *plan, const size_t column);
+
+//DTE and DTD for record batch: in_columns[j] and out_columns[j] point to arrays of size elements
+//of j-th column. all rows are checked before encoding, so nothing is written on error.
+extern int encode_plan(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size);
+extern int decode_plan(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size);
+
+//the same for rows [start; start+n-1] only: columns are still arrays of size elements, and other
+//rows of them aren't read or written
+extern int encode_plan_rows(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size, const size_t start, const size_t n);
+extern int decode_plan_rows(struct hd_plan *plan, const void * const *in_columns,
+	void * const *out_columns, const size_t size, const size_t start, const size_t n);
+
+/*cursor decodes one column of encoded record batch lazily: every cursor_next_block() call decodes
+at most HD_CURSOR_BLOCK next elements to small buffer of cursor, so scan which stops early doesn't
+decode the rest of column, and decoded elements stay in L1 cache. cursor uses plan's buffers, so
+plan must not be freed or used by another thread while cursor is used. new columns can be added
+to plan while cursor exists.*/
+#define HD_CURSOR_BLOCK 256
+
+struct hd_cursor;
+
+//create a cursor for column of plan encoded in in_array of size elements and free it
+extern struct hd_cursor *create_cursor(struct hd_plan *plan, const size_t column,
+	const void *in_array, const size_t size);
+extern void free_cursor(struct hd_cursor *cursor);
+
+//decode next block of column, set *block to its elements (which are valid until the next call)
+//and return their number, 0 at the end of column or -1 on error
+extern int cursor_next_block(struct hd_cursor *cursor, const void **block);
+
+//skip n next elements of column without decoding them
+extern int cursor_skip(struct hd_cursor *cursor, const size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,356 @@
+/*
+header-only C++ interface with compile-time ranges and distributions
+license: BSD 2-Clause
+*/
+
+#ifndef HD_TEMPLATES_HPP
+#define HD_TEMPLATES_HPP
+
+//standard headers must be included before poison.h
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "hd_common.h"
+#include "hd_int_uniform.h"
+#include "hd_int_arbitrary.h"
+
+/*C functions get min, max and weights at runtime, so every call computes group sizes and cumulative
+weights again. here they are template parameters: group_size, group_num and last_group_size are
+compile-time constants, so compiler replaces divisions by them with multiplications and shifts.
+encoded arrays are the same as ones of C functions, so they can be decoded by either interface.
+arrays are passed as std::span, so nothing is copied and no memory is allocated.*/
+
+namespace honeydata {
+
+//properties of supported input types--------------------------------------------------------------
+
+//utype - unsigned type of the same size, container_type - type of encoded array elements,
+//wide_type - arithmetic type of container element, elements - container elements per input element
+template <typename T> struct traits;
+
+#define HD_TRAITS(itype, utype_, container_type_, wide_type_, ctype) \
+template <> struct traits<itype> { \
+	using utype = utype_; \
+	using container_type = container_type_; \
+	using wide_type = wide_type_; \
+	static constexpr size_t elements = sizeof(wide_type) / sizeof(container_type); \
+	\
+	static int check(const itype *array, const size_t size, const itype min, const itype max, \
+		struct hd_error *err) \
+	{ \
+		return check_##ctype##_range(array, size, min, max, err); \
+	} \
+};
+
+HD_TRAITS(uint8_t, uint8_t, uint16_t, uint16_t, uint8)
+HD_TRAITS(int8_t, uint8_t, uint16_t, uint16_t, int8)
+HD_TRAITS(uint16_t, uint16_t, uint32_t, uint32_t, uint16)
+HD_TRAITS(int16_t, uint16_t, uint32_t, uint32_t, int16)
+HD_TRAITS(uint32_t, uint32_t, uint64_t, uint64_t, uint32)
+HD_TRAITS(int32_t, uint32_t, uint64_t, uint64_t, int32)
+#ifdef HD_HAVE_INT128
+//64-bit integers are encoded in 16 little endian bytes, like in hd_int_uniform.c
+HD_TRAITS(uint64_t, uint64_t, unsigned char, hd_uint128_t, uint64)
+HD_TRAITS(int64_t, uint64_t, unsigned char, hd_uint128_t, int64)
+#endif
+
+#undef HD_TRAITS
+
+//uniform distribution-----------------------------------------------------------------------------
+
+template <typename T, T Min, T Max>
+class uniform {
+	static_assert(Min <= Max, "Min > Max");
+
+	using utype = typename traits<T>::utype;
+	using wide_type = typename traits<T>::wide_type;
+
+public:
+	using value_type = T;
+	using container_type = typename traits<T>::container_type;
+
+	//number of container elements per input element
+	static constexpr size_t elements = traits<T>::elements;
+	//true if every value of T is possible
+	static constexpr bool full = (Min == std::numeric_limits<T>::min()) &&
+		(Max == std::numeric_limits<T>::max());
+	//size of full group in elements, from 1 to (T_MAX-T_MIN+1)
+	static constexpr wide_type group_size = (wide_type)(utype)( (utype)Max - (utype)Min ) + 1;
+	//total number of groups, see hd_int_uniform.c
+	static constexpr wide_type group_num = (wide_type)~(wide_type)0 / group_size + 1;
+	//number of elements in the last group or 0 if the last group is full
+	static constexpr wide_type last_group_size = ( (wide_type)~(wide_type)0 % group_size + 1 ) %
+		group_size;
+
+	//encoding of trusted array: the sizes of arrays and the range of in_array aren't checked
+	static int encode_unchecked(std::span<const T> in_array, std::span<container_type> out_array)
+	{
+		randombytes( (unsigned char *)out_array.data(), in_array.size()*sizeof(wide_type) );
+		kernel(in_array.data(), out_array.data(), out_array.data(), in_array.size());
+		return 0;
+	}
+
+	//DTE with random numbers from rand_array, which can be out_array itself
+	static void encode_rand_unchecked(const T *in_array, container_type *out_array,
+		const container_type *rand_array, const size_t size)
+	{
+		kernel(in_array, out_array, rand_array, size);
+	}
+
+	static int encode(std::span<const T> in_array, std::span<container_type> out_array)
+	{
+		//description of wrong element of input array
+		struct hd_error err;
+
+		if (check_sizes(in_array.size(), out_array.size()))
+			return -1;
+		if ( !full && traits<T>::check(in_array.data(), in_array.size(), Min, Max, &err) ) {
+			error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" );
+			return -1;
+			}
+		return encode_unchecked(in_array, out_array);
+	}
+
+	static int decode_unchecked(std::span<const container_type> in_array, std::span<T> out_array)
+	{
+		const size_t size = out_array.size();
+		size_t i;
+
+		//if every value is possible then just copy first part of input array to output array
+		if constexpr (full)
+			memcpy(out_array.data(), in_array.data(), size*sizeof(T));
+		//if only one value is possible then fill output array with this value
+		else if constexpr (group_size == 1)
+			std::fill(out_array.begin(), out_array.end(), Min);
+		//else get value of each number in first group and denormalize it
+		else
+			for (i = 0; i < size; i++)
+				out_array[i] = (T)( (utype)( load(in_array.data(), i) % group_size ) + (utype)Min );
+		return 0;
+	}
+
+	static int decode(std::span<const container_type> in_array, std::span<T> out_array)
+	{
+		if (check_sizes(out_array.size(), in_array.size()))
+			return -1;
+		return decode_unchecked(in_array, out_array);
+	}
+
+private:
+	static int check_sizes(const size_t size, const size_t container_size)
+	{
+		if (size == 0) {
+			error("size = 0");
+			return -1;
+			}
+		if (container_size < size*elements) {
+			error("container is too small");
+			return -1;
+			}
+		return 0;
+	}
+
+	//containers of one element are in machine byte order, 16-byte ones are little endian
+	static wide_type load(const container_type *array, const size_t i)
+	{
+		wide_type elt = 0;
+
+		if constexpr (elements == 1)
+			memcpy(&elt, array + i, sizeof(wide_type));
+		else
+			for (size_t j = elements; j > 0; j--)
+				elt = (elt << 8) | array[i*elements + j-1];
+		return elt;
+	}
+
+	static void store(container_type *array, const size_t i, const wide_type elt)
+	{
+		if constexpr (elements == 1)
+			memcpy(array + i, &elt, sizeof(wide_type));
+		else
+			for (size_t j = 0; j < elements; j++)
+				array[i*elements + j] = (container_type)(elt >> 8*j);
+	}
+
+	static void kernel(const T *in_array, container_type *out_array,
+		const container_type *rand_array, const size_t size)
+	{
+		//current processing element after type promotion
+		wide_type oelt;
+		size_t i;
+
+		//if every value is possible then copy input array and follow it by random numbers
+		if constexpr (full) {
+			memcpy(out_array, in_array, size*sizeof(T));
+			if (rand_array != out_array)
+				memcpy( (unsigned char *)out_array + size*sizeof(T),
+						(const unsigned char *)rand_array + size*sizeof(T),
+						size*(sizeof(wide_type) - sizeof(T)) );
+			}
+		//if only one value is possible then use a random number for encoding each number
+		else if constexpr (group_size == 1) {
+			if (rand_array != out_array)
+				memcpy(out_array, rand_array, size*sizeof(wide_type));
+			}
+		//else select group for each number using random numbers, see hd_int_uniform.c
+		else
+			for (i = 0; i < size; i++) {
+				oelt = (utype)( (utype)in_array[i] - (utype)Min );
+				oelt += ( load(rand_array, i) %
+					(group_num - ( (last_group_size != 0) & (oelt >= last_group_size) )) ) *
+					group_size;
+				store(out_array, i, oelt);
+				}
+	}
+};
+
+//arbitrary distribution---------------------------------------------------------------------------
+
+//Weights is a reference to constexpr std::array<uint32_t, N> of weights of values from Min to
+//Min+N-1
+template <typename T, T Min, const auto &Weights>
+class arbitrary {
+	using utype = typename traits<T>::utype;
+
+	static constexpr size_t wsize = Weights.size();
+	static_assert(wsize > 0, "no weights");
+	static_assert(wsize - 1 <= (utype)( (utype)std::numeric_limits<T>::max() - (utype)Min ),
+		"too many weights for this Min");
+
+	static constexpr std::array<uint64_t, wsize> get_cumuls()
+	{
+		std::array<uint64_t, wsize> cumuls{};
+		uint64_t current = 0;
+
+		for (size_t i = 0; i < wsize; i++) {
+			current += Weights[i];
+			cumuls[i] = current;
+			}
+		return cumuls;
+	}
+
+public:
+	using value_type = T;
+
+	static constexpr T min = Min;
+	static constexpr T max = (T)( (utype)Min + (utype)(wsize - 1) );
+	//cumulative weights: cumuls[i] = sum of weights[j], where j = 0..i
+	static constexpr std::array<uint64_t, wsize> cumuls = get_cumuls();
+	static constexpr uint64_t total = cumuls[wsize - 1];
+	static_assert(total > 0, "all weights are 0");
+	static_assert(total < 4294967296, "too many values for any supported output type");
+
+	//type of intermediate values, uniformly distributed in [0; total]
+	using intermediate_type = std::conditional_t<(total < 256), uint8_t,
+		std::conditional_t<(total < 65536), uint16_t, uint32_t>>;
+	//their encoding, the same as in encode_itype_arbitrary()
+	using scheme = uniform<intermediate_type, 0, (intermediate_type)total>;
+	using container_type = typename scheme::container_type;
+
+	//number of elements processed at once with buffer of intermediate values on stack
+	static constexpr size_t block = 1024;
+
+	static int encode(std::span<const T> in_array, std::span<container_type> out_array)
+	{
+		//description of wrong element of input array
+		struct hd_error err;
+		//intermediate values and random numbers for current block
+		intermediate_type temp_array[block];
+		container_type rand_array[block];
+		size_t start, n, i;
+
+		if (check_sizes(in_array.size(), out_array.size()))
+			return -1;
+		if (traits<T>::check(in_array.data(), in_array.size(), min, max, &err)) {
+			error( (err.code == HD_WRONG_MIN) ? "wrong min value" : "wrong max value" );
+			return -1;
+			}
+		for (i = 0; i < in_array.size(); i++)
+			if (Weights[(utype)( (utype)in_array[i] - (utype)Min )] == 0) {
+				error("value in array is impossible according to cumuls");
+				return -1;
+				}
+
+		for (start = 0; start < in_array.size(); start += n) {
+			n = std::min(block, in_array.size() - start);
+
+			//each intermediate value is pseudorandom value in [cumul_prev; cumuls[index]-1]
+			randombytes( (unsigned char *)rand_array, n*sizeof(container_type) );
+			for (i = 0; i < n; i++) {
+				const size_t index = (utype)( (utype)in_array[start+i] - (utype)Min );
+				const uint64_t cumul_prev = (index == 0) ? 0 : cumuls[index-1];
+
+				temp_array[i] = (rand_array[i] % Weights[index]) + cumul_prev;
+				}
+
+			//if every intermediate value is possible then container begins with their copy
+			if constexpr (scheme::full)
+				memcpy( (unsigned char *)out_array.data() + start*sizeof(intermediate_type), temp_array,
+					n*sizeof(intermediate_type) );
+			//else encode them uniformly with fresh random numbers
+			else {
+				randombytes( (unsigned char *)rand_array, n*sizeof(container_type) );
+				scheme::encode_rand_unchecked(temp_array, out_array.data() + start, rand_array, n);
+				}
+			}
+
+		//and then it's followed by random numbers
+		if constexpr (scheme::full)
+			randombytes( (unsigned char *)out_array.data() + in_array.size()*sizeof(intermediate_type),
+				in_array.size()*sizeof(intermediate_type) );
+		return 0;
+	}
+
+	static int decode(std::span<const container_type> in_array, std::span<T> out_array)
+	{
+		intermediate_type temp_array[block];
+		size_t start, n, i;
+
+		if (check_sizes(out_array.size(), in_array.size()))
+			return -1;
+
+		for (start = 0; start < out_array.size(); start += n) {
+			n = std::min(block, out_array.size() - start);
+			if constexpr (scheme::full)
+				memcpy(temp_array, (const unsigned char *)in_array.data() +
+					start*sizeof(intermediate_type), n*sizeof(intermediate_type));
+			else
+				scheme::decode_unchecked(in_array.subspan(start, n), std::span(temp_array, n));
+			for (i = 0; i < n; i++) {
+				//find the first cumulative weight which is greater than intermediate value
+				const auto it = std::upper_bound(cumuls.begin(), cumuls.end(),
+					(uint64_t)temp_array[i]);
+				//intermediate value equal to total weight is possible in wrong containers
+				if (it == cumuls.end()) {
+					error("can't find corresponding cumuls element");
+					return -1;
+					}
+				out_array[start+i] = (T)( (utype)Min + (utype)(it - cumuls.begin()) );
+				}
+			}
+		return 0;
+	}
+
+private:
+	static int check_sizes(const size_t size, const size_t container_size)
+	{
+		if (size == 0) {
+			error("size = 0");
+			return -1;
+			}
+		if (container_size < size) {
+			error("container is too small");
+			return -1;
+			}
+		return 0;
+	}
+};
+
+}
+
+#endif
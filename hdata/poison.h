@@ -22,6 +22,10 @@ Copyright 2013 - Leaf Security Research
 #	pragma GCC poison asprintf vasprintf
 #	pragma GCC poison strncpy wcsncpy
 #	pragma GCC poison strtok wcstok
+/*strdupa and strndupa are macros if _GNU_SOURCE is defined (e.g. by g++), and poisoning of existing
+macro produces a warning, so undefine them first*/
+#	undef strdupa
+#	undef strndupa
 #	pragma GCC poison strdupa strndupa
 
 /* signal related */
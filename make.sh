@@ -16,6 +16,15 @@ gcc tests/int_uniform/uint32.c $int_u_files $int_opts -o build/int_uniform/uint3
 gcc tests/int_uniform/int32.c $int_u_files $int_opts -o build/int_uniform/int32  &&
 gcc tests/int_uniform/uint64.c $int_u_files $int_opts -o build/int_uniform/uint64 &&
 gcc tests/int_uniform/int64.c $int_u_files $int_opts -o build/int_uniform/int64 &&
+gcc tests/int_uniform/uint128.c $int_u_files $int_opts -o build/int_uniform/uint128 &&
+gcc tests/int_uniform/int128.c $int_u_files $int_opts -o build/int_uniform/int128 &&
+
+#64-bit tests again with GNU MP instead of native 128-bit arithmetic, which is used by compilers
+#without __int128 and on big endian machines
+gcc tests/int_uniform/uint64.c $int_u_files $int_opts -DHD_GMP_UINT128 \
+	-o build/int_uniform/uint64_gmp &&
+gcc tests/int_uniform/int64.c $int_u_files $int_opts -DHD_GMP_UINT128 \
+	-o build/int_uniform/int64_gmp &&
 
 int_a_files="hdata/hd_int_arbitrary.c $int_u_files"
 
@@ -28,9 +37,30 @@ gcc tests/int_arbitrary/int32.c $int_a_files $int_opts -o build/int_arbitrary/in
 gcc tests/int_arbitrary/uint64.c $int_a_files $int_opts -o build/int_arbitrary/uint64 &&
 gcc tests/int_arbitrary/int64.c $int_a_files $int_opts -o build/int_arbitrary/int64 &&
 
+#64-bit containers of arbitrary distributions are stored natively and decoded with GNU MP here, so
+#both ways of handling 128-bit numbers must agree on byte order
+gcc tests/int_arbitrary/uint64.c $int_a_files $int_opts -DHD_GMP_UINT128 \
+	-o build/int_arbitrary/uint64_gmp &&
+gcc tests/int_arbitrary/int64.c $int_a_files $int_opts -DHD_GMP_UINT128 \
+	-o build/int_arbitrary/int64_gmp &&
+
 fp_opts="-lm $int_opts"
 fp_u_files="hdata/hd_fp_uniform.c $int_a_files"
 
 gcc tests/fp_uniform/compatibility.c -o build/fp_uniform/compatibility -Wall &&
 gcc tests/fp_uniform/float.c $fp_u_files $fp_opts -o build/fp_uniform/float &&
-gcc tests/fp_uniform/double.c $fp_u_files $fp_opts -o build/fp_uniform/double
+gcc tests/fp_uniform/double.c $fp_u_files $fp_opts -o build/fp_uniform/double &&
+
+dist_files="hdata/hd_dist.c $int_a_files"
+
+#distributions with more than 1000 elements use compressed cumulative weights in this test, so
+#both guide table and compressed cumulative weights are tested
+gcc tests/dist/dist.c $dist_files -lm $int_opts -DHD_DIST_GUIDE_MAX=1000 -o build/dist/dist &&
+
+plan_files="hdata/hd_plan.c $int_a_files"
+
+gcc tests/plan/plan.c $plan_files $int_opts -o build/plan/plan &&
+
+#C++ test is compiled separately, because g++ would compile C files as C++ ones
+g++ -std=c++20 -Wall -c tests/cpp/templates.cpp -o build/cpp/templates.o &&
+gcc build/cpp/templates.o $int_a_files $int_opts -lstdc++ -o build/cpp/templates
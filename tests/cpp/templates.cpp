@@ -0,0 +1,193 @@
+/*
+test program for honeydata library
+license: BSD 2-Clause
+*/
+
+#include "../../hdata/hd_templates.hpp"
+#include "../t_common.h"
+
+//weights for arbitrary distributions must have static storage duration
+static constexpr std::array<uint32_t, 4> weights8 = {100, 0, 55, 100};
+static constexpr std::array<uint32_t, 4> weights32 = {70000, 1, 0, 5};
+
+using u8_scheme = honeydata::uniform<uint8_t, 100, 200>;
+using i16_scheme = honeydata::uniform<int16_t, -1200, 800>;
+using u32_full_scheme = honeydata::uniform<uint32_t, 0, UINT32_MAX>;
+using i32_scheme = honeydata::uniform<int32_t, INT32_MIN/2, INT32_MAX/2>;
+#ifdef HD_HAVE_INT128
+using u64_scheme = honeydata::uniform<uint64_t, 1, 5000000000000000000>;
+using i64_scheme = honeydata::uniform<int64_t, -7, -7>;
+#endif
+using a8_scheme = honeydata::arbitrary<uint8_t, 10, weights8>;
+using a32_scheme = honeydata::arbitrary<uint32_t, 3000000000, weights32>;
+
+//group parameters are compile-time constants, see math.c
+static_assert(u8_scheme::group_size == 101);
+static_assert(u8_scheme::group_num == 649);
+static_assert(u8_scheme::last_group_size == 88);
+static_assert(u32_full_scheme::full && (u32_full_scheme::group_size == 4294967296));
+#ifdef HD_HAVE_INT128
+static_assert( (i64_scheme::group_size == 1) && (u64_scheme::elements == 16) );
+#endif
+static_assert( (a8_scheme::total == 255) && (a8_scheme::max == 13) &&
+	std::is_same_v<a8_scheme::container_type, uint16_t> );
+static_assert( (a32_scheme::total == 70006) &&
+	std::is_same_v<a32_scheme::container_type, uint64_t> );
+
+extern int main(void)
+{
+	#define SIZE 2500								//size of arrays
+
+	uint8_t u8[SIZE], d_u8[SIZE], a8[SIZE], d_a8[SIZE];
+	int16_t i16[SIZE], d_i16[SIZE];
+	uint32_t u32[SIZE], d_u32[SIZE], a32[SIZE], d_a32[SIZE];
+	int32_t i32[SIZE], d_i32[SIZE];
+#ifdef HD_HAVE_INT128
+	uint64_t u64[SIZE], d_u64[SIZE];
+	int64_t i64[SIZE], d_i64[SIZE];
+	unsigned char e_u64[16*SIZE], e_i64[16*SIZE];
+	hd_uint128_t elt;
+	size_t j;
+#endif
+	uint16_t e_u8[SIZE], e_a8[SIZE];
+	uint32_t e_i16[SIZE];
+	uint64_t e_u32[SIZE], e_i32[SIZE], e_a32[SIZE];
+	size_t i;
+
+	test_init();
+
+
+
+	//random data encoding and decoding------------------------------------------------------------
+
+	randombytes((unsigned char *)u8, sizeof(u8));
+	randombytes((unsigned char *)i16, sizeof(i16));
+	randombytes((unsigned char *)u32, sizeof(u32));
+	randombytes((unsigned char *)i32, sizeof(i32));
+	for (i = 0; i < SIZE; i++) {
+		u8[i] = (u8[i] % 101) + 100;
+		i16[i] = (i16[i] % 1000) - 200;
+		i32[i] = i32[i] / 2;
+		a8[i] = (i % 3 == 0) ? 10 : 12 + (i % 2);
+		a32[i] = (i % 5 == 0) ? 3000000003 : 3000000000;
+		}
+
+	if (u8_scheme::encode(u8, e_u8) || u8_scheme::decode(e_u8, d_u8) ||
+		i16_scheme::encode(i16, e_i16) || i16_scheme::decode(e_i16, d_i16) ||
+		u32_full_scheme::encode(u32, e_u32) || u32_full_scheme::decode(e_u32, d_u32) ||
+		i32_scheme::encode(i32, e_i32) || i32_scheme::decode(e_i32, d_i32) ||
+		a8_scheme::encode(a8, e_a8) || a8_scheme::decode(e_a8, d_a8) ||
+		a32_scheme::encode(a32, e_a32) || a32_scheme::decode(e_a32, d_a32)) {
+		error("can't encode or decode array");
+		test_error();
+		}
+	if (memcmp(u8, d_u8, sizeof(u8)) || memcmp(i16, d_i16, sizeof(i16)) ||
+		memcmp(u32, d_u32, sizeof(u32)) || memcmp(i32, d_i32, sizeof(i32)) ||
+		memcmp(a8, d_a8, sizeof(a8)) || memcmp(a32, d_a32, sizeof(a32))) {
+		error("orig_array and decoded_array are not the same");
+		test_error();
+		}
+
+#ifdef HD_HAVE_INT128
+	randombytes((unsigned char *)u64, sizeof(u64));
+	for (i = 0; i < SIZE; i++) {
+		u64[i] = u64[i] % 5000000000000000000 + 1;
+		i64[i] = -7;
+		}
+	if (u64_scheme::encode(u64, e_u64) || u64_scheme::decode(e_u64, d_u64) ||
+		i64_scheme::encode(i64, e_i64) || i64_scheme::decode(e_i64, d_i64)) {
+		error("can't encode or decode array");
+		test_error();
+		}
+	if (memcmp(u64, d_u64, sizeof(u64)) || memcmp(i64, d_i64, sizeof(i64))) {
+		error("orig_array and decoded_array are not the same");
+		test_error();
+		}
+
+	//16-byte containers are little endian on every machine
+	for (i = 0; i < SIZE; i++) {
+		elt = 0;
+		for (j = 16; j > 0; j--)
+			elt = (elt << 8) | e_u64[16*i + j-1];
+		if ( (uint64_t)(elt % u64_scheme::group_size) + 1 != u64[i] ) {
+			error("16-byte container is not little endian");
+			test_error();
+			}
+		}
+#endif
+
+
+
+	//compatibility with C functions---------------------------------------------------------------
+
+	memset(d_u8, 0, sizeof(d_u8));
+	memset(d_i32, 0, sizeof(d_i32));
+	memset(d_a8, 0, sizeof(d_a8));
+	memset(d_a32, 0, sizeof(d_a32));
+	decode_uint8_uniform(e_u8, d_u8, SIZE, 100, 200);
+	decode_int32_uniform(e_i32, d_i32, SIZE, INT32_MIN/2, INT32_MAX/2);
+	decode_uint8_arbitrary(e_a8, d_a8, SIZE, 10, 13, weights8.data());
+	decode_uint32_arbitrary(e_a32, d_a32, SIZE, 3000000000, 3000000003, weights32.data());
+	if (memcmp(u8, d_u8, sizeof(u8)) || memcmp(i32, d_i32, sizeof(i32)) ||
+		memcmp(a8, d_a8, sizeof(a8)) || memcmp(a32, d_a32, sizeof(a32))) {
+		error("arrays are not compatible with C decode functions");
+		test_error();
+		}
+
+	memset(d_i16, 0, sizeof(d_i16));
+	encode_int16_uniform(i16, e_i16, SIZE, -1200, 800);
+	i16_scheme::decode(e_i16, d_i16);
+	if (memcmp(i16, d_i16, sizeof(i16))) {
+		error("arrays are not compatible with C encode functions");
+		test_error();
+		}
+
+#ifdef HD_HAVE_INT128
+	memset(d_u64, 0, sizeof(d_u64));
+	decode_uint64_uniform(e_u64, d_u64, SIZE, 1, 5000000000000000000);
+	if (memcmp(u64, d_u64, sizeof(u64))) {
+		error("arrays are not compatible with C decode functions");
+		test_error();
+		}
+
+	memset(d_u64, 0, sizeof(d_u64));
+	encode_uint64_uniform(u64, e_u64, SIZE, 1, 5000000000000000000);
+	u64_scheme::decode(e_u64, d_u64);
+	if (memcmp(u64, d_u64, sizeof(u64))) {
+		error("arrays are not compatible with C encode functions");
+		test_error();
+		}
+#endif
+
+
+
+	//wrong parameters-----------------------------------------------------------------------------
+
+	u8_scheme::encode(std::span<const uint8_t>(), e_u8);
+	u8_scheme::encode(u8, std::span(e_u8, SIZE-1));
+	u8[SIZE-1] = 99;
+	u8_scheme::encode(u8, e_u8);
+	u8[SIZE-1] = 201;
+	u8_scheme::encode(u8, e_u8);
+	a8[SIZE-1] = 11;
+	a8_scheme::encode(a8, e_a8);
+	printf("\n");
+
+#ifdef HD_HAVE_INT128
+	u64_scheme::decode(std::span(e_u64, 16*SIZE-1), d_u64);
+#endif
+	a32_scheme::decode(e_a32, std::span<uint32_t>());
+	//intermediate value equal to total weight doesn't correspond to any value
+	e_a32[0] = a32_scheme::total;
+	if (a32_scheme::decode(e_a32, d_a32) != -1) {
+		error("unexpected success");
+		test_error();
+		}
+
+
+
+	#undef SIZE
+	test_deinit();
+
+	return 0;
+}
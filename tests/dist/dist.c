@@ -0,0 +1,430 @@
+/*
+test program for honeydata library
+license: BSD 2-Clause
+*/
+
+#include "../t_common.h"
+#include "../../hdata/hd_dist.h"
+
+extern int main(void)
+{
+	#define SIZE 3000								//size of arrays, bigger than one block
+	#define WSIZE 65536								//size of weights of 16-bit distribution
+
+	uint8_t u8[SIZE], d_u8[SIZE];
+	uint16_t u16[SIZE], d_u16[SIZE];
+	int32_t i32[SIZE], d_i32[SIZE];
+	uint32_t u32[SIZE], d_u32[SIZE];
+	uint64_t e_u8[SIZE], e_u16[SIZE], e_i32[SIZE];
+	//sum of weights8 is 255, so every intermediate value is possible
+	uint32_t weights8[] = {100, 0, 55, 100}, weights32[] = {70000, 1, 0, 5, 3};
+	static uint32_t weights16[WSIZE];
+	struct hd_dist *dist8, *dist16, *dist32;
+	size_t i;
+
+	test_init();
+
+
+
+	//encoding and decoding------------------------------------------------------------------------
+
+	randombytes((unsigned char *)u16, sizeof(u16));
+	for (i = 0; i < WSIZE; i++)
+		weights16[i] = i % 7;
+	for (i = 0; i < SIZE; i++) {
+		u8[i] = (i % 3 == 0) ? 10 : 12 + (i % 2);
+		if (u16[i] % 7 == 0)
+			u16[i]++;
+		i32[i] = (i % 5 == 0) ? -5 : -2 + (i % 2);
+		}
+
+	if ( ( (dist8 = create_uint8_dist(10, 13, weights8)) == NULL ) ||
+		( (dist16 = create_uint16_dist(0, UINT16_MAX, weights16)) == NULL ) ||
+		( (dist32 = create_int32_dist(-5, -1, weights32)) == NULL ) ) {
+		error("can't create distributions");
+		test_error();
+		}
+
+	if ( (dist_container_size(dist8) != 2) || (dist_container_size(dist16) != 8) ||
+		(dist_container_size(dist32) != 8) ) {
+		error("unexpected container size");
+		test_error();
+		}
+
+	//every distribution is used for several arrays
+	for (i = 0; i < 3; i++) {
+		if ( (encode_uint8_arbitrary_dist(u8, e_u8, SIZE, dist8) != 2) ||
+			(encode_uint16_arbitrary_dist(u16, e_u16, SIZE, dist16) != 8) ||
+			(encode_int32_arbitrary_dist(i32, e_i32, SIZE, dist32) != 8) ) {
+			error("can't encode arrays");
+			test_error();
+			}
+		memset(d_u8, 0, sizeof(d_u8));
+		memset(d_u16, 0, sizeof(d_u16));
+		memset(d_i32, 0, sizeof(d_i32));
+		if ( decode_uint8_arbitrary_dist(e_u8, d_u8, SIZE, dist8) ||
+			decode_uint16_arbitrary_dist(e_u16, d_u16, SIZE, dist16) ||
+			decode_int32_arbitrary_dist(e_i32, d_i32, SIZE, dist32) ) {
+			error("can't decode arrays");
+			test_error();
+			}
+		if ( memcmp(u8, d_u8, sizeof(u8)) || memcmp(u16, d_u16, sizeof(u16)) ||
+			memcmp(i32, d_i32, sizeof(i32)) ) {
+			error("original and decoded arrays are not the same");
+			print_uint16_array(d_u16, 10);
+			print_int32_array(d_i32, 10);
+			test_error();
+			}
+		}
+
+	//skewed distribution: the last buckets of guide table contain many elements
+	uint32_t skewed[101];
+	struct hd_dist *dist_skewed;
+
+	skewed[0] = 100000;
+	for (i = 1; i < 101; i++)
+		skewed[i] = 1;
+	for (i = 0; i < SIZE; i++)
+		i32[i] = i % 101;
+	if ( ( (dist_skewed = create_int32_dist(0, 100, skewed)) == NULL ) ||
+		(encode_int32_arbitrary_dist(i32, e_i32, SIZE, dist_skewed) != 8) ||
+		decode_int32_arbitrary_dist(e_i32, d_i32, SIZE, dist_skewed) ||
+		memcmp(i32, d_i32, sizeof(i32)) ) {
+		error("array with skewed distribution is not decoded right");
+		print_int32_array(d_i32, 10);
+		test_error();
+		}
+	free_dist(dist_skewed);
+
+	//sparse distribution of a few values from the whole range of 64-bit integers
+	int64_t sparse_values[] = {INT64_MIN, -1000000000000, 7, 1 << 30, INT64_MAX}, i64[SIZE],
+		d_i64[SIZE];
+	uint32_t sparse_weights[] = {3, 1, 0, 100, 2};
+	struct hd_dist *dist_sparse;
+
+	for (i = 0; i < SIZE; i++)
+		i64[i] = sparse_values[(i % 2) ? 3 : i % 5];
+	for (i = 0; i < SIZE; i++)
+		if (i64[i] == 7)
+			i64[i] = INT64_MAX;
+	if ( ( (dist_sparse = create_int64_sparse_dist(sparse_values, sparse_weights, 5)) == NULL ) ||
+		(encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_sparse) != 2) ||
+		decode_int64_arbitrary_dist(e_i32, d_i64, SIZE, dist_sparse) ||
+		memcmp(i64, d_i64, sizeof(i64)) ) {
+		error("array with sparse distribution is not decoded right");
+		print_int64_array(d_i64, 10);
+		test_error();
+		}
+
+#ifdef HD_HAVE_INT128
+	//piecewise linear histogram with pieces of 1 element is the same as distribution by weights
+	uint8_t starts8[] = {10, 11, 12, 13};
+	struct hd_dist *dist_normal, *dist_geometric, *dist_zipf, *dist_pieces;
+	//number of decoded elements near the mode of distribution
+	size_t count;
+
+	for (i = 0; i < SIZE; i++)
+		u8[i] = (i % 3 == 0) ? 10 : 12 + (i % 2);
+	memset(d_u8, 0, sizeof(d_u8));
+	if ( ( (dist_pieces = create_uint8_piecewise_dist(starts8, weights8, 4, 13)) == NULL ) ||
+		(encode_uint8_arbitrary_dist(u8, e_u8, SIZE, dist_pieces) != 2) ||
+		decode_uint8_arbitrary(e_u8, d_u8, SIZE, 10, 13, weights8) ||
+		memcmp(u8, d_u8, sizeof(u8)) ) {
+		error("piecewise linear distribution differs from distribution by weights");
+		test_error();
+		}
+	free_dist(dist_pieces);
+
+	//parametric distributions of wide ranges: every value of range is possible
+	if ( ( (dist_normal = create_int32_normal_dist(-1000000000, 1000000000, 5, 1000)) == NULL ) ||
+		( (dist_geometric = create_uint32_geometric_dist(0, UINT32_MAX - 1, 0.5)) == NULL ) ||
+		( (dist_zipf = create_int64_zipf_dist(0, INT64_MAX, 2)) == NULL ) ) {
+		error("can't create parametric distributions");
+		test_error();
+		}
+	for (i = 0; i < SIZE; i++) {
+		i32[i] = (i % 2) ? 1000000000 - i : 5 + i*i;
+		i64[i] = (i % 2) ? i % 1000 : (i % 30)*(i % 30);
+		}
+	if ( (encode_int32_arbitrary_dist(i32, e_i32, SIZE, dist_normal) != 8) ||
+		decode_int32_arbitrary_dist(e_i32, d_i32, SIZE, dist_normal) ||
+		memcmp(i32, d_i32, sizeof(i32)) ||
+		(encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_zipf) != 8) ||
+		decode_int64_arbitrary_dist(e_i32, d_i64, SIZE, dist_zipf) ||
+		memcmp(i64, d_i64, sizeof(i64)) ) {
+		error("array with parametric distribution is not decoded right");
+		print_int32_array(d_i32, 10);
+		print_int64_array(d_i64, 10);
+		test_error();
+		}
+
+	/*random containers are decoded by the shape of distribution (they can fail to decode only with
+	probability of about 2^-17)*/
+	randombytes((unsigned char *)e_i32, sizeof(e_i32));
+	if ( decode_int32_arbitrary_dist(e_i32, d_i32, SIZE, dist_normal) ||
+		decode_uint32_arbitrary_dist(e_i32, u32, SIZE, dist_geometric) ||
+		decode_int64_arbitrary_dist(e_i32, d_i64, SIZE, dist_zipf) ) {
+		error("can't decode random containers");
+		test_error();
+		}
+	//about half of elements of normal distribution are in [mean - 0.67*sd; mean + 0.67*sd], the
+	//rest of range has less than a half of weight, half of geometric ones are 0, 61% of Zipf
+	//ones are 0
+	for (count = 0, i = 0; i < SIZE; i++)
+		count += (d_i32[i] >= 5 - 670) && (d_i32[i] <= 5 + 670);
+	if ( (count < SIZE/5) || (count > 2*SIZE/5) ) {
+		error("unexpected distribution of decoded normal elements");
+		print_int32_array(d_i32, 10);
+		test_error();
+		}
+	for (count = 0, i = 0; i < SIZE; i++)
+		count += (u32[i] == 0);
+	if ( (count < 0.45*SIZE) || (count > 0.55*SIZE) ) {
+		error("unexpected distribution of decoded geometric elements");
+		print_uint32_array(u32, 10);
+		test_error();
+		}
+	for (count = 0, i = 0; i < SIZE; i++)
+		count += (d_i64[i] == 0);
+	if ( (count < 0.55*SIZE) || (count > 0.67*SIZE) ) {
+		error("unexpected distribution of decoded Zipf elements");
+		print_int64_array(d_i64, 10);
+		test_error();
+		}
+	free_dist(dist_normal);
+	free_dist(dist_geometric);
+	free_dist(dist_zipf);
+
+	//every element of small range is possible, even if almost all probability is in one of them
+	for (i = 0; i < SIZE; i++) {
+		i32[i] = i;
+		u32[i] = i;
+		}
+	if ( ( (dist_normal = create_int32_normal_dist(0, SIZE - 1, SIZE/2, 1e-9)) == NULL ) ||
+		( (dist_geometric = create_uint32_geometric_dist(0, SIZE - 1, 0.999999)) == NULL ) ||
+		(encode_int32_arbitrary_dist(i32, e_i32, SIZE, dist_normal) != 8) ||
+		decode_int32_arbitrary_dist(e_i32, d_i32, SIZE, dist_normal) ||
+		memcmp(i32, d_i32, sizeof(i32)) ||
+		(encode_uint32_arbitrary_dist(u32, e_i32, SIZE, dist_geometric) != 8) ||
+		decode_uint32_arbitrary_dist(e_i32, d_u32, SIZE, dist_geometric) ||
+		memcmp(u32, d_u32, sizeof(u32)) ) {
+		error("element of parametric distribution is impossible");
+		test_error();
+		}
+	free_dist(dist_normal);
+	free_dist(dist_geometric);
+#endif
+
+	/*compressed cumulative weights with 32-bit offsets and with every intermediate value possible
+	(distributions are bigger than HD_DIST_GUIDE_MAX of this test)*/
+	#define BIG_WSIZE 2000
+	static uint32_t weights_wide[BIG_WSIZE], weights_full[BIG_WSIZE];
+	struct hd_dist *dist_wide, *dist_full;
+
+	for (i = 0; i < BIG_WSIZE; i++) {
+		weights_wide[i] = (i % 3) ? 1000000 : 0;
+		weights_full[i] = (i == 0) ? 65535 - 32*(BIG_WSIZE - 1) : 32;
+		}
+	for (i = 0; i < SIZE; i++)
+		u32[i] = 100 + 3*(i % (BIG_WSIZE/3)) + 1;
+	if ( ( (dist_wide = create_uint32_dist(100, 100 + BIG_WSIZE - 1, weights_wide)) == NULL ) ||
+		( (dist_full = create_uint32_dist(100, 100 + BIG_WSIZE - 1, weights_full)) == NULL ) ||
+		(encode_uint32_arbitrary_dist(u32, e_i32, SIZE, dist_wide) != 8) ||
+		decode_uint32_arbitrary_dist(e_i32, d_u32, SIZE, dist_wide) ||
+		memcmp(u32, d_u32, sizeof(u32)) ||
+		(encode_uint32_arbitrary_dist(u32, e_i32, SIZE, dist_full) != 4) ||
+		decode_uint32_arbitrary_dist(e_i32, d_u32, SIZE, dist_full) ||
+		memcmp(u32, d_u32, sizeof(u32)) ) {
+		error("array with compressed cumulative weights is not decoded right");
+		print_uint32_array(d_u32, 10);
+		test_error();
+		}
+	free_dist(dist_wide);
+	free_dist(dist_full);
+
+	//learning of distributions from two sample arrays
+	uint64_t counts[4] = {0}, other_counts[4] = {0},
+		big_counts[] = {(uint64_t)1 << 40, 1, 0, (uint64_t)1 << 35};
+	uint32_t learned[4];
+	const uint8_t *samples8[] = {u8, u8 + SIZE/2};
+	const int64_t *samples64[] = {i64, i64 + SIZE/2};
+	size_t sample_sizes[] = {SIZE/2, SIZE - SIZE/2};
+	struct hd_dist *dist_learned, *dist_learned_sparse;
+
+	for (i = 0; i < SIZE; i++) {
+		u8[i] = (i % 3 == 0) ? 10 : 12 + (i % 2);
+		i64[i] = (int64_t)(i % 7) * 1000000000000 - 5;
+		}
+	//halves are counted separately, like by two threads, then merged
+	if ( count_uint8_values(u8, SIZE/2, 10, 13, counts) ||
+		count_uint8_values(u8 + SIZE/2, SIZE - SIZE/2, 10, 13, other_counts) ||
+		merge_counts(counts, other_counts, 4) ||
+		quantize_counts(counts, 4, 1, learned) || (learned[0] != SIZE/3 + 1) ||
+		(learned[1] != 1) || (learned[2] != SIZE/3 + 1) || (learned[3] != SIZE/3 + 1) ) {
+		error("unexpected weights learned from small counts");
+		test_error();
+		}
+	//big counts are scaled, but counted values stay possible
+	if ( quantize_counts(big_counts, 4, 0, learned) || (learned[1] == 0) || (learned[2] != 0) ||
+		((uint64_t)learned[0] + learned[1] + learned[3] > UINT32_MAX) ||
+		(learned[0] < 31*learned[3]) || (learned[0] > 32*learned[3]) ) {
+		error("unexpected weights learned from big counts");
+		test_error();
+		}
+	//sums which don't fit in 64 bits aren't written
+	other_counts[0] = UINT64_MAX;
+	if ( (merge_counts(big_counts, other_counts, 4) != -1) ||
+		(big_counts[0] != (uint64_t)1 << 40) || (big_counts[3] != (uint64_t)1 << 35) ) {
+		error("overflowed counts are merged");
+		test_error();
+		}
+
+	dist_learned = learn_uint8_dist(samples8, sample_sizes, 2, 0, UINT8_MAX, 1);
+	if ( (dist_learned == NULL) ||
+		( (dist_learned_sparse = learn_int64_sparse_dist(samples64, sample_sizes, 2)) == NULL ) ||
+		(encode_uint8_arbitrary_dist(u8, e_u8, SIZE, dist_learned) != 4) ||
+		decode_uint8_arbitrary_dist(e_u8, d_u8, SIZE, dist_learned) ||
+		memcmp(u8, d_u8, sizeof(u8)) ||
+		(encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_learned_sparse) != 4) ||
+		decode_int64_arbitrary_dist(e_i32, d_i64, SIZE, dist_learned_sparse) ||
+		memcmp(i64, d_i64, sizeof(i64)) ) {
+		error("array with learned distribution is not decoded right");
+		test_error();
+		}
+	//values which aren't in samples are possible after smoothing
+	u8[0] = 200;
+	if ( (encode_uint8_arbitrary_dist(u8, e_u8, SIZE, dist_learned) != 4) ||
+		decode_uint8_arbitrary_dist(e_u8, d_u8, SIZE, dist_learned) || (d_u8[0] != 200) ) {
+		error("value which isn't in samples is not decoded right after smoothing");
+		test_error();
+		}
+	free_dist(dist_learned);
+	free_dist(dist_learned_sparse);
+
+	//ranks among a few keys: number of keys which are not bigger than value
+	uint32_t keys[HD_RANK_KEYS], values[] = {0, 5, 6, 61, UINT32_MAX - 1, UINT32_MAX};
+	size_t ranks[6];
+
+	for (i = 0; i < HD_RANK_KEYS; i++)
+		keys[i] = (i < 10) ? 5 + 7*i : UINT32_MAX;
+	if ( rank_uint32_small(keys, values, 6, ranks) || (ranks[0] != 0) || (ranks[1] != 1) ||
+		(ranks[2] != 1) || (ranks[3] != 9) || (ranks[4] != 10) || (ranks[5] != HD_RANK_KEYS) ) {
+		error("unexpected ranks");
+		test_error();
+		}
+
+	//all supported kernel variants must give the same ranks, including the last values which don't
+	//fill a whole vector and values which are equal to keys
+	const enum hd_variant variant = get_kernel_variant();
+	size_t gen_ranks[SIZE], var_ranks[SIZE];
+	int v;
+
+	randombytes((unsigned char *)u32, sizeof(u32));
+	for (i = 0; i < HD_RANK_KEYS; i++)
+		keys[i] = (i < 20) ? ( (uint32_t)i << 27 ) + 1 : UINT32_MAX;
+	for (i = 0; i < SIZE; i += 3)
+		u32[i] = keys[i % HD_RANK_KEYS];
+	set_kernel_variant(HD_GENERIC);
+	rank_uint32_small(keys, u32, SIZE - 1, gen_ranks);
+	for (v = HD_GENERIC + 1; v <= HD_AVX2; v++) {
+		if (set_kernel_variant(v))
+			continue;
+		rank_uint32_small(keys, u32, SIZE - 1, var_ranks);
+		if (memcmp(gen_ranks, var_ranks, (SIZE - 1)*sizeof(size_t))) {
+			error("unexpected kernel result");
+			printf("variant = %s\n", get_kernel_variant_name());
+			test_error();
+			}
+		}
+	set_kernel_variant(variant);
+
+	//encoded arrays must be compatible with functions which use weights
+	memset(d_u16, 0, sizeof(d_u16));
+	decode_uint16_arbitrary(e_u16, d_u16, SIZE, 0, UINT16_MAX, weights16);
+	if (memcmp(u16, d_u16, sizeof(u16))) {
+		error("encoded array is not compatible with decode_uint16_arbitrary()");
+		test_error();
+		}
+
+
+
+	//wrong parameters-----------------------------------------------------------------------------
+
+	create_uint8_dist(2, 1, weights8);
+	create_uint8_dist(0, 1, NULL);
+	create_uint8_dist(11, 11, weights8 + 1);
+	create_int64_dist(INT64_MIN, INT64_MAX, weights32);
+	dist_container_size(NULL);
+	create_int64_sparse_dist(sparse_values, sparse_weights, 0);
+	sparse_values[1] = sparse_values[2];
+	create_int64_sparse_dist(sparse_values, sparse_weights, 5);
+	for (i = 0; i < SIZE; i++)
+		i64[i] = sparse_values[3];
+	i64[0] = 7;
+	encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_sparse);
+	i64[0] = 8;
+	encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_sparse);
+	//wrong elements in the last block are found before anything is written to output array
+	i64[0] = sparse_values[3];
+	i64[SIZE-1] = 8;
+	u16[SIZE-1] = 7;
+	memset(e_i32, 0xAB, sizeof(e_i32));
+	memset(e_u16, 0xAB, sizeof(e_u16));
+	if ( (encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_sparse) != -1) ||
+		(encode_uint16_arbitrary_dist(u16, e_u16, SIZE, dist16) != -1) ) {
+		error("unexpected success");
+		test_error();
+		}
+	i64[SIZE-1] = 7;
+	if (encode_int64_arbitrary_dist(i64, e_i32, SIZE, dist_sparse) != -1) {
+		error("unexpected success");
+		test_error();
+		}
+	for (i = 0; i < SIZE; i++)
+		if ( (e_i32[i] != 0xABABABABABABABAB) || (e_u16[i] != 0xABABABABABABABAB) ) {
+			error("output array is changed by failed encoding");
+			test_error();
+			}
+	rank_uint32_small(keys, NULL, 1, ranks);
+	count_uint8_values(u8, SIZE, 10, 13, counts);
+	quantize_counts(counts, 0, 0, learned);
+	memset(counts, 0, sizeof(counts));
+	quantize_counts(counts, 4, 0, learned);
+	learn_uint8_dist(samples8, sample_sizes, 2, 13, 10, 1);
+	merge_counts(counts, NULL, 4);
+	//sizes which overflow size_t or memory size of supplementary arrays
+	sample_sizes[0] = SIZE_MAX;
+	learn_int64_sparse_dist(samples64, sample_sizes, 2);
+	sample_sizes[0] = SIZE_MAX/8;
+	learn_int64_sparse_dist(samples64, sample_sizes, 2);
+#ifdef HD_HAVE_INT128
+	create_uint8_piecewise_dist(starts8, weights8, 4, 12);
+	create_int64_normal_dist(INT64_MIN, INT64_MAX, 0, 1);
+	create_int32_normal_dist(0, 1, 0, 0);
+	create_uint32_geometric_dist(0, 1, 1);
+	create_uint64_zipf_dist(0, 1, -1);
+#endif
+	printf("\n");
+
+	encode_uint8_arbitrary_dist(NULL, e_u8, SIZE, dist8);
+	encode_uint8_arbitrary_dist(u8, e_u8, 0, dist8);
+	encode_int8_arbitrary_dist((int8_t *)u8, e_u8, SIZE, dist8);
+	u8[0] = 11;
+	encode_uint8_arbitrary_dist(u8, e_u8, SIZE, dist8);
+	decode_uint8_arbitrary_dist(e_u8, d_u8, SIZE, NULL);
+	decode_uint16_arbitrary_dist(e_u8, d_u16, SIZE, dist8);
+	free_dist(dist8);
+	free_dist(dist16);
+	free_dist(dist32);
+	free_dist(dist_sparse);
+	free_dist(NULL);
+
+
+
+	#undef SIZE
+	#undef WSIZE
+	#undef BIG_WSIZE
+	test_deinit();
+
+	return 0;
+}
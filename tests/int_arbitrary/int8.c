@@ -79,11 +79,31 @@ extern int main(void)
 	
 	weights[0] = 4294967295;
 	
+#ifdef HD_HAVE_INT128
+	//sum of weights is not less than 2^32, so intermediate values are 64-bit ones
+	if ((rv = encode_int8_arbitrary(orig_array, &encoded_array, size, min, max, weights)) != 16) {
+		error("unexpected output type");
+		printf("%d\n", rv);
+		test_error();
+		}
+	decode_int8_arbitrary(encoded_array, decoded_array, size, min, max, weights);
+	
+	free(encoded_array);
+	
+	if ( memcmp(orig_array, decoded_array, BYTESIZE) ||
+		(container_int8_arbitrary(min, max, weights) != 16) ) {
+		error("orig_array and decoded_array are not the same");
+		print_int8_array(orig_array, size);
+		print_int8_array(decoded_array, size);
+		test_error();
+		}
+#else
 	if ((rv = encode_int8_arbitrary(orig_array, &encoded_array, size, min, max, weights)) != -1) {
 		error("unexpected output type");
 		printf("%d\n", rv);
 		test_error();
 		}
+#endif
 	
 	#undef ITYPE
 	#undef BYTESIZE
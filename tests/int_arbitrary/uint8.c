@@ -79,11 +79,181 @@ extern int main(void)
 	
 	weights[0] = 4294967295;
 	
+#ifdef HD_HAVE_INT128
+	//sum of weights is not less than 2^32, so intermediate values are 64-bit ones
+	if ((rv = encode_uint8_arbitrary(orig_array, &encoded_array, size, min, max, weights)) != 16) {
+		error("unexpected output type");
+		printf("%d\n", rv);
+		test_error();
+		}
+	decode_uint8_arbitrary(encoded_array, decoded_array, size, min, max, weights);
+	
+	free(encoded_array);
+	
+	if ( memcmp(orig_array, decoded_array, BYTESIZE) ||
+		(container_uint8_arbitrary(min, max, weights) != 16) ) {
+		error("orig_array and decoded_array are not the same");
+		print_uint8_array(orig_array, size);
+		print_uint8_array(decoded_array, size);
+		test_error();
+		}
+#else
 	if ((rv = encode_uint8_arbitrary(orig_array, &encoded_array, size, min, max, weights)) != -1) {
 		error("unexpected output type");
 		printf("%d\n", rv);
 		test_error();
 		}
+#endif
+	
+	//encoding in caller's memory------------------------------------------------------------------
+	
+	#define BIGSIZE 3000							//bigger than one block of intermediate values
+	ITYPE big_array[BIGSIZE], big_decoded_array[BIGSIZE];
+	uint16_t big_encoded_array[BIGSIZE];
+	uint64_t cumuls[3];
+	size_t i;
+	
+	for (i = 0; i < BIGSIZE; i++)
+		big_array[i] = orig_array[i % size];
+	
+	//total weight is 255, so every intermediate value is possible
+	weights[0] = 200;
+	weights[2] = 55;
+	if ((rv = container_uint8_arbitrary(min, max, weights)) != 2) {
+		error("unexpected container size");
+		printf("%d\n", rv);
+		test_error();
+		}
+	get_cumuls(weights, cumuls, 3);
+	
+	//functions which use caller's memory and ones which allocate it must be compatible
+	if ((rv = encode_uint8_arbitrary_cumuls(big_array, big_encoded_array, BIGSIZE, min, max,
+		cumuls)) != 2) {
+		error("unexpected output type");
+		printf("%d\n", rv);
+		test_error();
+		}
+	decode_uint8_arbitrary(big_encoded_array, big_decoded_array, BIGSIZE, min, max, weights);
+	if (memcmp(big_array, big_decoded_array, BIGSIZE)) {
+		error("big_array and big_decoded_array are not the same");
+		print_uint8_array(big_decoded_array, size);
+		test_error();
+		}
+	
+	//every intermediate value is possible, so container is their copy followed by random numbers:
+	//aggregation and selection must read every block from this copy
+	struct hd_uint8_aggregate full_agg = {.count = 0};
+	size_t full_selection[BIGSIZE], full_count;
+	
+	decode_uint8_arbitrary_aggregate(big_encoded_array, BIGSIZE, min, max, cumuls, &full_agg);
+	decode_uint8_arbitrary_select(big_encoded_array, BIGSIZE, min, max, cumuls, 211, 255,
+		full_selection, NULL, &full_count);
+	if ( (full_agg.sum != 211 * BIGSIZE - BIGSIZE / 5) || (full_agg.count != BIGSIZE) ||
+		(full_count != BIGSIZE * 2 / 5) || (full_selection[full_count-1] != BIGSIZE - 1) ) {
+		error("unexpected aggregates or selection of full container");
+		printf("sum = %"PRIu64", count = %zu\n", full_agg.sum, full_count);
+		test_error();
+		}
+	
+	weights[0] = 3;
+	weights[2] = 2;
+	get_cumuls(weights, cumuls, 3);
+	encode_uint8_arbitrary(big_array, &encoded_array, BIGSIZE, min, max, weights);
+	decode_uint8_arbitrary_cumuls(encoded_array, big_decoded_array, BIGSIZE, min, max, cumuls);
+	if (memcmp(big_array, big_decoded_array, BIGSIZE)) {
+		error("big_array and big_decoded_array are not the same");
+		print_uint8_array(big_decoded_array, size);
+		test_error();
+		}
+	
+	//decoding with aggregation: 3 of 5 elements are 210, 2 of 5 are 212
+	struct hd_uint8_aggregate agg = {.count = 0};
+	
+	decode_uint8_arbitrary_aggregate(encoded_array, BIGSIZE, min, max, cumuls, &agg);
+	if ( (agg.sum != 211 * BIGSIZE - BIGSIZE / 5) || (agg.min != 210) || (agg.max != 212) ||
+		(agg.count != BIGSIZE) ) {
+		error("unexpected aggregates");
+		printf("sum = %"PRIu64", min = %"PRIu8", max = %"PRIu8"\n", agg.sum, agg.min, agg.max);
+		test_error();
+		}
+	
+	//decoding with selection: only elements equal to 212 are selected
+	size_t selection[BIGSIZE], count, j;
+	
+	decode_uint8_arbitrary_select(encoded_array, BIGSIZE, min, max, cumuls, 211, 255, selection,
+		big_decoded_array, &count);
+	for (i = 0, j = 0; i < BIGSIZE; i++)
+		if (big_array[i] == 212) {
+			if ( (j >= count) || (selection[j] != i) || (big_decoded_array[j] != 212) )
+				break;
+			j++;
+			}
+	if ( (i != BIGSIZE) || (count != j) || (count != BIGSIZE * 2 / 5) ) {
+		error("unexpected selection");
+		printf("element %zu, count = %zu\n", i, count);
+		test_error();
+		}
+	free(encoded_array);
+	
+	//sampling of decoys: elements are distributed according to weights 3 and 2
+	sample_uint8_arbitrary(big_decoded_array, BIGSIZE, min, max, cumuls);
+	for (i = 0, count = 0; i < BIGSIZE; i++) {
+		if ( (big_decoded_array[i] != 210) && (big_decoded_array[i] != 212) )
+			break;
+		count += (big_decoded_array[i] == 212);
+		}
+	if ( (i != BIGSIZE) || (count < 1000) || (count > 1400) ) {
+		error("unexpected decoy array");
+		printf("element %zu, number of 212 = %zu\n", i, count);
+		test_error();
+		}
+	
+	//too many weights for ranking, so elements are found by binary search
+	uint32_t many_weights[40];
+	uint64_t many_cumuls[40];
+	
+	for (i = 0; i < 40; i++)
+		many_weights[i] = (i % 3 == 1) ? 0 : 1;
+	get_cumuls(many_weights, many_cumuls, 40);
+	sample_uint8_arbitrary(big_decoded_array, BIGSIZE, 100, 139, many_cumuls);
+	for (i = 0; i < BIGSIZE; i++)
+		if ( (big_decoded_array[i] < 100) || (big_decoded_array[i] > 139) ||
+			(big_decoded_array[i] % 3 == 2) )
+			break;
+	if (i != BIGSIZE) {
+		error("unexpected decoy array");
+		printf("element %zu = %"PRIu8"\n", i, big_decoded_array[i]);
+		test_error();
+		}
+	
+	//impossible value in the last block is found before anything is written to container
+	big_array[BIGSIZE-1] = 211;
+	memset(big_encoded_array, 0xAB, sizeof(big_encoded_array));
+	if (encode_uint8_arbitrary_cumuls(big_array, big_encoded_array, BIGSIZE, min, max, cumuls)
+		!= -1) {
+		error("unexpected success");
+		test_error();
+		}
+	for (i = 0; i < sizeof(big_encoded_array); i++)
+		if (((unsigned char *)big_encoded_array)[i] != 0xAB) {
+			error("container is written before impossible value is found");
+			test_error();
+			}
+	big_array[BIGSIZE-1] = orig_array[(BIGSIZE-1) % size];
+	
+	//values with zero weight and too big weights
+	weights[2] = 0;
+	get_cumuls(weights, cumuls, 3);
+	if ( (encode_uint8_arbitrary_cumuls(big_array, big_encoded_array, BIGSIZE, min, max, cumuls)
+		!= -1) || (container_uint8_arbitrary(0, 1, NULL) != -1) ||
+		(decode_uint8_arbitrary_select(big_encoded_array, BIGSIZE, min, max, cumuls, 0, 255, NULL,
+		NULL, &count) != -1) ||
+		(sample_uint8_arbitrary(big_decoded_array, BIGSIZE, min, max, NULL) != -1) ) {
+		error("unexpected success");
+		test_error();
+		}
+	
+	#undef BIGSIZE
 	
 	#undef ITYPE
 	#undef BYTESIZE
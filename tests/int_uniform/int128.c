@@ -0,0 +1,114 @@
+/*
+test program for honeydata library
+license: BSD 2-Clause
+*/
+
+#include "../t_common.h"
+#include "../../hdata/hd_int_uniform.h"
+
+#ifdef HD_HAVE_INT128
+
+extern int main(void)
+{
+	size_t i, size;									//current array size
+	#define ITYPE hd_int128_t						//type for testing in this test unit
+	#define OTYPE unsigned char						//type of container in this test unit
+	#define BYTESIZE (size*sizeof(ITYPE))			//current input array size in bytes
+	const size_t maxsize = 256;						//maximum array size
+	ITYPE min, max, orig_array[maxsize], decoded_array[maxsize];
+	OTYPE encoded_array[32*maxsize];
+
+	test_init();
+
+
+
+	//random encoding and decoding-----------------------------------------------------------------
+
+	for (size = 1; size < maxsize; size++) {
+		//write a random numbers to original array, make some of them small
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		if (size % 2)
+			for (i = 0; i < size; i++)
+				orig_array[i] >>= 64 + size % 64;
+		get_int128_minmax(orig_array, size, &min, &max);
+		encode_int128_uniform(orig_array, encoded_array, size, min, max);
+		decode_int128_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_int128_array(orig_array, 10);
+			print_int128_array(decoded_array, 10);
+			test_error();
+			}
+		}
+
+
+
+	//fixed general cases--------------------------------------------------------------------------
+
+	size = 5;
+	orig_array[0] = -300;
+	orig_array[1] = -200;
+	orig_array[2] = 0;
+	orig_array[3] = HD_INT128_MAX;
+	orig_array[4] = HD_INT128_MIN;
+
+	//every value is possible, so encoded array begins with original one
+	encode_int128_uniform(orig_array, encoded_array, size, HD_INT128_MIN, HD_INT128_MAX);
+	if (memcmp(orig_array, encoded_array, BYTESIZE)) {
+		error("unexpected encoded value");
+		print_32_bytes_array(encoded_array, size);
+		test_error();
+		}
+	decode_int128_uniform(encoded_array, decoded_array, size, HD_INT128_MIN, HD_INT128_MAX);
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_int128_array(decoded_array, size);
+		test_error();
+		}
+
+	//range bigger than 2^127
+	size = 3;
+	encode_int128_uniform(orig_array, encoded_array, size, HD_INT128_MIN / 2 - 7,
+		HD_INT128_MAX / 2 + 3);
+	decode_int128_uniform(encoded_array, decoded_array, size, HD_INT128_MIN / 2 - 7,
+		HD_INT128_MAX / 2 + 3);
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_int128_array(decoded_array, size);
+		test_error();
+		}
+
+	if (container_int128_uniform(-1, 1) != 32) {
+		error("unexpected container size");
+		test_error();
+		}
+
+
+
+	//wrong parameters-----------------------------------------------------------------------------
+
+	size = 5;
+	encode_int128_uniform(orig_array, encoded_array, 1, 2, 1);
+	encode_int128_uniform(orig_array, encoded_array, size, -300, 0);
+	encode_int128_uniform(orig_array, encoded_array, size, 0, HD_INT128_MAX);
+	printf("\n");
+
+
+
+	#undef ITYPE
+	#undef OTYPE
+	#undef BYTESIZE
+	test_deinit();
+
+	return 0;
+}
+
+#else
+
+extern int main(void)
+{
+	printf("128-bit integers aren't supported by compiler\n");
+	return 0;
+}
+
+#endif
@@ -149,6 +149,165 @@ extern int main(void)
 	
 	
 	
+	//decoding with aggregation-------------------------------------------------------------------
+	
+	//array of maximum size is decoded by many blocks
+	size = maxsize;
+	randombytes((unsigned char *)orig_array, BYTESIZE);
+	for (i = 0; i < (int32_t)size; i++)
+		orig_array[i] >>= 8;
+	get_int32_minmax(orig_array, size, &min, &max);
+	encode_int32_uniform(orig_array, encoded_array, size, min, max);
+	
+	struct hd_int32_aggregate agg = {.count = 0};
+	int64_t sum = 0;
+	
+	for (i = 0; i < (int32_t)size; i++)
+		sum += orig_array[i];
+	decode_int32_uniform_aggregate(encoded_array, size, min, max, &agg);
+	if ( (agg.sum != sum) || (agg.min != min) || (agg.max != max) ||
+		(agg.count != size) ) {
+		error("unexpected aggregates");
+		printf("sum = %"PRIi64", min = %"PRI", max = %"PRI", count = %zu\n", agg.sum, agg.min,
+			agg.max, agg.count);
+		test_error();
+		}
+	
+	//aggregates of two parts are added together
+	agg.count = 0;
+	decode_int32_uniform_aggregate(encoded_array, 1000, min, max, &agg);
+	decode_int32_uniform_aggregate(encoded_array + 1000, size - 1000, min, max, &agg);
+	if ( (agg.sum != sum) || (agg.count != size) ) {
+		error("unexpected aggregates");
+		test_error();
+		}
+	
+	//every value is possible, so container is a copy of input array followed by random numbers:
+	//aggregation must read every block from this copy
+	encode_int32_uniform(orig_array, encoded_array, size, INT32_MIN, INT32_MAX);
+	agg.count = 0;
+	decode_int32_uniform_aggregate(encoded_array, size, INT32_MIN, INT32_MAX, &agg);
+	if ( (agg.sum != sum) || (agg.count != size) ) {
+		error("unexpected aggregates of full range");
+		printf("sum = %"PRIi64"\n", agg.sum);
+		test_error();
+		}
+	encode_int32_uniform(orig_array, encoded_array, size, min, max);
+	
+	
+	
+	//decoding with selection----------------------------------------------------------------------
+	
+	//indices and values of elements from [lo; hi] in all blocks
+	size_t *selection = malloc(size*sizeof(size_t)), count, j;
+	const ITYPE lo = min / 4, hi = max / 2;
+	
+	if (selection == NULL) {
+		error("can't allocate memory");
+		test_error();
+		}
+	decode_int32_uniform_select(encoded_array, size, min, max, lo, hi, selection, decoded_array,
+		&count);
+	for (i = 0, j = 0; i < (int32_t)size; i++)
+		if ( (orig_array[i] >= lo) && (orig_array[i] <= hi) ) {
+			if ( (j >= count) || (selection[j] != (size_t)i) ||
+				(decoded_array[j] != orig_array[i]) ) {
+				error("unexpected selection");
+				printf("element %"PRIi32", count = %zu\n", i, count);
+				test_error();
+				}
+			j++;
+			}
+	if (j != count) {
+		error("unexpected number of selected elements");
+		printf("%zu instead of %zu\n", count, j);
+		test_error();
+		}
+	
+	//empty range, only indices are written
+	decode_int32_uniform_select(encoded_array, size, min, max, hi, lo, selection, NULL, &count);
+	if (count != 0) {
+		error("unexpected number of selected elements");
+		test_error();
+		}
+	
+	//every value is possible, so selection must read every block from copy of input array
+	encode_int32_uniform(orig_array, encoded_array, size, INT32_MIN, INT32_MAX);
+	decode_int32_uniform_select(encoded_array, size, INT32_MIN, INT32_MAX, lo, hi, selection,
+		decoded_array, &count);
+	if (count != j) {
+		error("unexpected number of selected elements in full range");
+		printf("%zu instead of %zu\n", count, j);
+		test_error();
+		}
+	for (j = 0; j < count; j++)
+		if (decoded_array[j] != orig_array[selection[j]]) {
+			error("unexpected selection of full range");
+			printf("element %zu\n", selection[j]);
+			test_error();
+			}
+	
+	//all supported kernel variants must select the same elements, including the last ones which
+	//don't fill a whole vector
+	const enum hd_variant variant = get_kernel_variant();
+	size_t variant_count;
+	int v;
+	
+	decode_int32_uniform(encoded_array, decoded_array, size, INT32_MIN, INT32_MAX);
+	for (v = HD_GENERIC; v <= HD_AVX2; v++) {
+		if (set_kernel_variant(v))
+			continue;
+		select_int32_range(decoded_array, 1003, lo, hi, selection, NULL, &variant_count);
+		for (i = 0, j = 0; i < 1003; i++)
+			if ( (decoded_array[i] >= lo) && (decoded_array[i] <= hi) ) {
+				if ( (j >= variant_count) || (selection[j] != (size_t)i) )
+					break;
+				j++;
+				}
+		if ( (i != 1003) || (j != variant_count) ) {
+			error("unexpected kernel result");
+			printf("variant = %s\n", get_kernel_variant_name());
+			test_error();
+			}
+		}
+	set_kernel_variant(variant);
+	free(selection);
+	
+	
+	
+	//sampling of decoys---------------------------------------------------------------------------
+	
+	//every decoy element is in range, and elements are different
+	sample_int32_uniform(decoded_array, size, lo, hi);
+	for (i = 0; i < (int32_t)size; i++)
+		if ( (decoded_array[i] < lo) || (decoded_array[i] > hi) ) {
+			error("decoy element is out of range");
+			printf("%"PRI"\n", decoded_array[i]);
+			test_error();
+			}
+	if (!memcmp(decoded_array, decoded_array + size / 2, size / 2 * sizeof(ITYPE))) {
+		error("decoy array isn't random");
+		test_error();
+		}
+	
+	//parts of array can be sampled separately, and elements of a small range are distributed
+	//uniformly
+	size_t decoy_counts[3] = {0, 0, 0};
+	
+	sample_int32_uniform(decoded_array, size / 2, -1, 1);
+	sample_int32_uniform(decoded_array + size / 2, size - size / 2, -1, 1);
+	for (i = 0; i < (int32_t)size; i++)
+		decoy_counts[decoded_array[i] + 1]++;
+	for (i = 0; i < 3; i++)
+		if ( (decoy_counts[i] < size / 3 - size / 50) ||
+			(decoy_counts[i] > size / 3 + size / 50) ) {
+			error("decoy elements are not distributed uniformly");
+			printf("%"PRI": %zu\n", i - 1, decoy_counts[i]);
+			test_error();
+			}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -239,6 +398,12 @@ extern int main(void)
 	decode_int32_uniform(encoded_array, orig_array, 1, 2, 1);
 	printf("\n");
 	
+	decode_int32_uniform_aggregate(encoded_array, 1, 0, 1, NULL);
+	decode_int32_uniform_select(encoded_array, 1, 0, 1, 0, 1, NULL, NULL, &count);
+	sample_int32_uniform(decoded_array, 1, 1, 0);
+	aggregate_int32_array(orig_array, 0, &agg);
+	printf("\n");
+	
 	print_int32_array(NULL, 0);
 	print_int32_array(orig_array, 0);
 	
@@ -23,6 +23,9 @@ extern int main(void)
 	ITYPE min, max, orig_array[maxsize], decoded_array[maxsize];	//minimum and maximim in array
 	OTYPE encoded_array[16*maxsize];
 	FILE *fp;
+	OTYPE rand_array[16*256];						//random numbers for group selection
+	struct hd_error err;							//result of range checking
+	enum hd_variant variant;						//chosen kernel variant
 	
 	/*Buffer for ciphertext. Ensure the buffer is long enough for the ciphertext which may be
 	longer than the plaintext, dependant on the algorithm and mode (for AES-256 in CBC mode we need
@@ -149,6 +152,84 @@ extern int main(void)
 	
 	
 	
+	//power-of-two ranges and range widening------------------------------------------------------
+	
+	size = 256;
+	randombytes((unsigned char *)orig_array, BYTESIZE);
+	randombytes(rand_array, sizeof(rand_array));
+	for (i = 0; i < size; i++)
+		orig_array[i] = -5000000000000 + orig_array[i] % 4000000000000;
+	min = -9000000000000;
+	max = -1000000000000;
+	widen_int64_range(&min, &max);
+	if ( (min != -9000000000000) || (max != -9000000000000 + 8796093022207) ) {
+		error("unexpected widened range");
+		printf("min = %"PRI", max = %"PRI"\n", min, max);
+		test_error();
+		}
+	//group selection is a shift of 128-bit number: encoded element = normalized element +
+	//(random number << 43)
+	encode_int64_uniform_rand(orig_array, encoded_array, rand_array, size, min, max);
+	decode_int64_uniform(encoded_array, decoded_array, size, min, max);
+	for (i = 0; i < size; i++) {
+		unsigned __int128 encoded, random;
+		
+		memcpy(&encoded, encoded_array+16*i, 16);
+		memcpy(&random, rand_array+16*i, 16);
+		if (encoded != (uint64_t)(orig_array[i] - min) + (random << 43)) {
+			error("unexpected encoded element");
+			test_error();
+			}
+		}
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_int64_array(orig_array, 10);
+		print_int64_array(decoded_array, 10);
+		test_error();
+		}
+	min = 0;
+	max = INT64_MAX;
+	widen_int64_range(&min, &max);
+	if ( (min != 0) || (max != INT64_MAX) ) {
+		error("unexpected widened range");
+		test_error();
+		}
+	min = INT64_MIN;
+	max = 0;
+	widen_int64_range(&min, &max);
+	if ( (min != INT64_MIN) || (max != INT64_MAX) ) {
+		error("unexpected widened range");
+		test_error();
+		}
+	
+	
+	
+	//unchecked encoding and decoding of the same arrays------------------------------------------
+	
+	for (size = 1; size < 256; size++) {
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		get_int64_minmax(orig_array, size, &min, &max);
+		//checked and unchecked functions must be compatible with each other
+		encode_int64_uniform_unchecked(orig_array, encoded_array, size, min, max);
+		decode_int64_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_int64_array(orig_array, 10);
+			print_int64_array(decoded_array, 10);
+			test_error();
+			}
+		encode_int64_uniform(orig_array, encoded_array, size, min, max);
+		decode_int64_uniform_unchecked(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_int64_array(orig_array, 10);
+			print_int64_array(decoded_array, 10);
+			test_error();
+			}
+		}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -217,6 +298,119 @@ extern int main(void)
 	
 	
 	
+	//range checking-------------------------------------------------------------------------------
+	
+	size = 300;
+	for (i = 0; i < size; i++)
+		orig_array[i] = -20000000000000 + i;
+	if (check_int64_range(orig_array, size, -20000000000000, -19999999999701, &err) ||
+		(err.code != HD_OK)) {
+		error("unexpected range checking result");
+		test_error();
+		}
+	if ( (check_int64_range(orig_array, size, -19999999999990, -19999999999701, &err) != -1) ||
+		(err.code != HD_WRONG_MIN) || (err.index != 0) ) {
+		error("unexpected range checking result");
+		printf("code = %d, index = %zu\n", err.code, err.index);
+		test_error();
+		}
+	if ( (check_int64_range(orig_array, size, -20000000000000, -19999999999722, &err) != -1) ||
+		(err.code != HD_WRONG_MAX) || (err.index != 279) ) {
+		error("unexpected range checking result");
+		printf("code = %d, index = %zu\n", err.code, err.index);
+		test_error();
+		}
+	
+	
+	
+	//kernel variants------------------------------------------------------------------------------
+	
+	variant = get_kernel_variant();
+	printf("Chosen kernel variant: %s\n", get_kernel_variant_name());
+	//all supported variants must give the same results
+	for (i = HD_GENERIC; i <= HD_AVX2; i++) {
+		if (set_kernel_variant(i))
+			continue;
+		get_int64_minmax(orig_array, size, &min, &max);
+		if ( (min != -20000000000000) || (max != -19999999999701) ||
+			(check_int64_range(orig_array, size, -20000000000000, -19999999999722, &err) != -1) ||
+			(err.code != HD_WRONG_MAX) || (err.index != 279) ) {
+			error("unexpected kernel result");
+			printf("variant = %s\n", get_kernel_variant_name());
+			test_error();
+			}
+		}
+	
+	/*minimums, maximums, range checks and aggregates of all integer types must be the same as
+	ones of generic variant for random elements and for a wrong element which doesn't fill a whole
+	vector*/
+	#define COMPARE_VARIANTS(itype, ctype) { \
+		itype array[1003], gen_min, gen_max, var_min, var_max; \
+		struct hd_##ctype##_aggregate gen_agg = {.count = 0}, var_agg; \
+		struct hd_error gen_err, var_err; \
+		size_t gen_wrong, var_wrong; \
+		int v; \
+		\
+		randombytes( (unsigned char *)array, sizeof(array) ); \
+		set_kernel_variant(HD_GENERIC); \
+		get_##ctype##_minmax(array, 1003, &gen_min, &gen_max); \
+		check_##ctype##_range(array, 1003, gen_min + 1, gen_max, &gen_err); \
+		aggregate_##ctype##_array(array, 500, &gen_agg); \
+		aggregate_##ctype##_array(array + 500, 503, &gen_agg); \
+		for (v = HD_GENERIC + 1; v <= HD_AVX2; v++) { \
+			if (set_kernel_variant(v)) \
+				continue; \
+			var_agg.count = 0; \
+			get_##ctype##_minmax(array, 1003, &var_min, &var_max); \
+			check_##ctype##_range(array, 1003, gen_min + 1, gen_max, &var_err); \
+			aggregate_##ctype##_array(array, 500, &var_agg); \
+			aggregate_##ctype##_array(array + 500, 503, &var_agg); \
+			if ( (var_min != gen_min) || (var_max != gen_max) || \
+				(var_err.code != gen_err.code) || (var_err.index != gen_err.index) || \
+				(var_agg.sum != gen_agg.sum) || \
+				(var_agg.min != gen_agg.min) || (var_agg.max != gen_agg.max) || \
+				(var_agg.count != gen_agg.count) ) { \
+				error("unexpected kernel result for " #itype); \
+				printf("variant = %s\n", get_kernel_variant_name()); \
+				test_error(); \
+				} \
+			} \
+		\
+		/*the only wrong element is the last one*/ \
+		for (i = 1; i < 1002; i++) \
+			array[i] = array[0]; \
+		array[1002] = (array[0] == gen_max) ? array[0] - 1 : array[0] + 1; \
+		set_kernel_variant(HD_GENERIC); \
+		check_##ctype##_range(array, 1003, array[0], array[0], &gen_err); \
+		gen_wrong = gen_err.index; \
+		for (v = HD_GENERIC + 1; v <= HD_AVX2; v++) { \
+			if (set_kernel_variant(v)) \
+				continue; \
+			check_##ctype##_range(array, 1003, array[0], array[0], &var_err); \
+			var_wrong = var_err.index; \
+			if ( (gen_wrong != 1002) || (var_wrong != gen_wrong) ) { \
+				error("unexpected kernel result for " #itype); \
+				printf("variant = %s\n", get_kernel_variant_name()); \
+				test_error(); \
+				} \
+			} \
+		}
+	
+	COMPARE_VARIANTS(uint8_t, uint8)
+	COMPARE_VARIANTS(int8_t, int8)
+	COMPARE_VARIANTS(uint16_t, uint16)
+	COMPARE_VARIANTS(int16_t, int16)
+	COMPARE_VARIANTS(uint32_t, uint32)
+	COMPARE_VARIANTS(int32_t, int32)
+	COMPARE_VARIANTS(uint64_t, uint64)
+	COMPARE_VARIANTS(int64_t, int64)
+	
+	#undef COMPARE_VARIANTS
+	set_kernel_variant(variant);
+	printf("\n");
+	
+	
+	
 	//wrong parameters-----------------------------------------------------------------------------
 	
 	get_int64_minmax(NULL, 0, NULL, NULL);
@@ -24,6 +24,7 @@ extern int main(void)
 	ITYPE min, max, orig_array[maxsize], decoded_array[maxsize];	//minimum and maximim in array
 	OTYPE encoded_array[maxsize];
 	FILE *fp;
+	struct hd_table8 *table;						//tables for range of array
 	
 	/*Buffer for ciphertext. Ensure the buffer is long enough for the ciphertext which may be
 	longer than the plaintext, dependant on the algorithm and mode (for AES-256 in CBC mode we need
@@ -282,6 +283,40 @@ extern int main(void)
 	
 	
 	
+	//table-driven encoding and decoding-----------------------------------------------------------
+	
+	for (size = 1; size < 256; size++) {
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		get_int8_minmax(orig_array, size, &min, &max);
+		//every range must be tested with the last size, including range with every value
+		if (size == 255) {
+			min = INT8_MIN;
+			max = INT8_MAX;
+			}
+		if ( (table = create_int8_uniform_table(min, max)) == NULL )
+			test_error();
+		//table-driven and usual functions must be compatible with each other
+		encode_int8_uniform(orig_array, encoded_array, size, min, max);
+		decode_int8_uniform_table(table, encoded_array, decoded_array, size);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_int8_array(orig_array, 10);
+			print_int8_array(decoded_array, 10);
+			test_error();
+			}
+		encode_int8_uniform_table(table, orig_array, encoded_array, size);
+		decode_int8_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_int8_array(orig_array, 10);
+			print_int8_array(decoded_array, 10);
+			test_error();
+			}
+		free_uniform_table(table);
+		}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -372,6 +407,20 @@ extern int main(void)
 	decode_int8_uniform(encoded_array, orig_array, 1, -2, -100);
 	printf("\n");
 	
+	create_int8_uniform_table(-2, -100);
+	encode_int8_uniform_table(NULL, orig_array, encoded_array, 1);
+	decode_int8_uniform_table(NULL, encoded_array, orig_array, 1);
+	//table of the other 8-bit type is rejected
+	if ( (table = create_uint8_uniform_table(0, 10)) == NULL )
+		test_error();
+	if ( (encode_int8_uniform_table(table, orig_array, encoded_array, 1) != -1) ||
+		(decode_int8_uniform_table(table, encoded_array, orig_array, 1) != -1) ) {
+		error("unexpected success");
+		test_error();
+		}
+	free_uniform_table(table);
+	printf("\n");
+	
 	stats_int8_array(NULL, 0, NULL);
 	stats_int8_array(orig_array, 0, NULL);
 	stats_int8_array(orig_array, 1, NULL);
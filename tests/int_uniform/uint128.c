@@ -0,0 +1,186 @@
+/*
+test program for honeydata library
+license: BSD 2-Clause
+*/
+
+#include "../t_common.h"
+#include "../../hdata/hd_int_uniform.h"
+
+#ifdef HD_HAVE_INT128
+
+//check that every encoded element modulo (max - min + 1) is normalized original element
+static void check_groups(const hd_uint128_t *orig_array, const unsigned char *encoded_array,
+	const size_t size, const hd_uint128_t min, const hd_uint128_t max)
+{
+	mpz_t elt, group_size, normalized;
+	size_t i;
+
+	mpz_inits(elt, group_size, normalized, NULL);
+	mpz_import(group_size, 1, -1, sizeof(hd_uint128_t), 0, 0, (hd_uint128_t []){max - min});
+	mpz_add_ui(group_size, group_size, 1);
+	for (i = 0; i < size; i++) {
+		mpz_import(elt, 32, -1, 1, 0, 0, encoded_array+32*i);
+		mpz_tdiv_r(elt, elt, group_size);
+		mpz_import(normalized, 1, -1, sizeof(hd_uint128_t), 0, 0,
+			(hd_uint128_t []){orig_array[i] - min});
+		if (mpz_cmp(elt, normalized)) {
+			error("encoded element is in wrong group");
+			print_32_bytes_array(encoded_array+32*i, 1);
+			test_error();
+			}
+		}
+	mpz_clears(elt, group_size, normalized, NULL);
+}
+
+extern int main(void)
+{
+	size_t i, size;									//current array size
+	#define ITYPE hd_uint128_t						//type for testing in this test unit
+	#define OTYPE unsigned char						//type of container in this test unit
+	#define BYTESIZE (size*sizeof(ITYPE))			//current input array size in bytes
+	const size_t maxsize = 256;						//maximum array size
+	ITYPE min, max, span, orig_array[maxsize], decoded_array[maxsize];
+	OTYPE encoded_array[32*maxsize], rand_array[32*maxsize];
+
+	test_init();
+
+
+
+	//random encoding and decoding-----------------------------------------------------------------
+
+	//spans of ranges: random, less than 2^64 and power of two minus 1
+	for (size = 1; size < maxsize; size++) {
+		randombytes((unsigned char *)&span, sizeof(ITYPE));
+		switch (size % 3) {
+			case 1:
+				span >>= 64 + size % 64;
+				break;
+			case 2:
+				span = ( (ITYPE)1 << (size % 128) ) - 1;
+				break;
+			}
+		randombytes((unsigned char *)&min, sizeof(ITYPE));
+		if (min > HD_UINT128_MAX - span)
+			min = HD_UINT128_MAX - span;
+		max = min + span;
+
+		//write a random numbers from [min; max] to original array
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		for (i = 0; i < size; i++)
+			orig_array[i] = (span == HD_UINT128_MAX) ? orig_array[i] :
+				min + orig_array[i] % (span + 1);
+
+		encode_uint128_uniform(orig_array, encoded_array, size, min, max);
+		if (span != HD_UINT128_MAX)
+			check_groups(orig_array, encoded_array, size, min, max);
+		decode_uint128_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_uint128_array(orig_array, 10);
+			print_uint128_array(decoded_array, 10);
+			test_error();
+			}
+		}
+
+
+
+	//fixed general cases--------------------------------------------------------------------------
+
+	if ( (container_uint128_uniform(0, HD_UINT128_MAX) != 32) ||
+		(container_uint128_uniform(5, 5) != 32) ) {
+		error("unexpected container size");
+		test_error();
+		}
+
+	//element of the last group which doesn't fit in it is placed in previous group: range [0; 9]
+	//has 2^256 % 10 = 6 elements in the last group, so 5 is encoded as 2^256 - 6 + 5 and 9 as
+	//2^256 - 16 + 9
+	size = 2;
+	orig_array[0] = 5;
+	orig_array[1] = 9;
+	memset(rand_array, 0xFF, 32*size);
+	encode_uint128_uniform_rand(orig_array, encoded_array, rand_array, size, 0, 9);
+	if ( (encoded_array[0] != 0xFF) || (encoded_array[32] != 0xF9) ||
+		(encoded_array[63] != 0xFF) ) {
+		error("unexpected encoded value");
+		print_32_bytes_array(encoded_array, size);
+		test_error();
+		}
+	decode_uint128_uniform(encoded_array, decoded_array, size, 0, 9);
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_uint128_array(decoded_array, size);
+		test_error();
+		}
+
+	//random number 1 selects the first group
+	memset(rand_array, 0, 32*size);
+	rand_array[0] = 1;
+	rand_array[32] = 15;
+	encode_uint128_uniform_rand(orig_array, encoded_array, rand_array, size, 0, 9);
+	if ( (encoded_array[0] != 5) || (encoded_array[32] != 19) ) {
+		error("unexpected encoded value");
+		print_32_bytes_array(encoded_array, size);
+		test_error();
+		}
+
+
+
+	//fixed special cases--------------------------------------------------------------------------
+
+	size = 5;
+	for (i = 0; i < size; i++)
+		orig_array[i] = HD_UINT128_MAX - i;
+	get_uint128_minmax(orig_array, size, &min, &max);
+	if ( (min != HD_UINT128_MAX - 4) || (max != HD_UINT128_MAX) ) {
+		error("unexpected min or max");
+		test_error();
+		}
+
+	//every value is possible, only one value is possible
+	encode_uint128_uniform(orig_array, encoded_array, size, 0, HD_UINT128_MAX);
+	decode_uint128_uniform(encoded_array, decoded_array, size, 0, HD_UINT128_MAX);
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_uint128_array(decoded_array, size);
+		test_error();
+		}
+	encode_uint128_uniform(orig_array, encoded_array, 1, max, max);
+	decode_uint128_uniform(encoded_array, decoded_array, 1, max, max);
+	if (decoded_array[0] != max) {
+		error("orig_array and decoded_array are not the same");
+		print_uint128_array(decoded_array, 1);
+		test_error();
+		}
+
+
+
+	//wrong parameters-----------------------------------------------------------------------------
+
+	encode_uint128_uniform(NULL, NULL, 0, 0, 0);
+	encode_uint128_uniform(orig_array, encoded_array, 1, 2, 1);
+	encode_uint128_uniform(orig_array, encoded_array, size, 0, 15);
+	decode_uint128_uniform(encoded_array, NULL, 0, 0, 0);
+	check_uint128_range(orig_array, size, 2, 1, NULL);
+	container_uint128_uniform(2, 1);
+	printf("\n");
+
+
+
+	#undef ITYPE
+	#undef OTYPE
+	#undef BYTESIZE
+	test_deinit();
+
+	return 0;
+}
+
+#else
+
+extern int main(void)
+{
+	printf("128-bit integers aren't supported by compiler\n");
+	return 0;
+}
+
+#endif
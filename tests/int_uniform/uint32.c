@@ -24,6 +24,7 @@ extern int main(void)
 	ITYPE min, max, orig_array[maxsize], decoded_array[maxsize];	//minimum and maximim in array
 	OTYPE encoded_array[maxsize];
 	FILE *fp;
+	OTYPE rand_array[256];							//random numbers for group selection
 	
 	/*Buffer for ciphertext. Ensure the buffer is long enough for the ciphertext which may be
 	longer than the plaintext, dependant on the algorithm and mode (for AES-256 in CBC mode we need
@@ -149,6 +150,87 @@ extern int main(void)
 	
 	
 	
+	//power-of-two ranges and range widening------------------------------------------------------
+	
+	size = 256;
+	randombytes((unsigned char *)orig_array, BYTESIZE);
+	randombytes((unsigned char *)rand_array, sizeof(rand_array));
+	for (i = 0; i < size; i++)
+		orig_array[i] = 1000000 + orig_array[i] % 900000;
+	min = 1000000;
+	max = 1900000;
+	widen_uint32_range(&min, &max);
+	if ( (min != 1000000) || (max != 1000000 + 1048575) ) {
+		error("unexpected widened range");
+		printf("min = %"PRI", max = %"PRI"\n", min, max);
+		test_error();
+		}
+	//group selection is a shift: encoded element = normalized element + (random number << 20)
+	encode_uint32_uniform_rand(orig_array, encoded_array, rand_array, size, min, max);
+	decode_uint32_uniform(encoded_array, decoded_array, size, min, max);
+	for (i = 0; i < size; i++)
+		if (encoded_array[i] != orig_array[i] - min + (rand_array[i] << 20)) {
+			error("unexpected encoded element");
+			test_error();
+			}
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_uint32_array(orig_array, 10);
+		print_uint32_array(decoded_array, 10);
+		test_error();
+		}
+	//range at the end of type is moved down
+	min = 4000000000;
+	max = 4000000001;
+	widen_uint32_range(&min, &max);
+	if ( (min != 4000000000) || (max != 4000000001) ) {
+		error("unexpected widened range");
+		test_error();
+		}
+	min = 4000000000;
+	max = 4000000002;
+	widen_uint32_range(&min, &max);
+	if ( (min != 4000000000) || (max != 4000000003) ) {
+		error("unexpected widened range");
+		test_error();
+		}
+	min = 4000000000;
+	max = UINT32_MAX;
+	widen_uint32_range(&min, &max);
+	if ( (min != UINT32_MAX - 536870911) || (max != UINT32_MAX) ) {
+		error("unexpected widened range");
+		printf("min = %"PRI", max = %"PRI"\n", min, max);
+		test_error();
+		}
+	
+	
+	
+	//unchecked encoding and decoding of the same arrays------------------------------------------
+	
+	for (size = 1; size < 256; size++) {
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		get_uint32_minmax(orig_array, size, &min, &max);
+		//checked and unchecked functions must be compatible with each other
+		encode_uint32_uniform_unchecked(orig_array, encoded_array, size, min, max);
+		decode_uint32_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_uint32_array(orig_array, 10);
+			print_uint32_array(decoded_array, 10);
+			test_error();
+			}
+		encode_uint32_uniform(orig_array, encoded_array, size, min, max);
+		decode_uint32_uniform_unchecked(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_uint32_array(orig_array, 10);
+			print_uint32_array(decoded_array, 10);
+			test_error();
+			}
+		}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -149,6 +149,38 @@ extern int main(void)
 	
 	
 	
+	//container size and layout of encoded elements-----------------------------------------------
+	
+	if ( (container_uint64_uniform(0, UINT64_MAX) != 16) ||
+		(container_uint64_uniform(5, 5) != 16) ) {
+		error("unexpected container size");
+		test_error();
+		}
+	
+	//encoded elements are 128-bit little endian numbers: 5 in [0; 9] with random number 1 is
+	//5 + (1 % group_num) * 10 = 15, 5 with random number 2^64 is 5 + 2^64 * 10
+	size = 2;
+	orig_array[0] = 5;
+	orig_array[1] = 5;
+	memset(decoded_array, 0, 4*sizeof(ITYPE));
+	((unsigned char *)decoded_array)[0] = 1;
+	((unsigned char *)decoded_array)[24] = 1;
+	encode_uint64_uniform_rand(orig_array, encoded_array, (unsigned char *)decoded_array, size, 0,
+		9);
+	if ( (encoded_array[0] != 15) || (encoded_array[16] != 5) || (encoded_array[24] != 10) ) {
+		error("unexpected encoded value");
+		print_16_bytes_array(encoded_array, size);
+		test_error();
+		}
+	decode_uint64_uniform(encoded_array, decoded_array, size, 0, 9);
+	if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+		error("orig_array and decoded_array are not the same");
+		print_uint64_array(decoded_array, size);
+		test_error();
+		}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -238,6 +270,9 @@ extern int main(void)
 	decode_uint64_uniform(encoded_array, orig_array, 1, 2, 1);
 	printf("\n");
 	
+	container_uint64_uniform(2, 1);
+	printf("\n");
+	
 	print_uint64_array(NULL, 0);
 	print_uint64_array(orig_array, 0);
 	printf("\n");
@@ -24,6 +24,8 @@ extern int main(void)
 	ITYPE min, max, orig_array[maxsize], decoded_array[maxsize];	//minimum and maximim in array
 	OTYPE encoded_array[maxsize];
 	FILE *fp;
+	struct hd_table8 *table;						//tables for range of array
+	struct hd_error err;							//result of range checking
 	
 	/*Buffer for ciphertext. Ensure the buffer is long enough for the ciphertext which may be
 	longer than the plaintext, dependant on the algorithm and mode (for AES-256 in CBC mode we need
@@ -285,6 +287,40 @@ extern int main(void)
 	
 	
 	
+	//table-driven encoding and decoding-----------------------------------------------------------
+	
+	for (size = 1; size < 256; size++) {
+		randombytes((unsigned char *)orig_array, BYTESIZE);
+		get_uint8_minmax(orig_array, size, &min, &max);
+		//every range must be tested with the last size, including range with every value
+		if (size == 255) {
+			min = 0;
+			max = UINT8_MAX;
+			}
+		if ( (table = create_uint8_uniform_table(min, max)) == NULL )
+			test_error();
+		//table-driven and usual functions must be compatible with each other
+		encode_uint8_uniform(orig_array, encoded_array, size, min, max);
+		decode_uint8_uniform_table(table, encoded_array, decoded_array, size);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_uint8_array(orig_array, 10);
+			print_uint8_array(decoded_array, 10);
+			test_error();
+			}
+		encode_uint8_uniform_table(table, orig_array, encoded_array, size);
+		decode_uint8_uniform(encoded_array, decoded_array, size, min, max);
+		if (memcmp(orig_array, decoded_array, BYTESIZE)) {
+			error("orig_array and decoded_array are not the same");
+			print_uint8_array(orig_array, 10);
+			print_uint8_array(decoded_array, 10);
+			test_error();
+			}
+		free_uniform_table(table);
+		}
+	
+	
+	
 	//fixed general cases--------------------------------------------------------------------------
 	
 	size = 5;
@@ -353,6 +389,32 @@ extern int main(void)
 	
 	
 	
+	//range checking-------------------------------------------------------------------------------
+	
+	size = maxsize;
+	memset(orig_array, 150, BYTESIZE);
+	if (check_uint8_range(orig_array, size, 100, 200, &err) || (err.code != HD_OK)) {
+		error("unexpected range checking result");
+		test_error();
+		}
+	orig_array[maxsize-3] = 99;
+	orig_array[maxsize-1] = 201;
+	if ( (check_uint8_range(orig_array, size, 100, 200, &err) != -1) ||
+		(err.code != HD_WRONG_MIN) || (err.index != maxsize-3) ) {
+		error("unexpected range checking result");
+		printf("code = %d, index = %zu\n", err.code, err.index);
+		test_error();
+		}
+	orig_array[maxsize-3] = 150;
+	if ( (check_uint8_range(orig_array, size, 100, 200, &err) != -1) ||
+		(err.code != HD_WRONG_MAX) || (err.index != maxsize-1) ) {
+		error("unexpected range checking result");
+		printf("code = %d, index = %zu\n", err.code, err.index);
+		test_error();
+		}
+	
+	
+	
 	//wrong parameters-----------------------------------------------------------------------------
 	
 	get_uint8_minmax(NULL, 0, NULL, NULL);
@@ -375,6 +437,20 @@ extern int main(void)
 	decode_uint8_uniform(encoded_array, orig_array, 1, 2, 1);
 	printf("\n");
 	
+	create_uint8_uniform_table(2, 1);
+	encode_uint8_uniform_table(NULL, orig_array, encoded_array, 1);
+	decode_uint8_uniform_table(NULL, encoded_array, orig_array, 1);
+	//table of the other 8-bit type is rejected
+	if ( (table = create_int8_uniform_table(0, 10)) == NULL )
+		test_error();
+	if ( (encode_uint8_uniform_table(table, orig_array, encoded_array, 1) != -1) ||
+		(decode_uint8_uniform_table(table, encoded_array, orig_array, 1) != -1) ) {
+		error("unexpected success");
+		test_error();
+		}
+	free_uniform_table(table);
+	printf("\n");
+	
 	stats_uint8_array(NULL, 0, NULL);
 	stats_uint8_array(orig_array, 0, NULL);
 	stats_uint8_array(orig_array, 1, NULL);
@@ -0,0 +1,285 @@
+/*
+test program for honeydata library
+license: BSD 2-Clause
+*/
+
+#include "../t_common.h"
+#include "../../hdata/hd_plan.h"
+
+extern int main(void)
+{
+	#define ROWS 2500								//number of rows in record batch
+	#define COLUMNS 8								//number of columns in record batch
+
+	//input columns
+	uint8_t u8[ROWS], u8_full[ROWS], a8[ROWS];
+	int16_t i16[ROWS];
+	uint32_t a32[ROWS];
+	int32_t i32[ROWS];
+	uint64_t u64[ROWS];
+	int64_t i64_full[ROWS];
+	//decoded columns
+	uint8_t d_u8[ROWS], d_u8_full[ROWS], d_a8[ROWS];
+	int16_t d_i16[ROWS];
+	uint32_t d_a32[ROWS];
+	int32_t d_i32[ROWS];
+	uint64_t d_u64[ROWS];
+	int64_t d_i64_full[ROWS];
+	//encoded columns
+	uint16_t e_u8[ROWS], e_u8_full[ROWS], e_a8[ROWS];
+	uint32_t e_i16[ROWS];
+	uint64_t e_a32[ROWS], e_i32[ROWS];
+	unsigned char e_u64[16*ROWS], e_i64_full[16*ROWS];
+
+	const void *in_columns[COLUMNS] = {u8, u8_full, a8, i16, a32, i32, u64, i64_full};
+	void *encoded_columns[COLUMNS] = {e_u8, e_u8_full, e_a8, e_i16, e_a32, e_i32, e_u64,
+		e_i64_full};
+	void *decoded_columns[COLUMNS] = {d_u8, d_u8_full, d_a8, d_i16, d_a32, d_i32, d_u64,
+		d_i64_full};
+
+	//weights of a8 column: sum is 255, so every intermediate value is possible
+	uint32_t weights8[] = {100, 0, 55, 100};
+	uint32_t weights32[] = {70000, 1, 0, 5};
+	struct hd_plan *plan, *plan2;
+	struct hd_cursor *cursor;
+	const void *block;
+	int n;
+	size_t i;
+
+	test_init();
+
+
+
+	//random data encoding and decoding------------------------------------------------------------
+
+	randombytes((unsigned char *)u8, sizeof(u8));
+	randombytes((unsigned char *)u8_full, sizeof(u8_full));
+	randombytes((unsigned char *)i16, sizeof(i16));
+	randombytes((unsigned char *)i32, sizeof(i32));
+	randombytes((unsigned char *)u64, sizeof(u64));
+	randombytes((unsigned char *)i64_full, sizeof(i64_full));
+	for (i = 0; i < ROWS; i++) {
+		u8[i] = (u8[i] % 101) + 100;
+		a8[i] = (i % 3 == 0) ? 10 : 12 + (i % 2);
+		i16[i] = (i16[i] % 1000) - 200;
+		a32[i] = (i % 5 == 0) ? 3000000003 : 3000000000;
+		i32[i] = i32[i] / 2;
+		u64[i] = u64[i] % 5000000000000000000 + 1;
+		}
+
+	if ( (plan = create_plan()) == NULL )
+		test_error();
+	if ( (add_uint8_uniform_column(plan, 100, 200) != 0) ||
+		(add_uint8_uniform_column(plan, 0, UINT8_MAX) != 1) ||
+		(add_uint8_arbitrary_column(plan, 10, 13, weights8) != 2) ||
+		(add_int16_uniform_column(plan, -1200, 800) != 3) ||
+		(add_uint32_arbitrary_column(plan, 3000000000, 3000000003, weights32) != 4) ||
+		(add_int32_uniform_column(plan, INT32_MIN/2, INT32_MAX/2) != 5) ||
+		(add_uint64_uniform_column(plan, 1, 5000000000000000000) != 6) ||
+		(add_int64_uniform_column(plan, INT64_MIN, INT64_MAX) != 7) ) {
+		error("can't add columns to plan");
+		test_error();
+		}
+
+	if ( (plan_container_size(plan, 0) != 2) || (plan_container_size(plan, 2) != 2) ||
+		(plan_container_size(plan, 4) != 8) || (plan_container_size(plan, 7) != 16) ) {
+		error("unexpected container size");
+		test_error();
+		}
+
+	if (encode_plan(plan, in_columns, encoded_columns, ROWS) ||
+		decode_plan(plan, (const void * const *)encoded_columns, decoded_columns, ROWS)) {
+		error("can't encode or decode record batch");
+		test_error();
+		}
+
+	for (i = 0; i < COLUMNS; i++)
+		if (memcmp(in_columns[i], decoded_columns[i], plan_container_size(plan, i)/2*ROWS)) {
+			error("in_columns and decoded_columns are not the same");
+			printf("column = %zu\n", i);
+			test_error();
+			}
+
+	//columns must be compatible with functions for single arrays
+	memset(d_u8_full, 0, sizeof(d_u8_full));
+	memset(d_a8, 0, sizeof(d_a8));
+	memset(d_a32, 0, sizeof(d_a32));
+	memset(d_u64, 0, sizeof(d_u64));
+	decode_uint8_uniform(e_u8_full, d_u8_full, ROWS, 0, UINT8_MAX);
+	decode_uint8_arbitrary(e_a8, d_a8, ROWS, 10, 13, weights8);
+	decode_uint32_arbitrary(e_a32, d_a32, ROWS, 3000000000, 3000000003, weights32);
+	decode_uint64_uniform(e_u64, d_u64, ROWS, 1, 5000000000000000000);
+	if (memcmp(u8_full, d_u8_full, sizeof(u8_full)) || memcmp(a8, d_a8, sizeof(a8)) ||
+		memcmp(a32, d_a32, sizeof(a32)) || memcmp(u64, d_u64, sizeof(u64))) {
+		error("columns are not compatible with decode functions");
+		test_error();
+		}
+
+
+
+	//encoding and decoding by parts of rows-------------------------------------------------------
+
+	//two parts of the same record batch are processed with two plans, like by two threads
+	if ( (plan2 = copy_plan(plan)) == NULL )
+		test_error();
+	for (i = 0; i < COLUMNS; i++)
+		memset(decoded_columns[i], 0, plan_container_size(plan, i)/2*ROWS);
+	if (encode_plan_rows(plan, in_columns, encoded_columns, ROWS, 0, 1000) ||
+		encode_plan_rows(plan2, in_columns, encoded_columns, ROWS, 1000, ROWS - 1000) ||
+		decode_plan_rows(plan2, (const void * const *)encoded_columns, decoded_columns, ROWS, 0,
+			1500) ||
+		decode_plan_rows(plan, (const void * const *)encoded_columns, decoded_columns, ROWS, 1500,
+			ROWS - 1500)) {
+		error("can't encode or decode parts of record batch");
+		test_error();
+		}
+	for (i = 0; i < COLUMNS; i++)
+		if (memcmp(in_columns[i], decoded_columns[i], plan_container_size(plan, i)/2*ROWS)) {
+			error("in_columns and decoded_columns are not the same");
+			printf("column = %zu\n", i);
+			test_error();
+			}
+	//parts are the same as one record batch
+	memset(d_u8_full, 0, sizeof(d_u8_full));
+	memset(d_i64_full, 0, sizeof(d_i64_full));
+	decode_uint8_uniform(e_u8_full, d_u8_full, ROWS, 0, UINT8_MAX);
+	decode_int64_uniform(e_i64_full, d_i64_full, ROWS, INT64_MIN, INT64_MAX);
+	if (memcmp(u8_full, d_u8_full, sizeof(u8_full)) ||
+		memcmp(i64_full, d_i64_full, sizeof(i64_full))) {
+		error("parts of full columns are not placed right");
+		test_error();
+		}
+	free_plan(plan2);
+
+
+
+	//range widening policy------------------------------------------------------------------------
+
+	if ( (plan2 = create_plan()) == NULL )
+		test_error();
+	//[-1200; 800] becomes [-1200; 847], and i16 column can be decoded with this range
+	if ( set_plan_widening(plan2, true) || (add_int16_uniform_column(plan2, -1200, 800) != 0) ||
+		encode_plan(plan2, in_columns + 3, encoded_columns + 3, ROWS) ) {
+		error("can't encode column with widened range");
+		test_error();
+		}
+	memset(d_i16, 0, sizeof(d_i16));
+	decode_int16_uniform(e_i16, d_i16, ROWS, -1200, 847);
+	if (memcmp(i16, d_i16, sizeof(i16))) {
+		error("column with widened range is not decoded right");
+		test_error();
+		}
+	free_plan(plan2);
+
+
+
+	//lazy decoding of columns---------------------------------------------------------------------
+
+	//every block of column with arbitrary distribution
+	if ( (cursor = create_cursor(plan, 2, e_a8, ROWS)) == NULL )
+		test_error();
+	for (i = 0; (n = cursor_next_block(cursor, &block)) > 0; i += n)
+		if ( (n > HD_CURSOR_BLOCK) || (i + n > ROWS) || memcmp(a8 + i, block, n) ) {
+			error("block is not decoded right");
+			printf("start = %zu, n = %d\n", i, n);
+			test_error();
+			}
+	if ( (n != 0) || (i != ROWS) ) {
+		error("unexpected end of column");
+		test_error();
+		}
+	free_cursor(cursor);
+
+	//skipped elements are not decoded, and skip after the end of column ends it
+	if ( (cursor = create_cursor(plan, 6, e_u64, ROWS)) == NULL )
+		test_error();
+	if ( cursor_skip(cursor, 1000) || (cursor_next_block(cursor, &block) != HD_CURSOR_BLOCK) ||
+		memcmp(u64 + 1000, block, HD_CURSOR_BLOCK*sizeof(uint64_t)) ) {
+		error("block after skip is not decoded right");
+		test_error();
+		}
+	if ( cursor_skip(cursor, ROWS) || (cursor_next_block(cursor, &block) != 0) ) {
+		error("unexpected end of column");
+		test_error();
+		}
+	free_cursor(cursor);
+	
+	//cursor stays valid when columns are added to plan after its creation
+	if ( (plan2 = create_plan()) == NULL )
+		test_error();
+	if ( (add_uint8_arbitrary_column(plan2, 10, 13, weights8) != 0) ||
+		encode_plan(plan2, in_columns + 2, encoded_columns + 2, ROWS) ||
+		( (cursor = create_cursor(plan2, 0, e_a8, ROWS)) == NULL ) )
+		test_error();
+	for (i = 0; i < 100; i++)
+		add_uint8_uniform_column(plan2, 0, 100);
+	for (i = 0; (n = cursor_next_block(cursor, &block)) > 0; i += n)
+		if ( (i + n > ROWS) || memcmp(a8 + i, block, n) ) {
+			error("block is not decoded right after adding columns");
+			printf("start = %zu, n = %d\n", i, n);
+			test_error();
+			}
+	if (i != ROWS) {
+		error("unexpected end of column");
+		test_error();
+		}
+	free_cursor(cursor);
+	free_plan(plan2);
+
+
+
+	//wrong parameters-----------------------------------------------------------------------------
+
+	weights8[0] = 0;
+	weights8[2] = 0;
+	weights8[3] = 0;
+	add_uint8_uniform_column(NULL, 0, 0);
+	add_uint8_uniform_column(plan, 2, 1);
+	add_uint8_arbitrary_column(plan, 10, 13, NULL);
+	add_uint8_arbitrary_column(plan, 10, 13, weights8);
+	add_uint64_arbitrary_column(plan, 0, UINT64_MAX, weights32);
+	plan_container_size(plan, COLUMNS);
+	printf("\n");
+
+	encode_plan(NULL, NULL, NULL, 0);
+	encode_plan(plan, NULL, NULL, 0);
+	encode_plan(plan, in_columns, NULL, 0);
+	encode_plan(plan, in_columns, encoded_columns, 0);
+	u8[ROWS-1] = 201;
+	encode_plan(plan, in_columns, encoded_columns, ROWS);
+	encode_plan_rows(plan, in_columns, encoded_columns, ROWS, ROWS - 1, 2);
+	//wrong elements in the last block are found before anything is written to encoded columns
+	u8[ROWS-1] = 200;
+	a8[ROWS-1] = 11;
+	memset(e_u8, 0xAB, sizeof(e_u8));
+	memset(e_a8, 0xAB, sizeof(e_a8));
+	if (encode_plan(plan, in_columns, encoded_columns, ROWS) != -1) {
+		error("unexpected success");
+		test_error();
+		}
+	for (i = 0; i < ROWS; i++)
+		if ( (e_u8[i] != 0xABAB) || (e_a8[i] != 0xABAB) ) {
+			error("encoded columns are changed by failed encoding");
+			test_error();
+			}
+	printf("\n");
+
+	decode_plan(NULL, NULL, NULL, 0);
+	decode_plan(plan, NULL, NULL, 0);
+	decode_plan_rows(plan, (const void * const *)encoded_columns, decoded_columns, ROWS, ROWS, 1);
+	copy_plan(NULL);
+	set_plan_widening(NULL, true);
+	create_cursor(plan, COLUMNS, e_u8, ROWS);
+	create_cursor(plan, 0, e_u8, 0);
+	cursor_next_block(NULL, &block);
+	cursor_skip(NULL, 1);
+	free_plan(plan);
+
+
+
+	#undef ROWS
+	#undef COLUMNS
+	test_deinit();
+
+	return 0;
+}
@@ -105,12 +105,25 @@ extern int print_uint64_array
 extern int print_int64_array
 	PRINT_ARRAY(int64_t, printf("%"PRIi64, array[i]) )
 
+#ifdef HD_HAVE_INT128
+extern int print_uint128_array
+	PRINT_ARRAY(hd_uint128_t, printf("%016"PRIx64"%016"PRIx64, (uint64_t)(array[i] >> 64),
+		(uint64_t)array[i]) )
+
+extern int print_int128_array
+	PRINT_ARRAY(hd_int128_t, printf("%016"PRIx64"%016"PRIx64, (uint64_t)(array[i] >> 64),
+		(uint64_t)array[i]) )
+#endif
+
 extern int print_mpz_array
 	PRINT_ARRAY(mpz_t, mpz_out_str(stdout, 16, array[i]) )
 
 extern int print_16_bytes_array
 	PRINT_ARRAY(unsigned char, int j; for (j = 0; j < 16; j++) printf("%02x", array[16*i+j]) )
 
+extern int print_32_bytes_array
+	PRINT_ARRAY(unsigned char, int j; for (j = 0; j < 32; j++) printf("%02x", array[32*i+j]) )
+
 extern int print_float_array
 	PRINT_ARRAY(float, printf("%e", array[i]) )
 
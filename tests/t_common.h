@@ -9,6 +9,10 @@ license: BSD 2-Clause
 #include "../hdata/hd_common.h"
 //#include <openssl/conf.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //functions for unsigned and signed 8 bit integers
 //get a number of occurences of different elements in array, print a numeric array
 extern int stats_uint8_array(const uint8_t *in_array, const size_t size, uint64_t *stats);
@@ -32,12 +36,21 @@ extern int print_int32_array(const int32_t *array, const size_t size);
 extern int print_uint64_array(const uint64_t *array, const size_t size);
 extern int print_int64_array(const int64_t *array, const size_t size);
 
+//for unsigned and signed 128 bit integers (printed in hexadecimal)
+#ifdef HD_HAVE_INT128
+extern int print_uint128_array(const hd_uint128_t *array, const size_t size);
+extern int print_int128_array(const hd_int128_t *array, const size_t size);
+#endif
+
 //for GNU MP integers
 extern int print_mpz_array(const mpz_t *array, const size_t size);
 
 //for integers saved in 16 bytes
 extern int print_16_bytes_array(const unsigned char *array, const size_t size);
 
+//for integers saved in 32 bytes
+extern int print_32_bytes_array(const unsigned char *array, const size_t size);
+
 //for float floating-point numbers
 //convert signaling NaNs to quiet NaNs in array, print a numeric array
 extern int print_float_array(const float *array, const size_t size);
@@ -62,4 +75,8 @@ extern int encrypt(const unsigned char *plaintext, const size_t plaintext_len,
 extern int decrypt(const unsigned char *ciphertext, const size_t ciphertext_len,
 	const unsigned char *key, const unsigned char *iv, unsigned char *plaintext);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif